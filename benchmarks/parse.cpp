@@ -0,0 +1,220 @@
+/**
+ *  Parse.cpp
+ *
+ *  Benchmark program that measures how fast incoming data is processed
+ *  by Connection::parse(). The program feeds a stream of AMQP frames (as
+ *  sent by the server to the client) to a connection in chunks that mimic
+ *  the reads from a socket, and reports the number of frames per second.
+ *
+ *  The stream can be loaded from a file with a captured AMQP byte stream
+ *  (all data sent by the server, starting with the connection.start frame).
+ *  Without a file, a stream with a handshake and a number of deliveries
+ *  is generated.
+ *
+ *      amqpcpp_parse_benchmark [capture-file] [chunk-size]
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "stream.h"
+
+/**
+ *  Handler that throws away all outgoing data
+ */
+class NullHandler : public AMQP::ConnectionHandler
+{
+private:
+    /**
+     *  Method that is called when data has to be sent
+     *  @param  connection
+     *  @param  buffer
+     *  @param  size
+     */
+    virtual void onData(AMQP::Connection *connection, const char *buffer, size_t size) override {}
+
+    /**
+     *  Method that is called when the connection ends up in an error state
+     *  @param  connection
+     *  @param  message
+     */
+    virtual void onError(AMQP::Connection *connection, const char *message) override
+    {
+        std::cerr << "error: " << message << std::endl;
+    }
+};
+
+/**
+ *  Generate a stream with a handshake and a number of deliveries
+ *  @param  messages    number of messages
+ *  @param  size        size of each message
+ *  @return std::string
+ */
+static std::string generate(size_t messages, size_t size)
+{
+    // the stream to fill
+    Stream stream;
+
+    // connection.start, connection.tune and connection.open-ok
+    stream.method(0, 10, 10).u8(0).u8(9).u32(0).longstr("PLAIN").longstr("en_US").end();
+    stream.method(0, 10, 30).u16(0).u32(131072).u16(0).end();
+    stream.method(0, 10, 41).shortstr("").end();
+
+    // channel.open-ok and basic.consume-ok
+    stream.method(1, 20, 11).longstr("").end();
+    stream.method(1, 60, 21).shortstr("benchmark").end();
+
+    // the deliveries
+    for (size_t i = 0; i < messages; ++i)
+    {
+        // basic.deliver
+        stream.method(1, 60, 60).shortstr("benchmark").u64(i + 1).u8(0).shortstr("exchange").shortstr("routingkey").end();
+
+        // header frame (with only a content-type)
+        stream.begin(2, 1).u16(60).u16(0).u64(size).u16(0x8000).shortstr("text/plain").end();
+
+        // body frame
+        stream.begin(3, 1);
+        for (size_t j = 0; j < size; ++j) stream.u8('a' + j % 26);
+        stream.end();
+    }
+
+    // done
+    return stream.data();
+}
+
+/**
+ *  Count the number of frames in a stream
+ *  @param  data
+ *  @return size_t
+ */
+static size_t count(const std::string &data)
+{
+    // number of frames found
+    size_t result = 0;
+
+    // walk over the frame headers
+    for (size_t pos = 0; pos + 7 <= data.size(); ++result)
+    {
+        // size of the payload
+        uint32_t size = 0;
+        for (int i = 0; i < 4; ++i) size = (size << 8) | (uint8_t)data[pos + 3 + i];
+
+        // skip the frame
+        pos += size + 8;
+    }
+
+    // done
+    return result;
+}
+
+/**
+ *  Feed the stream to a new connection
+ *  @param  data        the stream
+ *  @param  chunk       number of bytes that is "received" at once
+ *  @return size_t      number of messages that were consumed
+ */
+static size_t run(const std::string &data, size_t chunk)
+{
+    // number of messages consumed
+    size_t messages = 0;
+
+    // create the connection, a channel and a consumer
+    NullHandler handler;
+    AMQP::Connection connection(&handler);
+    AMQP::Channel channel(&connection);
+    channel.consume("queue").onReceived([&messages](const AMQP::Message &message, uint64_t tag, bool redelivered) { messages++; });
+
+    // number of bytes received and processed
+    size_t received = 0, processed = 0;
+
+    // keep receiving data until everything has been processed
+    while (processed < data.size())
+    {
+        // receive the next chunk
+        received = std::min(data.size(), received + chunk);
+
+        // parse what we have
+        auto bytes = connection.parse(data.data() + processed, received - processed);
+
+        // stop if nothing could be processed while all data was received
+        if (bytes == 0 && received == data.size()) break;
+
+        // update the counter
+        processed += bytes;
+    }
+
+    // done
+    return messages;
+}
+
+/**
+ *  Main procedure
+ *  @param  argc
+ *  @param  argv
+ *  @return int
+ */
+int main(int argc, const char *argv[])
+{
+    // the stream to parse
+    std::string data;
+
+    // was a capture file passed?
+    if (argc > 1)
+    {
+        // read the file
+        std::ifstream file(argv[1], std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        data = contents.str();
+
+        // the file must contain at least one frame
+        if (data.size() < 8) { std::cerr << argv[1] << ": no frames found" << std::endl; return 1; }
+    }
+    else
+    {
+        // generate a stream
+        data = generate(100000, 64);
+    }
+
+    // chunk size
+    size_t chunk = argc > 2 ? std::stoul(argv[2]) : 65536;
+
+    // number of frames in the stream
+    size_t frames = count(data);
+
+    // number of iterations and messages, and the start time
+    size_t iterations = 0, messages = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+
+    // run for at least one second
+    while (elapsed < 1.0)
+    {
+        // feed the stream to a connection
+        messages += run(data, chunk);
+        iterations += 1;
+
+        // calculate elapsed time
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // report
+    std::cout << "bytes:      " << data.size() << " (" << frames << " frames, chunks of " << chunk << " bytes)" << std::endl;
+    std::cout << "iterations: " << iterations << std::endl;
+    std::cout << "frames/s:   " << (size_t)(frames * iterations / elapsed) << std::endl;
+    std::cout << "messages/s: " << (size_t)(messages / elapsed) << std::endl;
+    std::cout << "MB/s:       " << (data.size() * iterations / elapsed / 1048576) << std::endl;
+
+    // done
+    return 0;
+}
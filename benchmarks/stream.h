@@ -0,0 +1,111 @@
+/**
+ *  Stream.h
+ *
+ *  Helper class for the benchmark programs to construct a stream of AMQP
+ *  frames, as they are sent over the network
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <string>
+#include <stdint.h>
+
+/**
+ *  Helper class to construct a stream of frames
+ */
+class Stream
+{
+private:
+    /**
+     *  The data that was written
+     *  @var std::string
+     */
+    std::string _data;
+
+    /**
+     *  Offset of the frame that is being written
+     *  @var size_t
+     */
+    size_t _frame = 0;
+
+public:
+    /**
+     *  Write integers in network byte order
+     *  @param  value
+     */
+    Stream &u8(uint8_t value) { _data.push_back((char)value); return *this; }
+    Stream &u16(uint16_t value) { return u8(value >> 8).u8(value & 0xff); }
+    Stream &u32(uint32_t value) { return u16(value >> 16).u16(value & 0xffff); }
+    Stream &u64(uint64_t value) { return u32(value >> 32).u32(value & 0xffffffff); }
+
+    /**
+     *  Write strings
+     *  @param  value
+     */
+    Stream &shortstr(const std::string &value) { u8(value.size()); _data.append(value); return *this; }
+    Stream &longstr(const std::string &value) { u32(value.size()); _data.append(value); return *this; }
+
+    /**
+     *  Write raw bytes
+     *  @param  data
+     *  @param  size
+     */
+    Stream &bytes(const char *data, size_t size) { _data.append(data, size); return *this; }
+
+    /**
+     *  Start a new frame
+     *  @param  type
+     *  @param  channel
+     */
+    Stream &begin(uint8_t type, uint16_t channel)
+    {
+        // remember where the frame starts, the size is filled in later
+        _frame = _data.size();
+        return u8(type).u16(channel).u32(0);
+    }
+
+    /**
+     *  Start a new method frame
+     *  @param  channel
+     *  @param  classid
+     *  @param  methodid
+     */
+    Stream &method(uint16_t channel, uint16_t classid, uint16_t methodid)
+    {
+        return begin(1, channel).u16(classid).u16(methodid);
+    }
+
+    /**
+     *  Finish the current frame
+     */
+    Stream &end()
+    {
+        // size of the payload
+        uint32_t size = _data.size() - _frame - 7;
+
+        // store the size in the header
+        for (int i = 0; i < 4; ++i) _data[_frame + 3 + i] = (char)(size >> (24 - 8 * i));
+
+        // add the end-of-frame marker
+        return u8(206);
+    }
+
+    /**
+     *  Expose the data
+     *  @return std::string
+     */
+    const std::string &data() const { return _data; }
+
+    /**
+     *  Forget all data that was written
+     */
+    void clear() { _data.clear(); }
+};
@@ -0,0 +1,259 @@
+/**
+ *  AckWindow.h
+ *
+ *  Administration of the messages that were delivered on a channel that
+ *  coalesces its acknowledgements. The window holds the state of every
+ *  delivery tag since the oldest message that is not yet settled, so that
+ *  a run of acknowledged messages can be reported to RabbitMQ with a
+ *  single basic.ack frame with the "multiple" bit set.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <deque>
+#include <algorithm>
+#include <stdint.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class AckWindow
+{
+private:
+    /**
+     *  The state of a delivery tag
+     */
+    enum : uint8_t {
+        state_outstanding,          // delivered, but not yet acked or rejected
+        state_pending,              // acked by the application, but the ack was not yet sent
+        state_settled               // nothing has to be done for the message anymore
+    };
+
+    /**
+     *  State of the delivery tags, starting at _base
+     *  @var std::deque<uint8_t>
+     */
+    std::deque<uint8_t> _tags;
+
+    /**
+     *  The delivery tag of the first message in the window
+     *  @var uint64_t
+     */
+    uint64_t _base;
+
+    /**
+     *  Number of pending acks
+     *  @var size_t
+     */
+    size_t _pending = 0;
+
+    /**
+     *  Max number of pending acks
+     *  @var size_t
+     */
+    size_t _threshold;
+
+    /**
+     *  May acks be combined with the "multiple" bit? This is not possible if messages
+     *  were delivered before the window was created, because we do not know their state
+     *  @var bool
+     */
+    bool _multiple;
+
+    /**
+     *  Remove the settled messages from the front of the window
+     */
+    void prune()
+    {
+        // remove settled messages
+        while (!_tags.empty() && _tags.front() == state_settled)
+        {
+            // the next message is now the first one
+            _tags.pop_front();
+            ++_base;
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  delivered   the last delivery tag that was already received
+     *  @param  threshold   max number of pending acks
+     */
+    AckWindow(uint64_t delivered, size_t threshold) :
+        _base(delivered + 1), _threshold(threshold), _multiple(delivered == 0) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~AckWindow() {}
+
+    /**
+     *  Register a message that was delivered
+     *  @param  tag         the delivery tag
+     *  @param  noack       was it delivered to a consumer that does not ack?
+     */
+    void delivered(uint64_t tag, bool noack)
+    {
+        // ignore tags that we already know
+        if (tag < _base + _tags.size()) return;
+
+        // tags that we somehow missed could still be outstanding
+        while (_base + _tags.size() < tag) _tags.push_back(state_outstanding);
+
+        // add the message
+        _tags.push_back(noack ? state_settled : state_outstanding);
+
+        // the window could have become empty
+        prune();
+    }
+
+    /**
+     *  Hold back the ack of a message
+     *  @param  tag         the delivery tag
+     *  @return bool        false if the message is unknown or already settled, and the ack must be sent right away
+     */
+    bool ack(uint64_t tag)
+    {
+        // the message must be in the window
+        if (tag < _base || tag >= _base + _tags.size()) return false;
+
+        // and it must be outstanding
+        auto &state = _tags[tag - _base];
+        if (state != state_outstanding) return false;
+
+        // the ack is now pending
+        state = state_pending;
+        ++_pending;
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Mark messages as settled because an ack, nack or reject is sent for them right away
+     *  @param  tag         the delivery tag
+     *  @param  multiple    are all earlier messages settled too?
+     */
+    void settle(uint64_t tag, bool multiple)
+    {
+        // skip if the message is not in the window
+        if (tag < _base) return;
+
+        // the messages that are settled
+        size_t first = multiple ? 0 : tag - _base;
+        size_t last = std::min(tag - _base + 1, (uint64_t)_tags.size());
+
+        // mark them as settled
+        for (size_t i = first; i < last; ++i)
+        {
+            // pending acks are no longer pending
+            if (_tags[i] == state_pending) --_pending;
+
+            // the message is settled
+            _tags[i] = state_settled;
+        }
+
+        // the front of the window could be settled now
+        prune();
+    }
+
+    /**
+     *  Number of pending acks
+     *  @return size_t
+     */
+    size_t pending() const
+    {
+        return _pending;
+    }
+
+    /**
+     *  Max number of pending acks
+     *  @return size_t
+     */
+    size_t threshold() const
+    {
+        return _threshold;
+    }
+
+    /**
+     *  Change the max number of pending acks
+     *  @param  threshold
+     */
+    void threshold(size_t threshold)
+    {
+        _threshold = threshold;
+    }
+
+    /**
+     *  Send out the pending acks. The callback is called for every ack frame that has
+     *  to be sent, with the delivery tag and whether the "multiple" bit should be set
+     *  @param  callback    void(uint64_t tag, bool multiple)
+     */
+    template <typename CALLBACK>
+    void flush(const CALLBACK &callback)
+    {
+        // skip if there is nothing to send
+        if (_pending == 0) return;
+
+        // find the last pending ack that is not preceded by an outstanding message
+        size_t last = 0, count = 0;
+        for (size_t i = 0; _multiple && i < _tags.size() && _tags[i] != state_outstanding; ++i)
+        {
+            // skip messages that are already settled
+            if (_tags[i] != state_pending) continue;
+
+            // this one is pending
+            last = i;
+            ++count;
+        }
+
+        // all those acks can be sent in one frame
+        if (count > 0)
+        {
+            // send the ack
+            callback(_base + last, count > 1);
+
+            // the messages are settled
+            for (size_t i = 0; i <= last; ++i) _tags[i] = state_settled;
+        }
+
+        // the other acks are behind a gap, they have to be sent one by one
+        for (size_t i = last + (count > 0); count < _pending && i < _tags.size(); ++i)
+        {
+            // skip messages that are not pending
+            if (_tags[i] != state_pending) continue;
+
+            // send the ack
+            callback(_base + i, false);
+
+            // the message is settled
+            _tags[i] = state_settled;
+            ++count;
+        }
+
+        // nothing is pending anymore
+        _pending = 0;
+
+        // remove the messages that are now settled
+        prune();
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
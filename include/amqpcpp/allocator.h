@@ -0,0 +1,82 @@
+/**
+ *  Allocator.h
+ *
+ *  Interface that is used by the library to allocate memory for buffers
+ *  and message bodies. The default implementation simply calls malloc()
+ *  and free(), but you can install your own allocator on a connection
+ *  (for example the PoolAllocator that is also shipped with this library)
+ *  to prevent that the library calls the global allocator all the time.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <cstdlib>
+#include <stddef.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class Allocator
+{
+public:
+    /**
+     *  Destructor
+     */
+    virtual ~Allocator() = default;
+
+    /**
+     *  Allocate a block of memory
+     *  @param  size        number of bytes to allocate
+     *  @return void*       the allocated memory
+     */
+    virtual void *allocate(size_t size)
+    {
+        // use the global allocator
+        return malloc(size);
+    }
+
+    /**
+     *  Deallocate a block of memory that was returned by allocate()
+     *  @param  pointer     the memory to release (may be nullptr)
+     *  @param  size        the size that was passed to allocate()
+     */
+    virtual void deallocate(void *pointer, size_t size)
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) size;
+
+        // use the global allocator
+        free(pointer);
+    }
+
+    /**
+     *  The default allocator, which uses malloc() and free()
+     *  @return Allocator*
+     */
+    static Allocator *standard()
+    {
+        // there is only one such instance
+        static Allocator allocator;
+
+        // expose it
+        return &allocator;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
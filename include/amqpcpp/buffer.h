@@ -74,6 +74,28 @@ public:
      */
     virtual void *copy(size_t pos, size_t size, void *buffer) const = 0;
 
+    /**
+     *  Get access to the raw data, but only if the data is stored in one
+     *  continuous block of memory
+     * 
+     *  This is an optimization: the frame parser uses this to decode frames
+     *  straight from memory instead of calling byte() and copy() for every 
+     *  field. Buffers that store data in fragments (and that would need to 
+     *  copy the data in their data() method) should return nullptr.
+     * 
+     *  @param  pos         position in the buffer
+     *  @param  size        number of continuous bytes
+     *  @return char*       pointer to the data, or nullptr if not continuous
+     */
+    virtual const char *contiguous(size_t pos, size_t size) const
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) pos;
+        (void) size;
+
+        // by default we make no promises
+        return nullptr;
+    }
 };
 
 /**
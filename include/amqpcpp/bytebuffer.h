@@ -132,6 +132,21 @@ public:
     {
         return memcpy(buffer, _data + pos, size);
     }
+
+    /**
+     *  Get access to the raw data (which is always continuous)
+     *  @param  pos         position in the buffer
+     *  @param  size        number of continuous bytes
+     *  @return char*
+     */
+    virtual const char *contiguous(size_t pos, size_t size) const override
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) size;
+
+        // expose the data
+        return _data + pos;
+    }
 };
 
 /**
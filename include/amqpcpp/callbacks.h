@@ -27,6 +27,8 @@ namespace AMQP {
  */
 class Message;
 class MetaData;
+class StringView;
+class MessageView;
 
 /**
  *  Generic callbacks that are used by many deferred objects
@@ -59,6 +61,7 @@ using CancelCallback        =   std::function<void(const std::string &consumer)>
  *  The following methods receive the returned message in multiple parts
  */
 using StartCallback         =   std::function<void(const std::string &exchange, const std::string &routingkey)>;
+using StartViewCallback     =   std::function<void(const StringView &exchange, const StringView &routingkey)>;
 using HeaderCallback        =   std::function<void(const MetaData &metaData)>;
 using DataCallback          =   std::function<void(const char *data, size_t size)>;
 using DeliveredCallback     =   std::function<void(uint64_t deliveryTag, bool redelivered)>;
@@ -76,6 +79,7 @@ using ReturnedCallback      =   std::function<void()>;
  *  implement callbacks that return the collected message.
  */
 using MessageCallback       =   std::function<void(const Message &message, uint64_t deliveryTag, bool redelivered)>;
+using BatchCallback         =   std::function<void(const MessageView *messages, size_t count)>;
 using BounceCallback        =   std::function<void(const Message &message, int16_t code, const std::string &description)>;
 
 /**
@@ -85,6 +89,15 @@ using BounceCallback        =   std::function<void(const Message &message, int16
 using AckCallback           =   std::function<void(uint64_t deliveryTag, bool multiple)>;
 using NackCallback          =   std::function<void(uint64_t deliveryTag, bool multiple, bool requeue)>;
 
+/**
+ *  When using the ConfirmedPublisher, these callbacks are called for the individual
+ *  messages: when the server acks or nacks the message, or when the channel fails
+ *  before the server has confirmed the message.
+ */
+using PublishAckCallback    =   std::function<void()>;
+using PublishNackCallback   =   std::function<void()>;
+using PublishLostCallback   =   std::function<void()>;
+
 /**
  *  End namespace
  */
@@ -26,6 +26,11 @@ private:
      */
     std::shared_ptr<ChannelImpl> _implementation;
 
+    /**
+     *  The confirmed publisher needs access to the implementation
+     */
+    friend class ConfirmedPublisher;
+
 public:
     /**
      *  Construct a channel object
@@ -405,6 +410,21 @@ public:
     DeferredPublisher &publish(const std::string &exchange, const std::string &routingKey, const char *message, size_t size, int flags = 0) { return _implementation->publish(exchange, routingKey, Envelope(message, size), flags); }
     DeferredPublisher &publish(const std::string &exchange, const std::string &routingKey, const char *message, int flags = 0) { return _implementation->publish(exchange, routingKey, Envelope(message, strlen(message)), flags); }
 
+    /**
+     *  Publish a message using a publish template
+     *
+     *  The template holds the exchange, the routing key, the flags and the properties
+     *  of the message in encoded form. This is faster than the other publish() methods
+     *  if many messages with the same properties are published, because the frames
+     *  do not have to be encoded for every message.
+     *
+     *  @param  tpl         the publish template
+     *  @param  message     the message to send
+     *  @param  size        size of the message
+     */
+    DeferredPublisher &publish(const PublishTemplate &tpl, const std::string &message) { return _implementation->publish(tpl, message.data(), message.size()); }
+    DeferredPublisher &publish(const PublishTemplate &tpl, const char *message, size_t size) { return _implementation->publish(tpl, message, size); }
+
     /**
      *  Set the Quality of Service (QOS) for this channel
      *
@@ -414,6 +434,9 @@ public:
      *  stops delivering more messages if the number of unack'ed messages has reached
      *  the prefetchCount
      *
+     *  Calling this method stops the runtime adjustment of the prefetch count
+     *  that was started with adaptQos().
+     *
      *  @param  prefetchCount       maximum number of messages to prefetch
      *  @param  global              share counter between all consumers on the same channel
      *  @return bool                whether the Qos frame is sent.
@@ -423,6 +446,40 @@ public:
         return _implementation->setQos(prefetchCount, global);
     }
 
+    /**
+     *  Adjust the prefetch count at runtime
+     *
+     *  Instead of a fixed prefetch count, the channel measures how fast your
+     *  application acks the messages, and how long it takes for the broker
+     *  to deliver new messages once the window is freed up. Every 100ms the
+     *  prefetch count is set to twice the number of messages that are on
+     *  their way (within the bounds), so that the consumer stays busy without
+     *  a big backlog in memory. The prefetch count is shared by all consumers
+     *  on the channel.
+     *
+     *  The decisions are based on the acks, so this is pointless for consumers
+     *  that use the noack flag. Use qosMetrics() to inspect the controller.
+     *
+     *  @param  minimum             the lowest prefetch count (this is where it starts)
+     *  @param  maximum             the highest prefetch count
+     */
+    void adaptQos(uint16_t minimum = 1, uint16_t maximum = 1000)
+    {
+        _implementation->adaptQos(minimum, maximum);
+    }
+
+    /**
+     *  The metrics of the runtime adjustment of the prefetch count: the current
+     *  prefetch count, the number of unacked messages, the ack rate, the latency
+     *  of your application, the broker round trip, and the number of times that
+     *  the prefetch count was changed (all zero if adaptQos() was not called)
+     *  @return QosMetrics
+     */
+    QosMetrics qosMetrics() const
+    {
+        return _implementation->qosMetrics();
+    }
+
     /**
      *  Tell the RabbitMQ server that we're ready to consume messages
      *
@@ -554,6 +611,35 @@ public:
      */
     bool reject(uint64_t deliveryTag, int flags=0) { return _implementation->reject(deliveryTag, flags); }
 
+    /**
+     *  Coalesce acknowledgements
+     *
+     *  When this is enabled, calls to ack() do not send out a frame right away.
+     *  The acks are held back until the connection is done parsing the incoming
+     *  data, until the threshold is reached, or until a synchronous frame (like
+     *  a close or recover instruction) is sent over the channel. Acks for a
+     *  contiguous run of delivery tags are then combined into a single frame
+     *  with the "multiple" bit set. Acks that follow a message that is not yet
+     *  acked are still sent one by one.
+     *
+     *  Acks that are made outside the callbacks of the library are sent when
+     *  your ConnectionHandler::onPending() method tells it to wait for a call
+     *  to Connection::flush() (the TcpHandler does this in the next iteration
+     *  of the event loop), and right away otherwise.
+     *
+     *  You should enable this before you start consuming: if messages were
+     *  already delivered, the "multiple" bit can not be used safely.
+     *
+     *  @param  threshold           max number of acks to hold back (0 to send them right away)
+     */
+    void coalesceAcks(size_t threshold = 256) { _implementation->coalesceAcks(threshold); }
+
+    /**
+     *  Send out the acknowledgements that are held back right away
+     *  @return bool
+     */
+    bool flushAcks() { return _implementation->flushAcks(); }
+
     /**
      *  Recover all messages that were not yet acked
      *
@@ -22,6 +22,9 @@
 #include "copiedbuffer.h"
 #include "deferred.h"
 #include "monitor.h"
+#include "consumertable.h"
+#include "ackwindow.h"
+#include "qoscontroller.h"
 #include <memory>
 #include <queue>
 #include <map>
@@ -46,6 +49,7 @@ class DeferredConfirm;
 class DeferredQueue;
 class DeferredGet;
 class DeferredPublisher;
+class PublishTemplate;
 class Connection;
 class Envelope;
 class Table;
@@ -89,9 +93,9 @@ private:
 
     /**
      *  Handlers for all consumers that are active
-     *  @var    std::map<std::string,std::shared_ptr<DeferredConsumer>
+     *  @var    ConsumerTable
      */
-    std::map<std::string,std::shared_ptr<DeferredConsumer>> _consumers;
+    ConsumerTable _consumers;
 
     /**
      *  Pointer to the oldest deferred result (the first one that is going
@@ -148,6 +152,43 @@ private:
      */
     std::shared_ptr<DeferredReceiver> _receiver;
 
+    /**
+     *  The last delivery tag that was received
+     *  @var uint64_t
+     */
+    uint64_t _delivered = 0;
+
+    /**
+     *  Acks that are held back to be coalesced (nullptr if acks are sent right away)
+     *  @var std::unique_ptr<AckWindow>
+     */
+    std::unique_ptr<AckWindow> _acks;
+
+    /**
+     *  Controller that adjusts the prefetch count (nullptr if the prefetch count is fixed)
+     *  @var std::unique_ptr<QosController>
+     */
+    std::unique_ptr<QosController> _qos;
+
+    /**
+     *  Is a new prefetch count held back until the acks of the current batch are sent?
+     *  @var bool
+     */
+    bool _requalify = false;
+
+    /**
+     *  Hold back an ack that was registered in the window
+     *  @return bool
+     */
+    bool hold();
+
+    /**
+     *  Let the prefetch controller know that messages were acked or rejected
+     *  @param  deliveryTag     the delivery tag
+     *  @param  flags           the flags of the ack or reject
+     */
+    void settled(uint64_t deliveryTag, int flags);
+
     /**
      *  Attach the connection
      *  @param  connection
@@ -169,6 +210,26 @@ private:
      */
     Deferred &push(const Frame &frame);
 
+    /**
+     *  Send a message given the method frame and the header frame
+     *  @param  method      the method frame
+     *  @param  header      the header frame
+     *  @param  data        the message body
+     *  @param  size        size of the message body
+     *  @return bool        was the message sent?
+     */
+    bool send(const Frame &method, const Frame &header, const char *data, uint64_t size);
+
+    /**
+     *  Send a message by passing all frames to the handler in a single call
+     *  @param  method      the method frame
+     *  @param  header      the header frame
+     *  @param  data        the message body
+     *  @param  size        size of the message body
+     *  @return bool        was the message sent?
+     */
+    bool gather(const Frame &method, const Frame &header, const char *data, uint64_t size);
+
 protected:
     /**
      *  Construct a channel object
@@ -428,6 +489,38 @@ public:
      */
     DeferredPublisher &publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags);
 
+    /**
+     *  Publish a message using a publish template
+     *  @param  tpl         the publish template
+     *  @param  data        the message body
+     *  @param  size        size of the message body
+     *  @return DeferredPublisher
+     */
+    DeferredPublisher &publish(const PublishTemplate &tpl, const char *data, uint64_t size);
+
+    /**
+     *  Send a message to an exchange, and report whether it was sent. A message is
+     *  not sent if the channel is not usable, or if the method frame or the header
+     *  frame (for example because of a very long routing key or big headers) does
+     *  not fit in the max frame size of the connection. In that case, nothing of
+     *  the message is sent, so it does not get a delivery tag either
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingkey  the routing key
+     *  @param  envelope    the full envelope to send
+     *  @param  flags       optional flags
+     *  @return bool        was the message sent?
+     */
+    bool send(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags);
+
+    /**
+     *  Send a message using a publish template, and report whether it was sent
+     *  @param  tpl         the publish template
+     *  @param  data        the message body
+     *  @param  size        size of the message body
+     *  @return bool        was the message sent?
+     */
+    bool send(const PublishTemplate &tpl, const char *data, uint64_t size);
+
     /**
      *  Set the Quality of Service (QOS) of the entire connection
      *  @param  prefetchCount       maximum number of messages to prefetch
@@ -440,6 +533,22 @@ public:
      */
     Deferred &setQos(uint16_t prefetchCount, bool global = false);
 
+    /**
+     *  Adjust the prefetch count at runtime
+     *  @param  minimum     the lowest prefetch count
+     *  @param  maximum     the highest prefetch count
+     */
+    void adaptQos(uint16_t minimum, uint16_t maximum);
+
+    /**
+     *  The metrics of the prefetch controller (all zero if it is not active)
+     *  @return QosMetrics
+     */
+    QosMetrics qosMetrics() const
+    {
+        return _qos ? _qos->metrics() : QosMetrics();
+    }
+
     /**
      *  Tell the RabbitMQ server that we're ready to consume messages
      *  @param  queue               the queue from which you want to consume
@@ -530,6 +639,18 @@ public:
      *  @return bool
      */
     bool reject(uint64_t deliveryTag, int flags);
+
+    /**
+     *  Coalesce acknowledgements
+     *  @param  threshold           max number of acks to hold back (0 to send them right away)
+     */
+    void coalesceAcks(size_t threshold);
+
+    /**
+     *  Send out the acknowledgements (and the new prefetch count) that are held back
+     *  @return bool
+     */
+    bool flushAcks();
     
     /**
      *  Recover messages that were not yet ack'ed
@@ -686,7 +807,35 @@ public:
     void install(const std::string &consumertag, const std::shared_ptr<DeferredConsumer> &consumer)
     {
         // install the consumer handler
-        _consumers[consumertag] = consumer;
+        _consumers.install(consumertag, consumer);
+    }
+
+    /**
+     *  Let the connection report the batch of a consumer when it is done parsing
+     *  @param  consumer        The consumer object
+     */
+    void batch(const std::shared_ptr<DeferredConsumer> &consumer);
+
+    /**
+     *  Pause the connection, because a sink can not keep up with the incoming data
+     */
+    void throttle();
+
+    /**
+     *  Register a message that was delivered
+     *  @param  deliveryTag     the delivery tag
+     *  @param  noack           was it delivered to a consumer that does not ack?
+     */
+    void delivered(uint64_t deliveryTag, bool noack)
+    {
+        // remember the tag
+        _delivered = deliveryTag;
+
+        // if acks are coalesced we have to know which messages were delivered
+        if (_acks) _acks->delivered(deliveryTag, noack);
+
+        // the prefetch controller watches the messages that count for the prefetch window
+        if (_qos && !noack) _qos->delivered(deliveryTag);
     }
 
     /**
@@ -706,7 +855,7 @@ public:
     void uninstall(const std::string &consumertag)
     {
         // erase the callback
-        _consumers.erase(consumertag);
+        _consumers.uninstall(consumertag);
     }
 
     /**
@@ -714,7 +863,23 @@ public:
      *  @param  consumertag the consumer tag
      *  @return             the receiver object
      */
-    DeferredConsumer *consumer(const std::string &consumertag) const;
+    DeferredConsumer *consumer(const std::string &consumertag) const
+    {
+        // pass on to the table
+        return _consumers.find(consumertag.data(), consumertag.size());
+    }
+
+    /**
+     *  Fetch the receiver for the raw bytes of a consumer tag
+     *  @param  data        the consumer tag
+     *  @param  size        size of the consumer tag
+     *  @return             the receiver object
+     */
+    DeferredConsumer *consumer(const char *data, size_t size) const
+    {
+        // pass on to the table
+        return _consumers.find(data, size);
+    }
 
     /**
      *  Retrieve the current object that is receiving a message
@@ -734,6 +899,12 @@ public:
      */
     DeferredConfirm *confirm() const { return _confirm.get(); }
 
+    /**
+     *  The allocator for message bodies (from the connection)
+     *  @return Allocator*
+     */
+    Allocator *allocator() const;
+
     /**
      *  The channel class is its friend, thus can it instantiate this object
      */
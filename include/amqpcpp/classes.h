@@ -19,6 +19,7 @@ namespace AMQP {
 /**
  *  All classes defined by this library
  */
+class Allocator;
 class Array;
 class BasicDeliverFrame;
 class BasicGetOKFrame;
@@ -28,15 +29,18 @@ class BasicAckFrame;
 class BasicNackFrame;
 class BodyFrame;
 class Channel;
+class ConfirmedPublisher;
 class Connection;
 class ConnectionHandler;
 class ConnectionImpl;
 class CopiedBuffer;
 class Exchange;
 class Frame;
+class GatherBuffer;
 class Login;
 class Monitor;
 class OutBuffer;
+class PublishTemplate;
 class ReceivedFrame;
 class Table;
 
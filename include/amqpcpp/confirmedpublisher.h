@@ -0,0 +1,219 @@
+/**
+ *  ConfirmedPublisher.h
+ *
+ *  Publisher that puts a channel in confirm mode, and that keeps track of the
+ *  delivery tags of the published messages. Every call to publish() returns a
+ *  DeferredPublish object for that specific message, that reports whether the
+ *  message was acked or nacked by the server, or lost because the channel
+ *  failed. The number of messages that are not yet confirmed can be limited:
+ *  when the window is full, publish() fails until the server has confirmed
+ *  earlier messages, and the onAvailable() callback tells when that happened.
+ *
+ *  The publisher should be the only one that publishes messages over the
+ *  channel, and you should not install other callbacks for publisher confirms
+ *  on the channel, because that would mess up the administration.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <vector>
+#include <memory>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class ConfirmedPublisher : public Watchable
+{
+private:
+    /**
+     *  The channel over which the messages are published
+     *  @var std::shared_ptr<ChannelImpl>
+     */
+    std::shared_ptr<ChannelImpl> _implementation;
+
+    /**
+     *  Ring with the messages that are not yet confirmed, indexed by delivery tag
+     *  (the size is always a power of two, empty slots are already confirmed)
+     *  @var std::vector
+     */
+    std::vector<std::shared_ptr<DeferredPublish>> _ring;
+
+    /**
+     *  Delivery tag of the oldest message that is not yet confirmed
+     *  @var uint64_t
+     */
+    uint64_t _oldest = 1;
+
+    /**
+     *  Delivery tag that the next message will get
+     *  @var uint64_t
+     */
+    uint64_t _next = 1;
+
+    /**
+     *  Max number of messages that are not yet confirmed (0 for no limit)
+     *  @var size_t
+     */
+    size_t _window;
+
+    /**
+     *  Did the channel fail?
+     *  @var bool
+     */
+    bool _failed = false;
+
+    /**
+     *  Object that is returned when a message could not be published
+     *  @var std::shared_ptr<DeferredPublish>
+     */
+    std::shared_ptr<DeferredPublish> _rejected;
+
+    /**
+     *  Callback to execute when the window is no longer full
+     *  @var SuccessCallback
+     */
+    SuccessCallback _availableCallback;
+
+    /**
+     *  The slot in the ring for a delivery tag
+     *  @param  tag         the delivery tag
+     *  @return std::shared_ptr<DeferredPublish>
+     */
+    std::shared_ptr<DeferredPublish> &slot(uint64_t tag)
+    {
+        // the ring size is a power of two
+        return _ring[tag & (_ring.size() - 1)];
+    }
+
+    /**
+     *  Add a message to the administration, after it was published
+     *  @return DeferredPublish
+     */
+    DeferredPublish &add();
+
+    /**
+     *  Return an object for a message that could not be published
+     *  @return DeferredPublish
+     */
+    DeferredPublish &reject();
+
+    /**
+     *  Process an ack or nack from the server
+     *  @param  tag         the delivery tag
+     *  @param  multiple    does it apply to all messages up to and including the tag?
+     *  @param  ack         was it an ack?
+     */
+    void process(uint64_t tag, bool multiple, bool ack);
+
+    /**
+     *  Report that all unconfirmed messages are lost
+     *  @param  message     the reason why the channel failed
+     */
+    void lost(const char *message);
+
+public:
+    /**
+     *  Constructor
+     *
+     *  The channel is put in confirm mode. The window is the max number of messages
+     *  that are published but not yet confirmed by the server (0 for no limit).
+     *
+     *  @param  channel     the channel to publish over
+     *  @param  window      max number of unconfirmed messages
+     */
+    ConfirmedPublisher(Channel &channel, size_t window = 0);
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    ConfirmedPublisher(const ConfirmedPublisher &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~ConfirmedPublisher() {}
+
+    /**
+     *  Number of messages that are published but not yet confirmed
+     *  @return size_t
+     */
+    size_t unconfirmed() const
+    {
+        // the confirmed messages in between do not count, they are still in the window
+        return (size_t)(_next - _oldest);
+    }
+
+    /**
+     *  Is the window full? In that case publish() fails
+     *  @return bool
+     */
+    bool full() const
+    {
+        // check the window
+        return _window > 0 && unconfirmed() >= _window;
+    }
+
+    /**
+     *  Callback that is called when the window is no longer full, this is
+     *  the moment to start publishing again
+     *  @param  callback    the callback to execute
+     */
+    ConfirmedPublisher &onAvailable(const SuccessCallback &callback)
+    {
+        // store callback
+        _availableCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
+
+    /**
+     *  Publish a message to an exchange
+     *
+     *  These methods are the same as the Channel::publish() methods, but they return
+     *  an object for this specific message. If the window is full, or when the channel
+     *  can not be used, the message is not published and the returned object is in a
+     *  failed state.
+     *
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingkey  the routing key
+     *  @param  envelope    the full envelope to send
+     *  @param  message     the message to send
+     *  @param  size        size of the message
+     *  @param  flags       optional flags
+     *  @return DeferredPublish
+     */
+    DeferredPublish &publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags = 0);
+    DeferredPublish &publish(const std::string &exchange, const std::string &routingKey, const std::string &message, int flags = 0) { return publish(exchange, routingKey, Envelope(message.data(), message.size()), flags); }
+    DeferredPublish &publish(const std::string &exchange, const std::string &routingKey, const char *message, size_t size, int flags = 0) { return publish(exchange, routingKey, Envelope(message, size), flags); }
+    DeferredPublish &publish(const std::string &exchange, const std::string &routingKey, const char *message, int flags = 0) { return publish(exchange, routingKey, Envelope(message, strlen(message)), flags); }
+
+    /**
+     *  Publish a message using a publish template
+     *  @param  tpl         the publish template
+     *  @param  message     the message to send
+     *  @param  size        size of the message
+     *  @return DeferredPublish
+     */
+    DeferredPublish &publish(const PublishTemplate &tpl, const char *message, size_t size);
+    DeferredPublish &publish(const PublishTemplate &tpl, const std::string &message) { return publish(tpl, message.data(), message.size()); }
+};
+
+/**
+ *  End of namespace
+ */
+}
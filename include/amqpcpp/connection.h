@@ -146,6 +146,74 @@ public:
     {
         return _implementation.parse(buffer);
     }
+
+    /**
+     *  Send out the frames that are held back
+     *
+     *  Channels that coalesce their acknowledgements hold them back for a while.
+     *  This method sends them out right away. You normally call it after your
+     *  ConnectionHandler::onPending() method was called.
+     */
+    void flush()
+    {
+        _implementation.flush();
+    }
+
+    /**
+     *  Pause the processing of incoming data
+     *
+     *  When the processing is paused (by this method, or because a Sink returned
+     *  false), the parse() method stops right after the frame that it is
+     *  processing, and it returns the number of bytes that were processed up to
+     *  that point. You should stop reading from the socket, and call parse()
+     *  again with the remaining data after you have called resume().
+     */
+    void pause()
+    {
+        _implementation.pause();
+    }
+
+    /**
+     *  Resume the processing of incoming data
+     */
+    void resume()
+    {
+        _implementation.resume();
+    }
+
+    /**
+     *  Is the processing of incoming data paused?
+     *  @return bool
+     */
+    bool paused() const
+    {
+        return _implementation.paused();
+    }
+
+    /**
+     *  Get the memory where the payload of a body frame is going to be stored
+     *
+     *  When a message body is spread over multiple frames, the library allocates 
+     *  one buffer for the full body and copies the payload of each body frame 
+     *  into it. If your IO layer has already received the header of a body frame
+     *  (type 3), it can call this method with the channel and payload size from
+     *  that header to find out where the payload is going to end up, and read 
+     *  the payload from the socket straight into that memory. When the frame is
+     *  then passed to parse() with a Buffer object whose data() method returns 
+     *  this same pointer for the payload, no copy is made.
+     *
+     *  This method returns nullptr if the payload can not be received this way
+     *  (for example because the body fits in a single frame, which is never 
+     *  copied anyway, or because nobody is interested in the full message).
+     *
+     *  @param  channel     channel number from the frame header
+     *  @param  size        payload size from the frame header
+     *  @return char*       memory for the payload, or nullptr
+     */
+    char *destination(uint16_t channel, uint32_t size)
+    {
+        return _implementation.destination(channel, size);
+    }
     
     /**
      *  Report that the connection was lost in the middle of an operation
@@ -195,6 +263,33 @@ public:
     {
         return _implementation.expected();
     }
+
+    /**
+     *  The allocator that is used for buffers and message bodies
+     *  @return Allocator*
+     */
+    Allocator *allocator() const
+    {
+        return _implementation.allocator();
+    }
+
+    /**
+     *  Install a different allocator for buffers and message bodies.
+     * 
+     *  By default, the library uses malloc() and free() for buffers that
+     *  have to be kept in memory (like outgoing frames that cannot be sent
+     *  right away and the bodies of incoming messages). You can install your
+     *  own allocator (for example a PoolAllocator) to reuse memory instead.
+     *  This should be done right after the connection was constructed, and
+     *  the allocator must stay valid for as long as the connection exists.
+     *  Pass nullptr to go back to malloc() and free().
+     * 
+     *  @param  allocator
+     */
+    void allocator(Allocator *allocator)
+    {
+        _implementation.allocator(allocator);
+    }
     
     /**
      *  Is the connection ready to accept instructions / has passed the login handshake?
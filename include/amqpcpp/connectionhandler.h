@@ -19,6 +19,7 @@
  */
 #include <cstdint>
 #include <stddef.h>
+#include "gatherbuffer.h"
 
 /**
  *  Set up namespace
@@ -118,6 +119,53 @@ public:
      */
     virtual void onData(Connection *connection, const char *buffer, size_t size) = 0;
 
+    /**
+     *  Method that is called by AMQP-CPP when a group of frames has to be sent
+     *  over the network. This happens when a message is published: the body of
+     *  the message is not copied into the buffer, but the buffer consists of a
+     *  number of segments that refer to the original data. Only the (small) frame
+     *  headers and trailers are copied.
+     *
+     *  The segments are only valid for the duration of this call. If you can not
+     *  send out all data right away, you must buffer the remaining bytes yourself.
+     *
+     *  The default implementation passes each segment to the regular onData()
+     *  method. You can override this method if your IO layer supports
+     *  scatter/gather output (like writev() or sendmsg()).
+     *
+     *  @param  connection      The connection that created this output
+     *  @param  buffer          Segments with data to send
+     */
+    virtual void onData(Connection *connection, const GatherBuffer &buffer)
+    {
+        // pass on all segments one by one
+        for (size_t i = 0; i < buffer.count(); ++i) onData(connection, buffer.data(i), buffer.size(i));
+    }
+
+    /**
+     *  Method that is called when the connection holds back outgoing frames
+     *  outside a call to Connection::parse(). This happens when a channel
+     *  coalesces its acknowledgements (see Channel::coalesceAcks()). Frames
+     *  that are held back during parse() are sent when parse() returns, but
+     *  outside parse() the library needs your help to decide when to send them.
+     *
+     *  If you return true, you promise to call Connection::flush() soon, for
+     *  example in the next iteration of your event loop. The default
+     *  implementation returns false, which means that the frames are sent
+     *  right away.
+     *
+     *  @param  connection      The connection that holds back frames
+     *  @return bool            Will you call Connection::flush()?
+     */
+    virtual bool onPending(Connection *connection)
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) connection;
+
+        // frames are sent right away
+        return false;
+    }
+
     /**
      *  Method that is called when the AMQP-CPP library received a heartbeat 
      *  frame that was sent by the server to the client.
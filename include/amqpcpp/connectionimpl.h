@@ -37,6 +37,7 @@ namespace AMQP {
 class Connection;
 class Buffer;
 class Frame;
+class DeferredConsumer;
 
 /**
  *  Class definition
@@ -88,6 +89,30 @@ protected:
      */
     uint16_t _nextFreeChannel = 1;
 
+    /**
+     *  Consumers that collected a batch of messages during the current call to parse()
+     *  @var    std::vector<std::shared_ptr<DeferredConsumer>>
+     */
+    std::vector<std::shared_ptr<DeferredConsumer>> _batches;
+
+    /**
+     *  Channels that hold back frames that have to be sent out later
+     *  @var    std::vector<uint16_t>
+     */
+    std::vector<uint16_t> _pending;
+
+    /**
+     *  Are we busy parsing incoming data?
+     *  @var    bool
+     */
+    bool _parsing = false;
+
+    /**
+     *  Is the processing of incoming data paused?
+     *  @var    bool
+     */
+    bool _paused = false;
+
     /**
      *  Max number of channels (0 for unlimited)
      *  @var    uint16_t
@@ -124,6 +149,12 @@ protected:
      *  @var    queue
      */
     std::queue<CopiedBuffer> _queue;
+
+    /**
+     *  Allocator for buffers and message bodies
+     *  @var    Allocator
+     */
+    Allocator *_allocator = Allocator::standard();
     
     /**
      *  Helper method to send the close frame
@@ -152,6 +183,30 @@ protected:
      */
     bool fail(const Monitor &monitor, const char *message);
 
+    /**
+     *  Process the frames in a buffer (helper for the parse() method)
+     *  @param  buffer      buffer to decode
+     *  @return uint64_t    number of bytes that were processed
+     */
+    uint64_t receive(const Buffer &buffer);
+
+    /**
+     *  Let a consumer report its batch of messages at the end of the current call to parse()
+     *  @param  consumer
+     */
+    void batch(const std::shared_ptr<DeferredConsumer> &consumer)
+    {
+        // add to the list
+        _batches.push_back(consumer);
+    }
+
+    /**
+     *  Let a channel send out the frames that it holds back at a later time
+     *  @param  channel
+     *  @return bool        false if the frames can not be held back
+     */
+    bool defer(const ChannelImpl *channel);
+
 private:
     /**
      *  Construct an AMQP object based on full login data
@@ -319,6 +374,25 @@ public:
         return _expected;
     }
 
+    /**
+     *  The allocator that is used for buffers and message bodies
+     *  @return Allocator
+     */
+    Allocator *allocator() const
+    {
+        return _allocator;
+    }
+
+    /**
+     *  Install a different allocator. The allocator must stay valid for as long
+     *  as the connection exists, pass nullptr to go back to malloc() and free()
+     *  @param  allocator
+     */
+    void allocator(Allocator *allocator)
+    {
+        _allocator = allocator ? allocator : Allocator::standard();
+    }
+
     /**
      *  Add a channel to the connection, and return the channel ID that it
      *  is allowed to use, or 0 when no more ID's are available
@@ -350,6 +424,45 @@ public:
      */
     uint64_t parse(const Buffer &buffer);
 
+    /**
+     *  Send out the frames that are held back by the channels
+     */
+    void flush();
+
+    /**
+     *  Pause the processing of incoming data: the current call to parse() stops
+     *  right after the frame that is being processed
+     */
+    void pause()
+    {
+        _paused = true;
+    }
+
+    /**
+     *  Resume the processing of incoming data
+     */
+    void resume()
+    {
+        _paused = false;
+    }
+
+    /**
+     *  Is the processing of incoming data paused?
+     *  @return bool
+     */
+    bool paused() const
+    {
+        return _paused;
+    }
+
+    /**
+     *  Memory where the payload of a body frame is going to be stored
+     *  @param  channel     channel number from the frame header
+     *  @param  size        payload size from the frame header
+     *  @return char*       pointer to the memory, or nullptr if not available
+     */
+    char *destination(uint16_t channel, uint32_t size);
+
     /**
      *  Fail all pending - this can be called by user-space when it is recognized that the 
      *  underlying connection is lost. All error-handlers for all operations and open
@@ -383,6 +496,27 @@ public:
      */
     bool send(CopiedBuffer &&buffer);
 
+    /**
+     *  Can data be passed on to the handler right away? This is the case when the
+     *  connection is ready, and there are no earlier frames waiting to be sent.
+     *  @return bool
+     */
+    bool passthrough() const
+    {
+        return _state == state_connected && !_closed && _queue.empty();
+    }
+
+    /**
+     *  Send a group of frames over the connection in a single call to the handler
+     *
+     *  This only works if the data can be passed on right away (see passthrough()),
+     *  because the buffer refers to data that is not managed by the library.
+     *
+     *  @param  buffer      the segments with data to send
+     *  @return bool
+     */
+    bool send(const GatherBuffer &buffer);
+
     /**
      *  Get a channel by its identifier
      *
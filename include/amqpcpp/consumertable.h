@@ -0,0 +1,249 @@
+/**
+ *  ConsumerTable.h
+ *
+ *  The consumers that are active on a channel. An open-addressing hash table
+ *  over the raw bytes of the consumer tags maps incoming deliveries to the
+ *  consumer, without allocating memory and with (almost always) a single
+ *  memcmp() per delivery. This is an internal class of the channel.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <stdint.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Forward declarations
+ */
+class DeferredConsumer;
+
+/**
+ *  Class definition
+ */
+class ConsumerTable
+{
+private:
+    /**
+     *  A consumer that is installed
+     */
+    struct Entry
+    {
+        /**
+         *  The consumer tag, and its hash
+         *  @var std::string
+         *  @var uint32_t
+         */
+        std::string tag;
+        uint32_t hash;
+
+        /**
+         *  The consumer (nullptr if the entry is not in use)
+         *  @var std::shared_ptr<DeferredConsumer>
+         */
+        std::shared_ptr<DeferredConsumer> consumer;
+    };
+
+    /**
+     *  All consumers
+     *  @var std::vector<Entry>
+     */
+    std::vector<Entry> _entries;
+
+    /**
+     *  Entries that are no longer in use and that can be filled again
+     *  @var std::vector<uint32_t>
+     */
+    std::vector<uint32_t> _free;
+
+    /**
+     *  Hash table with (index + 1) of the entries, zero for empty buckets, the
+     *  size is always a power of two and at least twice the number of consumers
+     *  @var std::vector<uint32_t>
+     */
+    std::vector<uint32_t> _buckets;
+
+    /**
+     *  Number of consumers that are installed
+     *  @var size_t
+     */
+    size_t _size = 0;
+
+    /**
+     *  Calculate the hash of a consumer tag (FNV-1a)
+     *  @param  data
+     *  @param  size
+     *  @return uint32_t
+     */
+    static uint32_t hash(const char *data, size_t size)
+    {
+        // the initial value
+        uint32_t result = 2166136261u;
+
+        // process all bytes
+        for (size_t i = 0; i < size; ++i) result = (result ^ (uint8_t)data[i]) * 16777619u;
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Find the bucket of a consumer tag
+     *  @param  data
+     *  @param  size
+     *  @param  hash
+     *  @return size_t      the bucket that holds the tag, or the empty bucket where it should go
+     */
+    size_t bucket(const char *data, size_t size, uint32_t hash) const
+    {
+        // the mask to wrap around
+        size_t mask = _buckets.size() - 1;
+
+        // linear probing (there always is an empty bucket)
+        for (size_t i = hash & mask; true; i = (i + 1) & mask)
+        {
+            // an empty bucket ends the search
+            if (_buckets[i] == 0) return i;
+
+            // the entry in the bucket
+            const Entry &entry = _entries[_buckets[i] - 1];
+
+            // compare the tag
+            if (entry.hash == hash && entry.tag.size() == size && memcmp(entry.tag.data(), data, size) == 0) return i;
+        }
+    }
+
+    /**
+     *  Rebuild the hash table
+     *  @param  buckets     the new number of buckets (a power of two)
+     */
+    void rebuild(size_t buckets)
+    {
+        // start with an empty table
+        _buckets.assign(buckets, 0);
+
+        // insert all entries that are in use
+        for (size_t index = 0; index < _entries.size(); ++index)
+        {
+            // skip entries that are not in use
+            if (!_entries[index].consumer) continue;
+
+            // put it in its bucket
+            auto &entry = _entries[index];
+            _buckets[bucket(entry.tag.data(), entry.tag.size(), entry.hash)] = (uint32_t)index + 1;
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     */
+    ConsumerTable() : _buckets(16, 0) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~ConsumerTable() {}
+
+    /**
+     *  Install a consumer (replacing a consumer with the same tag)
+     *  @param  tag         the consumer tag
+     *  @param  consumer    the consumer object
+     */
+    void install(const std::string &tag, const std::shared_ptr<DeferredConsumer> &consumer)
+    {
+        // the hash and the bucket of the tag
+        uint32_t value = hash(tag.data(), tag.size());
+        size_t index = bucket(tag.data(), tag.size(), value);
+
+        // if the tag is already installed, we only replace the consumer
+        if (_buckets[index] != 0)
+        {
+            // replace the consumer
+            _entries[_buckets[index] - 1].consumer = consumer;
+
+            // done
+            return;
+        }
+
+        // reuse an entry, or create a new one
+        uint32_t entry = _free.empty() ? (uint32_t)_entries.size() : _free.back();
+        if (_free.empty()) _entries.emplace_back(); else _free.pop_back();
+
+        // store the consumer
+        _entries[entry].tag = tag;
+        _entries[entry].hash = value;
+        _entries[entry].consumer = consumer;
+
+        // grow the table if it becomes more than half full, otherwise we only fill the bucket
+        if (++_size * 2 > _buckets.size()) rebuild(_buckets.size() * 2);
+        else _buckets[index] = entry + 1;
+    }
+
+    /**
+     *  Uninstall a consumer
+     *  @param  tag         the consumer tag
+     */
+    void uninstall(const std::string &tag)
+    {
+        // find the bucket
+        size_t index = bucket(tag.data(), tag.size(), hash(tag.data(), tag.size()));
+
+        // skip if the tag is not installed
+        if (_buckets[index] == 0) return;
+
+        // the entry is no longer in use
+        uint32_t entry = _buckets[index] - 1;
+        _entries[entry].consumer = nullptr;
+        _entries[entry].tag.clear();
+        _free.push_back(entry);
+        --_size;
+
+        // consumers are seldom cancelled, so instead of leaving tombstones we rebuild the table
+        rebuild(_buckets.size());
+    }
+
+    /**
+     *  Find a consumer by its tag
+     *  @param  data        the raw bytes of the tag
+     *  @param  size        size of the tag
+     *  @return DeferredConsumer*
+     */
+    DeferredConsumer *find(const char *data, size_t size) const
+    {
+        // find the bucket
+        auto entry = _buckets[bucket(data, size, hash(data, size))];
+
+        // return the consumer
+        return entry == 0 ? nullptr : _entries[entry - 1].consumer.get();
+    }
+
+    /**
+     *  Number of consumers
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -19,6 +19,7 @@
 #include <cstring>
 #include "endian.h"
 #include "frame.h"
+#include "allocator.h"
 
 /**
  *  Set up namespace
@@ -31,6 +32,12 @@ namespace AMQP {
 class CopiedBuffer : public OutBuffer
 {
 private:
+    /**
+     *  The allocator that is used for the buffer
+     *  @var Allocator
+     */
+    Allocator *_allocator;
+
     /**
      *  The total capacity of the out buffer
      *  @var size_t
@@ -69,10 +76,12 @@ public:
     /**
      *  Constructor
      *  @param  frame
+     *  @param  allocator
      */
-    CopiedBuffer(const Frame &frame) :
+    CopiedBuffer(const Frame &frame, Allocator *allocator = Allocator::standard()) :
+        _allocator(allocator),
         _capacity(frame.totalSize()),
-        _buffer((char *)malloc(_capacity)) 
+        _buffer((char *)allocator->allocate(_capacity)) 
     {
         // tell the frame to fill this buffer
         frame.fill(*this);
@@ -92,6 +101,7 @@ public:
      *  @param  that
      */
     CopiedBuffer(CopiedBuffer &&that) :
+        _allocator(that._allocator),
         _capacity(that._capacity),
         _buffer(that._buffer),
         _size(that._size)
@@ -108,7 +118,7 @@ public:
     virtual ~CopiedBuffer()
     {
         // deallocate the buffer
-        free(_buffer);
+        _allocator->deallocate(_buffer, _capacity);
     }
 
     /**
@@ -35,6 +35,12 @@ private:
      */
     NackCallback _nackCallback;
 
+    /**
+     *  Callback to execute when the channel fails while in confirm mode
+     *  @var    ErrorCallback
+     */
+    ErrorCallback _lostCallback;
+
     /**
      *  Process an ACK frame
      *
@@ -49,6 +55,17 @@ private:
      */
     void process(BasicNackFrame &frame);
 
+    /**
+     *  Report that the channel failed, messages that were not yet confirmed are lost
+     *
+     *  @param  message The reason why the channel failed
+     */
+    void reportLost(const char *message)
+    {
+        // execute callback if registered
+        if (_lostCallback) _lostCallback(message);
+    }
+
     /**
      *  The channel implementation may call our
      *  private members and construct us
@@ -110,6 +127,21 @@ public:
         // allow chaining
         return *this;
     }
+
+    /**
+     *  Callback that is called when the channel fails (or is closed) while it is in
+     *  confirm mode, all messages that were not yet acked or nacked by the broker are
+     *  lost: they may or may not have been received by the broker
+     *  @param  callback    the callback to execute
+     */
+    DeferredConfirm &onLost(const ErrorCallback &callback)
+    {
+        // store callback
+        _lostCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
 };
 
 /**
@@ -38,6 +38,12 @@ private:
      */
     ConsumeCallback _consumeCallback;
 
+    /**
+     *  Callback for batches of messages
+     *  @var    BatchCallback
+     */
+    BatchCallback _batchCallback;
+
     /**
      *  Process a delivery frame
      *
@@ -58,11 +64,22 @@ private:
      */
     virtual std::shared_ptr<DeferredReceiver> lock() override { return shared_from_this(); }
 
+    /**
+     *  Indicate that a message was done
+     */
+    virtual void complete() override;
+
+    /**
+     *  Report the messages that were collected in the batch
+     */
+    void flush();
+
     /**
      *  The channel implementation may call our
      *  private members and construct us
      */
     friend class ChannelImpl;
+    friend class ConnectionImpl;
     friend class ConsumedMessage;
     friend class BasicDeliverFrame;
 
@@ -76,9 +93,10 @@ public:
      *
      *  @param  channel     the channel implementation
      *  @param  failed      are we already failed?
+     *  @param  noack       are messages delivered without the need to ack them?
      */
-    DeferredConsumer(ChannelImpl *channel, bool failed = false) :
-        DeferredExtReceiver(failed, channel) {}
+    DeferredConsumer(ChannelImpl *channel, bool failed = false, bool noack = false) :
+        DeferredExtReceiver(failed, channel, noack) {}
 
 public:
     /**
@@ -190,6 +208,27 @@ public:
         // allow chaining
         return *this;
     }
+
+    /**
+     *  Register the function that is called when the start frame of a new
+     *  consumed message is received, and that gets the exchange and routing
+     *  key as views on the received data instead of as strings
+     *
+     *  No memory is allocated to pass the exchange and routing key to this
+     *  callback, but the views are only valid during the callback: call
+     *  StringView::str() if you need a copy that lives longer.
+     *
+     *  @param  callback    The callback to invoke
+     *  @return Same object for chaining
+     */
+    DeferredConsumer &onBeginView(const StartViewCallback &callback)
+    {
+        // store callback
+        _startViewCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
     
     /**
      *  Register a function that is called when the message size is known
@@ -243,6 +282,33 @@ public:
         return *this;
     }
 
+    /**
+     *  Install a sink that receives the body of the messages while they come in
+     *
+     *  This is meant for messages that are too big to keep in memory: every
+     *  chunk of the body is passed to Sink::write() right after it was
+     *  received. If the sink can not keep up (for example because it writes
+     *  to a slow disk or socket), it returns false. The connection then stops
+     *  reading from the socket, so that the memory use stays bounded, until you
+     *  call resume() on the connection. The sink is not owned by the consumer,
+     *  and it must stay valid for as long as it is installed.
+     *
+     *  If you install a sink, you normally do not want to install the
+     *  onReceived() callback, because that would collect the full message in
+     *  memory after all.
+     *
+     *  @param  sink        The sink (or nullptr to remove it)
+     *  @return Same object for chaining
+     */
+    DeferredConsumer &onSink(Sink *sink)
+    {
+        // store the sink
+        _sink = sink;
+
+        // allow chaining
+        return *this;
+    }
+
     /**
      *  Register a funtion to be called when a message was completely received
      *
@@ -272,6 +338,35 @@ public:
         // allow chaining
         return *this;
     }
+
+    /**
+     *  Register a function to be called with batches of messages
+     *
+     *  Instead of reporting every message separately, the consumer collects all
+     *  messages that are completed while the connection parses a block of incoming
+     *  data, and passes them to this callback in one go when the connection is
+     *  done parsing. The MessageView objects, and all data that they refer to,
+     *  are only valid for the duration of the callback. When this callback is
+     *  installed, the onReceived() and onDelivered() callbacks are no longer called.
+     *
+     *  A typical callback processes the messages, and acknowledges all of them
+     *  with a single call: channel.ack(messages[count-1].deliveryTag(), AMQP::multiple)
+     *
+     *  @param  callback    The callback to invoke
+     *  @return Same object for chaining
+     */
+    DeferredConsumer &onBatch(const BatchCallback &callback)
+    {
+        // store callback
+        _batchCallback = callback;
+
+        // messages are collected as long as the callback is installed
+        if (!callback) _batch.reset();
+        else if (!_batch) _batch.reset(new MessageBatch());
+
+        // allow chaining
+        return *this;
+    }
 };
 
 /**
@@ -44,6 +44,12 @@ protected:
      */
     bool _redelivered = false;
 
+    /**
+     *  Are the messages delivered without the need to ack them?
+     *  @var    bool
+     */
+    bool _noack;
+
     /**
      *  Callback for incoming messages
      *  @var    MessageCallback
@@ -62,7 +68,7 @@ protected:
      *  @param  exchange            the exchange to which the message was published
      *  @param  routingkey          the routing key that was used to publish the message
      */
-    virtual void initialize(const std::string &exchange, const std::string &routingkey) override;
+    virtual void initialize(const StringView &exchange, const StringView &routingkey) override;
 
     /**
      *  Indicate that a message was done
@@ -73,9 +79,10 @@ protected:
      *  Constructor
      *  @param  failed  Have we already failed?
      *  @param  channel The channel we are consuming on
+     *  @param  noack   Are messages delivered without the need to ack them?
      */
-    DeferredExtReceiver(bool failed, ChannelImpl *channel) : 
-        DeferredReceiver(failed, channel) {}
+    DeferredExtReceiver(bool failed, ChannelImpl *channel, bool noack = false) : 
+        DeferredReceiver(failed, channel), _noack(noack) {}
     
 public:
     /**
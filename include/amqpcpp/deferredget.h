@@ -85,9 +85,10 @@ public:
      *
      *  @param  channel     the channel implementation
      *  @param  failed      are we already failed?
+     *  @param  noack       are messages delivered without the need to ack them?
      */
-    DeferredGet(ChannelImpl *channel, bool failed = false) :
-        DeferredExtReceiver(failed, channel) {}
+    DeferredGet(ChannelImpl *channel, bool failed = false, bool noack = false) :
+        DeferredExtReceiver(failed, channel, noack) {}
 
 public:
     /**
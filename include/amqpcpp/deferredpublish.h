@@ -0,0 +1,169 @@
+/**
+ *  DeferredPublish.h
+ *
+ *  Class that is returned when a message is published with the ConfirmedPublisher,
+ *  and that can be used to install callbacks that are called when the server
+ *  confirms this specific message.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class DeferredPublish : public Deferred
+{
+private:
+    /**
+     *  Callback to execute when the server acks the message
+     *  @var PublishAckCallback
+     */
+    PublishAckCallback _ackCallback;
+
+    /**
+     *  Callback to execute when the server nacks the message
+     *  @var PublishNackCallback
+     */
+    PublishNackCallback _nackCallback;
+
+    /**
+     *  Callback to execute when the channel failed before the message was confirmed
+     *  @var PublishLostCallback
+     */
+    PublishLostCallback _lostCallback;
+
+    /**
+     *  Report that the server acked the message
+     */
+    void reportAck()
+    {
+        // execute callback if registered
+        if (_ackCallback) _ackCallback();
+    }
+
+    /**
+     *  Report that the server nacked the message
+     */
+    void reportNack()
+    {
+        // execute callback if registered
+        if (_nackCallback) _nackCallback();
+
+        // this is also an error
+        reportError("Message was nacked by the server");
+    }
+
+    /**
+     *  Report that the message was lost because the channel failed
+     *  @param  message     the reason why the channel failed
+     */
+    void reportLost(const char *message)
+    {
+        // execute callback if registered
+        if (_lostCallback) _lostCallback();
+
+        // this is also an error
+        reportError(message);
+    }
+
+    /**
+     *  The publisher may call our private members
+     */
+    friend class ConfirmedPublisher;
+
+public:
+    /**
+     *  Protected constructor that can only be called
+     *  from within the confirmed publisher
+     *
+     *  Note: this constructor _should_ be protected, but because make_shared
+     *  will then not work, we have decided to make it public after all,
+     *  because the work-around would result in not-so-easy-to-read code.
+     *
+     *  @param  failed      are we already failed?
+     */
+    DeferredPublish(bool failed = false) : Deferred(failed) {}
+
+    /**
+     *  Callback that is called when the server acks the message
+     *  @param  callback    the callback to execute
+     */
+    DeferredPublish &onAck(const PublishAckCallback &callback)
+    {
+        // store callback
+        _ackCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
+
+    /**
+     *  Callback that is called when the server nacks the message
+     *  @param  callback    the callback to execute
+     */
+    DeferredPublish &onNack(const PublishNackCallback &callback)
+    {
+        // store callback
+        _nackCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
+
+    /**
+     *  Callback that is called when the channel failed before the server
+     *  confirmed the message, it is unknown whether the server received it
+     *  @param  callback    the callback to execute
+     */
+    DeferredPublish &onLost(const PublishLostCallback &callback)
+    {
+        // store callback
+        _lostCallback = callback;
+
+        // allow chaining
+        return *this;
+    }
+
+    /**
+     *  Register the function that is called when the message is nacked or lost,
+     *  or when the message could not be published at all
+     *  @param  callback    the callback to execute
+     */
+    DeferredPublish &onError(const ErrorCallback &callback)
+    {
+        // call base
+        Deferred::onError(callback);
+
+        // allow chaining
+        return *this;
+    }
+
+    /**
+     *  Register the function that is called when the message is confirmed, or
+     *  when it failed
+     *  @param  callback    the callback to execute
+     */
+    DeferredPublish &onFinalize(const FinalizeCallback &callback)
+    {
+        // call base
+        Deferred::onFinalize(callback);
+
+        // allow chaining
+        return *this;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
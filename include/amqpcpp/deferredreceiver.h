@@ -18,6 +18,9 @@
 #include "deferred.h"
 #include "stack_ptr.h"
 #include "message.h"
+#include "stringview.h"
+#include "messagebatch.h"
+#include "sink.h"
 
 /**
  *  Start namespace
@@ -51,7 +54,7 @@ protected:
      *  @param  exchange            the exchange to which the message was published
      *  @param  routingkey          the routing key that was used to publish the message
      */
-    virtual void initialize(const std::string &exchange, const std::string &routingkey);
+    virtual void initialize(const StringView &exchange, const StringView &routingkey);
     
     /**
      *  Get reference to self to prevent that object falls out of scope
@@ -79,6 +82,17 @@ private:
      */
     void process(BodyFrame &frame);
 
+    /**
+     *  Memory where the payload of the next body frame is going to be stored
+     *  @param  size    size of the payload
+     *  @return char*   pointer to the memory, or nullptr if not available
+     */
+    char *destination(uint32_t size)
+    {
+        // only possible if we are building a message
+        return _message ? _message->destination(size) : nullptr;
+    }
+
     /**
      *  Frames may be processed
      */
@@ -86,6 +100,7 @@ private:
     friend class BasicGetOKFrame;
     friend class BasicHeaderFrame;
     friend class BodyFrame;
+    friend class ConnectionImpl;
 
 protected:
     /**
@@ -100,6 +115,12 @@ protected:
      */
     StartCallback _startCallback;
 
+    /**
+     *  Callback for new message, that gets views on the received data
+     *  @var    StartViewCallback
+     */
+    StartViewCallback _startViewCallback;
+
     /**
      *  Callback that is called when size of the message is known
      *  @var    SizeCallback
@@ -118,12 +139,24 @@ protected:
      */
     DataCallback _dataCallback;
 
+    /**
+     *  Sink that receives the message body while it comes in
+     *  @var    Sink
+     */
+    Sink *_sink = nullptr;
+
     /**
      *  The message that we are currently receiving
      *  @var    stack_ptr<Message>
      */
     stack_ptr<Message> _message;
 
+    /**
+     *  The messages that are collected when messages are reported in batches
+     *  @var    std::unique_ptr<MessageBatch>
+     */
+    std::unique_ptr<MessageBatch> _batch;
+
     /**
      *  Constructor
      *  @param  failed  Have we already failed?
@@ -26,6 +26,7 @@ class ReceivedFrame;
 class OutBuffer;
 class Array;
 class Table;
+class FieldArena;
 
 /**
  *  Base field class
@@ -38,11 +39,12 @@ class Field
 protected:
     /**
      *  Decode a field by fetching a type and full field from a frame
-     *  The returned field is allocated on the heap!
+     *  The returned field is constructed in the arena, and is destructed with it
      *  @param  frame
+     *  @param  arena
      *  @return Field*
      */
-    static Field *decode(ReceivedFrame &frame);
+    static Field *decode(ReceivedFrame &frame, FieldArena &arena);
 
 public:
     /**
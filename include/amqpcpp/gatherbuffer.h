@@ -0,0 +1,303 @@
+/**
+ *  GatherBuffer.h
+ *
+ *  Output buffer that is used to pass a group of frames to the handler in
+ *  one call. The frame headers and trailers (and other small data) are
+ *  copied into the buffer, but bytes that fall inside a user supplied
+ *  region (typically the body of a message that is being published) are
+ *  only referenced. The result is a list of segments that can be written
+ *  to a socket with a single writev() or sendmsg() call.
+ *
+ *  Because a buffer like this is constructed for every message that is
+ *  published, the first bytes and segments are stored inside the object
+ *  itself, so that publishing a normal message does not allocate memory.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "outbuffer.h"
+#include "frame.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class GatherBuffer : public OutBuffer
+{
+private:
+    /**
+     *  Description of a single segment
+     */
+    struct Segment
+    {
+        /**
+         *  Pointer to referenced data, or nullptr if the data is stored in _bytes
+         *  @var const char *
+         */
+        const char *reference;
+
+        /**
+         *  Offset in the _bytes member (only relevant for stored data)
+         *  @var size_t
+         */
+        size_t offset;
+
+        /**
+         *  Number of bytes in the segment
+         *  @var size_t
+         */
+        size_t size;
+    };
+
+    /**
+     *  Blocks smaller than this are copied, even if they could have been referenced,
+     *  because a separate segment costs more than a small memcpy()
+     *  @var size_t
+     */
+    static constexpr size_t minimum = 512;
+
+    /**
+     *  Begin and end of the region that may be referenced instead of copied
+     *  @var const char *
+     */
+    const char *_begin;
+    const char *_end;
+
+    /**
+     *  Storage for copied bytes and segments inside the object
+     *  @var char[]
+     *  @var Segment[]
+     */
+    char _localBytes[512];
+    Segment _localSegments[16];
+
+    /**
+     *  Storage for copied bytes and segments that do not fit in the object
+     *  @var std::vector<char>
+     *  @var std::vector<Segment>
+     */
+    std::vector<char> _heapBytes;
+    std::vector<Segment> _heapSegments;
+
+    /**
+     *  All bytes that were copied into the buffer, with the number of bytes
+     *  stored and the number of bytes that fit
+     *  @var char *
+     *  @var size_t
+     */
+    char *_bytes = _localBytes;
+    size_t _used = 0;
+    size_t _room = sizeof(_localBytes);
+
+    /**
+     *  All segments, and the number of segments
+     *  @var Segment *
+     *  @var size_t
+     */
+    Segment *_segments = _localSegments;
+    size_t _count = 0;
+
+    /**
+     *  Total number of bytes in all segments
+     *  @var size_t
+     */
+    size_t _size = 0;
+
+    /**
+     *  Copy data into the buffer with bytes
+     *  @param  data
+     *  @param  size
+     */
+    void store(const char *data, size_t size)
+    {
+        // does the data not fit?
+        if (_used + size > _room)
+        {
+            // new size of the storage
+            _room = std::max(_room * 2, _used + size);
+
+            // resize the storage (when we were using local storage, the data has to be copied)
+            _heapBytes.resize(_room);
+            if (_bytes == _localBytes) memcpy(_heapBytes.data(), _localBytes, _used);
+            _bytes = _heapBytes.data();
+        }
+
+        // copy the data
+        memcpy(_bytes + _used, data, size);
+
+        // update the number of bytes in use
+        _used += size;
+    }
+
+    /**
+     *  Add a segment
+     *  @param  segment
+     */
+    void push(const Segment &segment)
+    {
+        // if the local storage is full we switch to the heap
+        if (_count == 16 && _segments == _localSegments) _heapSegments.assign(_localSegments, _localSegments + 16);
+
+        // when we are using the heap, we just add it to the vector
+        if (!_heapSegments.empty()) _heapSegments.push_back(segment);
+        
+        // otherwise it is stored locally
+        else _localSegments[_count] = segment;
+
+        // the vector could have been reallocated
+        if (!_heapSegments.empty()) _segments = _heapSegments.data();
+
+        // update the counter
+        _count += 1;
+    }
+
+protected:
+    /**
+     *  The method that adds the actual data
+     *  @param  data
+     *  @param  size
+     */
+    virtual void append(const void *data, size_t size) override
+    {
+        // nothing to do for empty data
+        if (size == 0) return;
+
+        // the data as a char pointer
+        auto *bytes = (const char *)data;
+
+        // update the total size
+        _size += size;
+
+        // can the data be referenced instead of copied?
+        if (size >= minimum && bytes >= _begin && bytes + size <= _end)
+        {
+            // add a segment that points to the original data
+            push(Segment{ bytes, 0, size });
+        }
+        else
+        {
+            // can the previous segment be extended?
+            if (_count > 0 && _segments[_count - 1].reference == nullptr) _segments[_count - 1].size += size;
+
+            // otherwise we need a new segment
+            else push(Segment{ nullptr, _used, size });
+
+            // copy the data
+            store(bytes, size);
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  The region that is passed to the constructor must remain valid
+     *  for as long as the buffer object exists.
+     *
+     *  @param  data        begin of the region that may be referenced
+     *  @param  size        size of the region
+     *  @param  frames      expected number of frames (used to preallocate memory)
+     */
+    GatherBuffer(const char *data, size_t size, size_t frames = 3) : _begin(data), _end(data + size)
+    {
+        // each frame normally results in at most two segments, and the copied data is
+        // limited to the headers and trailers (and the method and header frame), this
+        // normally fits in the local storage, but for big messages we reserve memory
+        if (frames * 2 > 16) _heapSegments.reserve(frames * 2);
+        if (256 + frames * 8 > sizeof(_localBytes)) _heapBytes.reserve(256 + frames * 8);
+    }
+
+    /**
+     *  No copying, because that would be too expensive
+     *  @param  that
+     */
+    GatherBuffer(const GatherBuffer &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~GatherBuffer() {}
+
+    /**
+     *  Add a full frame to the buffer (including the end-of-frame separator)
+     *  @param  frame
+     */
+    void add(const Frame &frame)
+    {
+        // tell the frame to fill this buffer
+        frame.fill(*this);
+
+        // append an end of frame byte (but not when still negotiating the protocol)
+        if (frame.needsSeparator()) OutBuffer::add((uint8_t)206);
+    }
+
+    /**
+     *  Expose the other add() methods from the base class
+     */
+    using OutBuffer::add;
+
+    /**
+     *  Number of segments in the buffer
+     *  @return size_t
+     */
+    size_t count() const
+    {
+        // expose member
+        return _count;
+    }
+
+    /**
+     *  Get access to the data of a segment
+     *  @param  index       index of the segment
+     *  @return const char *
+     */
+    const char *data(size_t index) const
+    {
+        // the segment
+        const auto &segment = _segments[index];
+
+        // either referenced or stored
+        return segment.reference ? segment.reference : _bytes + segment.offset;
+    }
+
+    /**
+     *  Size of a segment
+     *  @param  index       index of the segment
+     *  @return size_t
+     */
+    size_t size(size_t index) const
+    {
+        // expose the segment size
+        return _segments[index].size;
+    }
+
+    /**
+     *  Total number of bytes in all segments
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        // expose member
+        return _size;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
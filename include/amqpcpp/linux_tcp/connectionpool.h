@@ -0,0 +1,117 @@
+/**
+ *  ConnectionPool.h
+ *
+ *  Pool of TCP connections, each one running in its own thread with its own
+ *  event loop. The publish() methods of the pool can be called from any
+ *  thread: the message is passed to the thread that owns the connection
+ *  through a lock-free queue, and that thread is woken up with an eventfd.
+ *
+ *  Every connection has one or more channels. Messages with the same routing
+ *  key are always published over the same channel, so their order is kept.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <vector>
+#include <memory>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Forward declarations
+ */
+class PoolWorker;
+
+/**
+ *  Class definition
+ */
+class ConnectionPool
+{
+private:
+    /**
+     *  The workers, each one with its own thread and connection
+     *  @var std::vector
+     */
+    std::vector<std::unique_ptr<PoolWorker>> _workers;
+
+    /**
+     *  Number of channels per connection
+     *  @var size_t
+     */
+    size_t _channels;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  The connections are set up in the background, messages that are published
+     *  before a connection is ready are sent as soon as it is.
+     *
+     *  @param  address     the address to connect to
+     *  @param  threads     number of threads and connections (0 for one per core)
+     *  @param  channels    number of channels per connection
+     */
+    ConnectionPool(const Address &address, size_t threads = 0, size_t channels = 1);
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    ConnectionPool(const ConnectionPool &that) = delete;
+
+    /**
+     *  Destructor
+     *
+     *  The messages that were already passed to the pool are published, and the
+     *  connections are closed. The destructor waits until this is done.
+     */
+    virtual ~ConnectionPool();
+
+    /**
+     *  Number of connections in the pool
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        // expose the number of workers
+        return _workers.size();
+    }
+
+    /**
+     *  Publish a message to an exchange (can be called from any thread)
+     *
+     *  The message is copied, and passed to the thread that owns the connection
+     *  that publishes it. The method returns false if that connection has failed,
+     *  and a new connection is not yet being set up. A failed connection is set up
+     *  again after a delay that starts at 100 milliseconds, and that doubles with
+     *  every failed attempt (up to 30 seconds).
+     *
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingkey  the routing key
+     *  @param  envelope    the full envelope to send
+     *  @param  message     the message to send
+     *  @param  size        size of the message
+     *  @param  flags       optional flags
+     *  @return bool
+     */
+    bool publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags = 0);
+    bool publish(const std::string &exchange, const std::string &routingKey, const std::string &message, int flags = 0) { return publish(exchange, routingKey, Envelope(message.data(), message.size()), flags); }
+    bool publish(const std::string &exchange, const std::string &routingKey, const char *message, size_t size, int flags = 0) { return publish(exchange, routingKey, Envelope(message, size), flags); }
+    bool publish(const std::string &exchange, const std::string &routingKey, const char *message, int flags = 0) { return publish(exchange, routingKey, Envelope(message, strlen(message)), flags); }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -23,6 +23,7 @@ namespace AMQP {
  */
 class TcpState;
 class TcpChannel;
+class TcpSubmissions;
 
 /**
  *  Class definition
@@ -52,6 +53,30 @@ private:
      */
     Connection _connection;
 
+    /**
+     *  Max number of bytes that are held back when output is corked (0 when not corked)
+     *  @var    size_t
+     */
+    size_t _threshold = 0;
+
+    /**
+     *  Max number of microseconds that data is held back when output is corked
+     *  @var    uint32_t
+     */
+    uint32_t _latency = 0;
+
+    /**
+     *  Are we running the operations that were submitted by other threads?
+     *  @var    bool
+     */
+    bool _draining = false;
+
+    /**
+     *  Operations that were submitted by other threads
+     *  @var    std::unique_ptr<TcpSubmissions>
+     */
+    std::unique_ptr<TcpSubmissions> _submissions;
+
     /**
      *  The channel may access out _connection
      *  @friend
@@ -84,6 +109,13 @@ private:
      */
     virtual void onData(Connection *connection, const char *buffer, size_t size) override;
 
+    /**
+     *  Method that is called by the connection when a group of frames needs to be sent
+     *  @param  connection      The connection that created this output
+     *  @param  buffer          Segments with data to send
+     */
+    virtual void onData(Connection *connection, const GatherBuffer &buffer) override;
+
     /**
      *  Method that is called when the server sends a heartbeat to the client
      *  @param  connection      The connection over which the heartbeat was received
@@ -94,6 +126,13 @@ private:
         _handler->onHeartbeat(this);
     }
 
+    /**
+     *  Method that is called when the connection holds back frames outside a call to parse()
+     *  @param  connection      The connection that holds back frames
+     *  @return bool            Will we call Connection::flush()?
+     */
+    virtual bool onPending(Connection *connection) override;
+
     /**
      *  Method called when the connection ends up in an error state
      *  @param  connection      The connection that entered the error state
@@ -139,6 +178,17 @@ private:
         return _handler->onSecured(this, ssl);
     }
 
+    /**
+     *  The SSL context to use for a secure connection
+     *  @param  state
+     *  @return SSL_CTX*
+     */
+    virtual SSL_CTX *context(TcpState *state) override
+    {
+        // pass on to user-space
+        return _handler->context(this);
+    }
+
     /**
      *  Method to be called when data was received
      *  @param  state
@@ -187,6 +237,48 @@ private:
         return _connection.expected();
     }
 
+    /**
+     *  Memory where the payload of a body frame should be stored
+     *  @param  channel     channel number from the frame header
+     *  @param  size        payload size from the frame header
+     *  @return char*
+     */
+    virtual char *destination(uint16_t channel, uint32_t size) override
+    {
+        // pass on to the connection
+        return _connection.destination(channel, size);
+    }
+
+    /**
+     *  The max number of bytes that may be held back when output is corked
+     *  @return size_t
+     */
+    virtual size_t corked() override
+    {
+        // while submitted operations run, output is corked even if the user did not ask for it
+        return _threshold == 0 && _draining ? 65536 : _threshold;
+    }
+
+    /**
+     *  The max number of microseconds that data may be held back
+     *  @return uint32_t
+     */
+    virtual uint32_t latency() override
+    {
+        // expose member
+        return _latency;
+    }
+
+    /**
+     *  Run all operations that were submitted by other threads
+     */
+    void drain();
+
+    /**
+     *  Stop monitoring the submission queue (if it was monitored at all)
+     */
+    void unwatch();
+
 public:
     /**
      *  Constructor
@@ -280,6 +372,27 @@ public:
         return _connection.expected();
     }
 
+    /**
+     *  The allocator that is used for buffers and message bodies
+     *  @return Allocator*
+     */
+    virtual Allocator *allocator() const override
+    {
+        return _connection.allocator();
+    }
+
+    /**
+     *  Install a different allocator for buffers and message bodies. This should
+     *  be done right after the connection was constructed. The allocator must stay
+     *  valid for as long as the connection exists, pass nullptr to go back to
+     *  malloc() and free().
+     *  @param  allocator
+     */
+    void allocator(Allocator *allocator)
+    {
+        _connection.allocator(allocator);
+    }
+
     /**
       *  Return the number of channels this connection has.
       *  @return std::size_t
@@ -295,7 +408,116 @@ public:
      *  @return std::size_t
      */
     std::size_t queued() const;
+
+    /**
+     *  The high watermark: the max number of outgoing bytes that were queued
+     *  at the same time since the connection was created
+     *  @return std::size_t
+     */
+    std::size_t highWatermark() const;
+
+    /**
+     *  The low watermark: the lowest number of outgoing bytes that were queued
+     *  since the high watermark was reached. A low watermark that stays well
+     *  above zero means that the socket never fully drained after the peak.
+     *  @return std::size_t
+     */
+    std::size_t lowWatermark() const;
     
+    /**
+     *  Cork the output of the connection
+     *
+     *  Normally, every frame is written to the socket the moment it is created,
+     *  which means that publishing a small message costs three system calls. When
+     *  output is corked, frames are held back in a buffer, and they are all written
+     *  with a single system call when the socket becomes writable (normally in the
+     *  next iteration of the event loop), when the buffer grows beyond the threshold,
+     *  when data was held back longer than the latency bound, or when you call flush().
+     *
+     *  @param  threshold       max number of bytes to hold back (0 to disable corking)
+     *  @param  latency         max number of microseconds to hold data back (0 for no bound)
+     */
+    void cork(size_t threshold = 65536, uint32_t latency = 0)
+    {
+        // store the settings
+        _threshold = threshold;
+        _latency = latency;
+    }
+
+    /**
+     *  Stop corking the output, and flush all data that was held back
+     */
+    void uncork()
+    {
+        // disable corking
+        _threshold = _latency = 0;
+
+        // send out data that is still held back
+        flush();
+    }
+
+    /**
+     *  Write all data that is held back to the socket: the acks that channels
+     *  coalesce, and the data that is held back because output is corked
+     */
+    void flush();
+
+    /**
+     *  Pause reading from the socket
+     *
+     *  When the connection is paused (by this method, or because a Sink that
+     *  was installed with DeferredConsumer::onSink() returned false), it stops
+     *  processing incoming data right after the frame that it is processing,
+     *  and it stops monitoring the socket for readability. The data that was
+     *  already received stays in the input buffer, so the memory use is
+     *  bounded by the max frame size. Note that a paused connection does not
+     *  notice that the peer closed the socket, and that heartbeats from the
+     *  server are not processed either.
+     */
+    void pause()
+    {
+        _connection.pause();
+    }
+
+    /**
+     *  Resume reading from the socket. The data that was already received is
+     *  processed in the next iteration of the event loop.
+     */
+    void resume();
+
+    /**
+     *  Is reading from the socket paused?
+     *  @return bool
+     */
+    virtual bool paused() const override
+    {
+        return _connection.paused();
+    }
+
+    /**
+     *  Submit an operation from a different thread
+     *
+     *  A TcpConnection, and the channels that use it, may only be accessed from
+     *  the thread that runs the event loop. Other threads can use this method
+     *  to pass an operation (for example a call to TcpChannel::publish()) to
+     *  the event loop thread. This method is the only one that may be called
+     *  from any thread: the operation is added to a lock-free queue, and the
+     *  event loop is woken up via a filedescriptor.
+     *
+     *  That filedescriptor is registered through TcpHandler::monitor() by the
+     *  constructor, so this method never calls the handler itself. The
+     *  filedescriptor is unregistered when the connection is lost, operations
+     *  that are submitted after that are never run.
+     *
+     *  The event loop thread runs all operations that were submitted in one
+     *  go, and writes the frames that they created with a single system call.
+     *  Operations that are still queued when the connection is destructed
+     *  are discarded without being run.
+     *
+     *  @param  task            the operation to run in the event loop thread
+     */
+    void post(std::function<void()> task);
+
     /**
      *  Send a heartbeat
      *  @return bool
@@ -304,6 +526,13 @@ public:
     {
         return _connection.heartbeat();
     }
+
+    /**
+     *  Statistics of the TLS handshakes of all secure connections in the process
+     *  (how long they took, and how many of them resumed an earlier session)
+     *  @return TlsMetrics
+     */
+    static TlsMetrics tlsMetrics();
 };
 
 /**
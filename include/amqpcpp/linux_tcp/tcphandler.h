@@ -85,6 +85,29 @@ public:
         return true;
     }
 
+    /**
+     *  Method that is called right before the TLS handshake of a secure connection
+     *  starts, to get the openssl context for the connection. By default, all
+     *  connections share one context that is created by AMQP-CPP. If you want to
+     *  set up certificates or verification rules, you can override this method and
+     *  return your own context (preferably the same one for all connections). The
+     *  context must stay alive for as long as it is used. AMQP-CPP enables the
+     *  client-side session cache of the context and installs the callback for new
+     *  sessions, so that connections to the same host can resume their sessions
+     *  instead of doing a full handshake. The cached sessions are stored with the
+     *  context, and are released when the context is freed.
+     *  @param  connection      The connection that is about to start the handshake
+     *  @return SSL_CTX*        The context to use, or nullptr to use the default one
+     */
+    virtual SSL_CTX *context(TcpConnection *connection)
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) connection;
+
+        // use the default context
+        return nullptr;
+    }
+
     /**
      *  Method that is called when the RabbitMQ server and your client application  
      *  exchange some properties that describe their identity.
@@ -28,6 +28,7 @@ namespace AMQP {
  */
 class TcpState;
 class Buffer;
+class Allocator;
 
 /**
  *  Class definition
@@ -55,6 +56,13 @@ public:
      */
     virtual bool onSecured(TcpState *state, const SSL *ssl) = 0;
 
+    /**
+     *  The SSL context to use for a secure connection
+     *  @param  state
+     *  @return SSL_CTX*    the context, or nullptr to use the default context
+     */
+    virtual SSL_CTX *context(TcpState *state) = 0;
+
     /**
      *  Method to be called when data was received
      *  @param  state
@@ -90,6 +98,41 @@ public:
      *  @return size_t
      */
     virtual size_t expected() = 0;
+
+    /**
+     *  Memory where the payload of a body frame should be stored
+     *  @param  channel     channel number from the frame header
+     *  @param  size        payload size from the frame header
+     *  @return char*       pointer to the memory, or nullptr if not available
+     */
+    virtual char *destination(uint16_t channel, uint32_t size) = 0;
+
+    /**
+     *  The allocator to use for the input buffer
+     *  @return Allocator*
+     */
+    virtual Allocator *allocator() const = 0;
+
+    /**
+     *  The max number of bytes that may be held back in the outgoing buffer
+     *  when output is corked (0 when output is not corked)
+     *  @return size_t
+     */
+    virtual size_t corked() = 0;
+
+    /**
+     *  The max number of microseconds that data may be held back when output
+     *  is corked (0 if data is held back until the socket becomes writable)
+     *  @return uint32_t
+     */
+    virtual uint32_t latency() = 0;
+
+    /**
+     *  Is the processing of incoming data paused? (the socket should then
+     *  not be monitored for readability)
+     *  @return bool
+     */
+    virtual bool paused() const = 0;
 };
 
 /**
@@ -0,0 +1,74 @@
+/**
+ *  TlsMetrics.h
+ *
+ *  Statistics of the TLS handshakes of all secure TcpConnections in the
+ *  process. A handshake that resumes an earlier session takes one roundtrip
+ *  less and skips the certificate exchange, so the number of resumed
+ *  handshakes shows how well reconnects are absorbed.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <stddef.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+struct TlsMetrics
+{
+    /**
+     *  Number of handshakes that set up a new session, and that resumed an earlier session
+     *  @var size_t
+     */
+    size_t full = 0;
+    size_t resumed = 0;
+
+    /**
+     *  Number of handshakes that failed
+     *  @var size_t
+     */
+    size_t failed = 0;
+
+    /**
+     *  Number of connections for which the kernel took over the encryption (kTLS)
+     *  in at least one direction (the data of these connections still goes through
+     *  openssl, AMQP-CPP does not use the socket directly)
+     *  @var size_t
+     */
+    size_t kernel = 0;
+
+    /**
+     *  Average duration of the full and of the resumed handshakes, in microseconds
+     *  (from the moment that the tcp connection was set up until the handshake was done)
+     *  @var double
+     */
+    double fullTime = 0.0;
+    double resumedTime = 0.0;
+
+    /**
+     *  The part of the successful handshakes that resumed a session
+     *  @return double
+     */
+    double hitrate() const
+    {
+        return full + resumed == 0 ? 0.0 : (double)resumed / (full + resumed);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
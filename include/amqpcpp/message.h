@@ -19,6 +19,7 @@
  *  Dependencies
  */
 #include "envelope.h"
+#include "allocator.h"
 #include <limits>
 #include <stdexcept>
 #include <algorithm>
@@ -45,6 +46,12 @@ private:
      */
     char *_mutableBody = nullptr;
 
+    /**
+     *  The allocator for the mutable body
+     *  @var    Allocator
+     */
+    Allocator *_allocator;
+
 protected:
     /**
      *  The exchange to which it was originally published
@@ -100,8 +107,8 @@ protected:
             // prevent overflow
             size = std::min(size, _bodySize - _filled);
             
-            // append more data
-            memcpy(_mutableBody + _filled, buffer, (size_t)size);
+            // append more data (unless it was already received straight into the body)
+            if (buffer != _mutableBody + _filled) memcpy(_mutableBody + _filled, buffer, (size_t)size);
             
             // update filled data
             _filled += (size_t)size;
@@ -115,7 +122,7 @@ protected:
         else
         {
             // allocate the buffer
-            _mutableBody = (char *)malloc((size_t)_bodySize);
+            _mutableBody = (char *)_allocator->allocate((size_t)_bodySize);
             
             // expose the body in its immutable form
             _body = _mutableBody;
@@ -129,15 +136,41 @@ protected:
         return _filled >= _bodySize;
     }
 
+    /**
+     *  Memory where the next part of the body is going to be stored
+     *
+     *  This is only available for bodies that are spread over multiple frames
+     *  (a body that fits in a single frame is not copied at all), and only if 
+     *  the part fits in the remaining space.
+     *
+     *  @param  size        size of the next part
+     *  @return char*       pointer to the memory, or nullptr if not available
+     */
+    char *destination(uint64_t size)
+    {
+        // a body that fits in one frame is never copied
+        if (!_mutableBody && size >= _bodySize) return nullptr;
+
+        // the data should fit
+        if (_filled + size > _bodySize) return nullptr;
+
+        // allocate the buffer if this is the first part
+        if (!_mutableBody) _body = _mutableBody = (char *)_allocator->allocate((size_t)_bodySize);
+
+        // this is where the data will end up
+        return _mutableBody + _filled;
+    }
+
 public:
     /**
      *  Constructor
      *
      *  @param  exchange
      *  @param  routingKey
+     *  @param  allocator   allocator for bodies that are spread over multiple frames
      */
-    Message(std::string exchange, std::string routingkey) :
-        Envelope(nullptr, 0), _exchange(std::move(exchange)), _routingkey(std::move(routingkey))
+    Message(std::string exchange, std::string routingkey, Allocator *allocator = Allocator::standard()) :
+        Envelope(nullptr, 0), _allocator(allocator), _exchange(std::move(exchange)), _routingkey(std::move(routingkey))
     {}
 
     /**
@@ -151,7 +184,7 @@ public:
      */
     virtual ~Message()
     {
-        if (_mutableBody) free(_mutableBody);
+        if (_mutableBody) _allocator->deallocate(_mutableBody, (size_t)_bodySize);
     }
 
     /**
@@ -0,0 +1,123 @@
+/**
+ *  MessageBatch.h
+ *
+ *  Messages that a consumer collects while the connection parses incoming
+ *  data. All data of the messages is copied into a single block of memory
+ *  that is reused for every batch, so that no memory has to be allocated
+ *  once the batches have reached their normal size.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <vector>
+#include <string>
+#include "messageview.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class MessageBatch
+{
+private:
+    /**
+     *  The messages in the batch (the last one may be incomplete)
+     *  @var    std::vector<MessageView>
+     */
+    std::vector<MessageView> _messages;
+
+    /**
+     *  Number of messages that are complete
+     *  @var    size_t
+     */
+    size_t _complete = 0;
+
+    /**
+     *  The data of all messages
+     *  @var    std::string
+     */
+    std::string _data;
+
+public:
+    /**
+     *  Constructor
+     */
+    MessageBatch() = default;
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    MessageBatch(const MessageBatch &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~MessageBatch() {}
+
+    /**
+     *  Start a new message
+     *  @param  deliveryTag     the delivery tag
+     *  @param  redelivered     is this a redelivered message?
+     *  @param  exchange        the exchange to which it was published
+     *  @param  routingkey      the routing key that was used
+     */
+    void begin(uint64_t deliveryTag, bool redelivered, const StringView &exchange, const StringView &routingkey);
+
+    /**
+     *  Store the properties of the message that is being received
+     *  @param  metadata        the properties
+     */
+    void properties(const MetaData &metadata);
+
+    /**
+     *  Append body data to the message that is being received
+     *  @param  data
+     *  @param  size
+     */
+    void append(const char *data, size_t size);
+
+    /**
+     *  Mark the message that is being received as complete
+     *  @return bool            is this the first complete message of the batch?
+     */
+    bool complete();
+
+    /**
+     *  Number of complete messages
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _complete;
+    }
+
+    /**
+     *  The complete messages
+     *  @return const MessageView *
+     */
+    const MessageView *messages();
+
+    /**
+     *  Remove the complete messages from the batch (a message that is still
+     *  being received stays in the batch)
+     */
+    void clear();
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,144 @@
+/**
+ *  MessageView.h
+ *
+ *  Lightweight view on a message that was received by a consumer that
+ *  collects messages in batches (see DeferredConsumer::onBatch()). The data
+ *  of the message is owned by the consumer, and is only valid for as long
+ *  as the batch callback runs.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include "stringview.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Forward declarations
+ */
+class MessageBatch;
+class MetaData;
+
+/**
+ *  Class definition
+ */
+class MessageView
+{
+private:
+    /**
+     *  The memory that holds the data of the message, the other members are offsets
+     *  in this memory (it is set right before the batch is reported)
+     *  @var    const char *
+     */
+    const char *_base = nullptr;
+
+    /**
+     *  The delivery tag
+     *  @var    uint64_t
+     */
+    uint64_t _deliveryTag;
+
+    /**
+     *  Is this a redelivered message?
+     *  @var    bool
+     */
+    bool _redelivered;
+
+    /**
+     *  Offsets and sizes of the exchange, the routing key, the encoded properties and the body
+     *  @var    size_t
+     */
+    size_t _exchange;
+    size_t _exchangeSize;
+    size_t _routingkey;
+    size_t _routingkeySize;
+    size_t _properties = 0;
+    size_t _propertiesSize = 0;
+    size_t _body = 0;
+    size_t _bodySize = 0;
+
+    /**
+     *  The batch fills in the members
+     */
+    friend class MessageBatch;
+
+public:
+    /**
+     *  The delivery tag, you need this to acknowledge the message
+     *  @return uint64_t
+     */
+    uint64_t deliveryTag() const
+    {
+        return _deliveryTag;
+    }
+
+    /**
+     *  Is this a redelivered message?
+     *  @return bool
+     */
+    bool redelivered() const
+    {
+        return _redelivered;
+    }
+
+    /**
+     *  The exchange to which it was originally published
+     *  @return StringView
+     */
+    StringView exchange() const
+    {
+        return StringView(_base + _exchange, _exchangeSize);
+    }
+
+    /**
+     *  The routing key that was originally used
+     *  @return StringView
+     */
+    StringView routingkey() const
+    {
+        return StringView(_base + _routingkey, _routingkeySize);
+    }
+
+    /**
+     *  The message body
+     *  @return const char *
+     */
+    const char *body() const
+    {
+        return _base + _body;
+    }
+
+    /**
+     *  Size of the message body
+     *  @return uint64_t
+     */
+    uint64_t bodySize() const
+    {
+        return _bodySize;
+    }
+
+    /**
+     *  Decode the properties of the message (content-type, headers, etcetera). The
+     *  properties are decoded lazily, so this is cheap if you only need a few of them.
+     *  Unlike the view itself, the returned object owns its data, so it may be kept
+     *  after the batch callback has returned.
+     *  @return MetaData
+     */
+    MetaData metaData() const;
+};
+
+/**
+ *  End of namespace
+ */
+}
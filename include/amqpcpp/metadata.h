@@ -4,6 +4,11 @@
  *  With every published message a set of meta data is passed to. This class
  *  holds all that meta data.
  *
+ *  The meta data of incoming messages is decoded lazily: the object holds the
+ *  raw bytes of the properties, and a property is only decoded when it is
+ *  accessed for the first time. Because of this, the getters of a received
+ *  object are not safe to be called from multiple threads at the same time.
+ *
  *  @copyright 2014 - 2017 Copernica BV
  */
 
@@ -46,85 +51,85 @@ protected:
      *  MIME content type
      *  @var    ShortString
      */
-    ShortString _contentType;
+    mutable ShortString _contentType;
 
     /**
      *  MIME content encoding
      *  @var    ShortString
      */
-    ShortString _contentEncoding;
+    mutable ShortString _contentEncoding;
 
     /**
      *  message header field table
      *  @var    Table
      */
-    Table _headers;
+    mutable Table _headers;
 
     /**
      *  Delivery mode (non-persistent (1) or persistent (2))
      *  @var    UOctet
      */
-    UOctet _deliveryMode = 0;
+    mutable UOctet _deliveryMode = 0;
 
     /**
      *  boolean whether field was sent to us
      *  @var    UOctet
      */
-    UOctet _priority = 0;
+    mutable UOctet _priority = 0;
 
     /**
      *  application correlation identifier
      *  @var    ShortString
      */
-    ShortString _correlationID;
+    mutable ShortString _correlationID;
 
     /**
      *  address to reply to
      *  @var    ShortString
      */
-    ShortString _replyTo;
+    mutable ShortString _replyTo;
 
     /**
      *  message expiration identifier
      *  @var    ShortString
      */
-    ShortString _expiration;
+    mutable ShortString _expiration;
 
     /**
      *  application message identifier
      *  @var    ShortString
      */
-    ShortString _messageID;
+    mutable ShortString _messageID;
 
     /**
      *  message timestamp
      *  @var    Timestamp
      */
-    Timestamp _timestamp;
+    mutable Timestamp _timestamp;
 
     /**
      *  message type name
      *  @var    ShortString
      */
-    ShortString _typeName;
+    mutable ShortString _typeName;
 
     /**
      *  creating user id
      *  @var    ShortString
      */
-    ShortString _userID;
+    mutable ShortString _userID;
 
     /**
      *  creating application id
      *  @var    ShortString
      */
-    ShortString _appID;
+    mutable ShortString _appID;
 
     /**
      *  Deprecated cluster ID
      *  @var    ShortString
      */
-    ShortString _clusterID;
+    mutable ShortString _clusterID;
 
 
     /**
@@ -133,45 +138,149 @@ protected:
      */
     MetaData() {}
 
+private:
+    /**
+     *  The raw property data that was received: either a view on the frame
+     *  that is being processed, or a copy that is owned by this object
+     *  @var    const char *
+     *  @var    std::string
+     */
+    const char *_view = nullptr;
+    std::string _raw;
+
+    /**
+     *  Size of the raw property data
+     *  @var    uint32_t
+     */
+    uint32_t _rawSize = 0;
+
+    /**
+     *  Properties that were received (in the same format as the flags() method)
+     *  @var    uint16_t
+     */
+    uint16_t _received = 0;
+
+    /**
+     *  Properties that were received, but that have not yet been decoded
+     *  @var    uint16_t
+     */
+    mutable uint16_t _pending = 0;
+
+    /**
+     *  The flags of all properties that are set, in one integer: the properties 
+     *  are numbered from bit 15 down to bit 2, in the order in which they are sent
+     *  @return uint16_t
+     */
+    uint16_t flags() const
+    {
+        return (uint16_t)(_bools1.value() << 8) | (_bools2.value() & 0xfc);
+    }
+
+    /**
+     *  Pointer to the raw property data
+     *  @return const char *
+     */
+    const char *raw() const
+    {
+        return _view ? _view : _raw.data();
+    }
+
+    /**
+     *  Are the raw property data still the exact encoding of the properties? This is
+     *  only the case if nothing was decoded yet, and no properties were set or removed
+     *  @return bool
+     */
+    bool unchanged() const
+    {
+        return _received && _pending == _received && flags() == _received;
+    }
+
+    /**
+     *  Find the offset of the property after a certain property in the raw data
+     *  @param  bit         the bit of the property (see flags())
+     *  @param  offset      offset of the property in the raw data
+     *  @param  nested      should the fields in the headers table be checked too?
+     *  @return uint32_t
+     *  @throws ProtocolException   if the property does not fit in the raw data
+     */
+    uint32_t skip(uint32_t bit, uint32_t offset, bool nested = false) const;
+
+    /**
+     *  Decode a property that was received, but not yet decoded
+     *  @param  bit         the bit of the property (see flags())
+     */
+    void decode(uint32_t bit) const;
+
+    /**
+     *  Decode all properties that were received, but not yet decoded
+     */
+    void decode() const
+    {
+        // decode all pending properties
+        for (uint32_t bit = 2; _pending; ++bit) if (_pending & (1 << bit)) decode(bit);
+    }
+
+    /**
+     *  Make sure that a property is decoded before it is accessed
+     *  @param  bit         the bit of the property (see flags())
+     */
+    void prepare(uint32_t bit) const
+    {
+        // decode it only the first time
+        if (_pending & (1 << bit)) decode(bit);
+    }
+
 
 public:
     /**
      *  Read incoming frame
      *  @param  frame
      */
-    MetaData(ReceivedFrame &frame) :
-        _bools1(frame),
-        _bools2(frame)
-    {
-        // only copy the properties that were sent
-        if (hasContentType())       _contentType = ShortString(frame);
-        if (hasContentEncoding())   _contentEncoding = ShortString(frame);
-        if (hasHeaders())           _headers = Table(frame);
-        if (hasDeliveryMode())      _deliveryMode = UOctet(frame);
-        if (hasPriority())          _priority = UOctet(frame);
-        if (hasCorrelationID())     _correlationID = ShortString(frame);
-        if (hasReplyTo())           _replyTo = ShortString(frame);
-        if (hasExpiration())        _expiration = ShortString(frame);
-        if (hasMessageID())         _messageID = ShortString(frame);
-        if (hasTimestamp())         _timestamp = Timestamp(frame);
-        if (hasTypeName())          _typeName = ShortString(frame);
-        if (hasUserID())            _userID = ShortString(frame);
-        if (hasAppID())             _appID = ShortString(frame);
-        if (hasClusterID())         _clusterID = ShortString(frame);
-    }
+    MetaData(ReceivedFrame &frame);
+
+    /**
+     *  Copy constructor (the raw data is copied, because the original object
+     *  may hold a view on a frame that is only valid while it is processed)
+     *  @param  that
+     */
+    MetaData(const MetaData &that) { set(that); }
 
     /**
      *  Destructor
      */
     virtual ~MetaData() {}
 
+    /**
+     *  Assignment operator
+     *  @param  that
+     *  @return MetaData
+     */
+    MetaData &operator=(const MetaData &that)
+    {
+        // skip self assignment
+        if (this != &that) set(that);
+
+        // allow chaining
+        return *this;
+    }
+
     /**
      *  Set all meta data
      *  @param  data
      */
     void set(const MetaData &data)
     {
-        // simply copy all fields
+        // the properties that are not yet decoded are copied as raw data
+        if (data._pending) _raw.assign(data.raw(), data._rawSize);
+        else _raw.clear();
+
+        // it is no longer a view on a frame
+        _view = nullptr;
+        _rawSize = data._pending ? data._rawSize : 0;
+        _received = data._received;
+        _pending = data._pending;
+
+        // simply copy all (decoded) fields
         _bools1 = data._bools1;
         _bools2 = data._bools2;
         _contentType = data._contentType;
@@ -213,56 +322,56 @@ public:
      *  Set the various supported fields
      *  @param  value
      */
-    void setExpiration      (const std::string &value) { _expiration        = value; _bools1.set(0,true); }
-    void setReplyTo         (const std::string &value) { _replyTo           = value; _bools1.set(1,true); }
-    void setCorrelationID   (const std::string &value) { _correlationID     = value; _bools1.set(2,true); }
-    void setPriority        (uint8_t value)            { _priority          = value; _bools1.set(3,true); }
-    void setDeliveryMode    (uint8_t value)            { _deliveryMode      = value; _bools1.set(4,true); }
-    void setHeaders         (const Table &value)       { _headers           = value; _bools1.set(5,true); }
-    void setContentEncoding (const std::string &value) { _contentEncoding   = value; _bools1.set(6,true); }
-    void setContentType     (const std::string &value) { _contentType       = value; _bools1.set(7,true); }
-    void setClusterID       (const std::string &value) { _clusterID         = value; _bools2.set(2,true); }
-    void setAppID           (const std::string &value) { _appID             = value; _bools2.set(3,true); }
-    void setUserID          (const std::string &value) { _userID            = value; _bools2.set(4,true); }
-    void setTypeName        (const std::string &value) { _typeName          = value; _bools2.set(5,true); }
-    void setTimestamp       (uint64_t value)           { _timestamp         = value; _bools2.set(6,true); }
-    void setMessageID       (const std::string &value) { _messageID         = value; _bools2.set(7,true); }
+    void setExpiration      (const std::string &value) { _expiration        = value; _bools1.set(0,true); _pending &= ~(1 << 8); }
+    void setReplyTo         (const std::string &value) { _replyTo           = value; _bools1.set(1,true); _pending &= ~(1 << 9); }
+    void setCorrelationID   (const std::string &value) { _correlationID     = value; _bools1.set(2,true); _pending &= ~(1 << 10); }
+    void setPriority        (uint8_t value)            { _priority          = value; _bools1.set(3,true); _pending &= ~(1 << 11); }
+    void setDeliveryMode    (uint8_t value)            { _deliveryMode      = value; _bools1.set(4,true); _pending &= ~(1 << 12); }
+    void setHeaders         (const Table &value)       { _headers           = value; _bools1.set(5,true); _pending &= ~(1 << 13); }
+    void setContentEncoding (const std::string &value) { _contentEncoding   = value; _bools1.set(6,true); _pending &= ~(1 << 14); }
+    void setContentType     (const std::string &value) { _contentType       = value; _bools1.set(7,true); _pending &= ~(1 << 15); }
+    void setClusterID       (const std::string &value) { _clusterID         = value; _bools2.set(2,true); _pending &= ~(1 << 2); }
+    void setAppID           (const std::string &value) { _appID             = value; _bools2.set(3,true); _pending &= ~(1 << 3); }
+    void setUserID          (const std::string &value) { _userID            = value; _bools2.set(4,true); _pending &= ~(1 << 4); }
+    void setTypeName        (const std::string &value) { _typeName          = value; _bools2.set(5,true); _pending &= ~(1 << 5); }
+    void setTimestamp       (uint64_t value)           { _timestamp         = value; _bools2.set(6,true); _pending &= ~(1 << 6); }
+    void setMessageID       (const std::string &value) { _messageID         = value; _bools2.set(7,true); _pending &= ~(1 << 7); }
 
     /**
      *  Set the various supported fields using r-value references
      *
      *  @param  value   moveable value
      */
-    void setExpiration      (std::string &&value) { _expiration       = std::move(value); _bools1.set(0,true); }
-    void setReplyTo         (std::string &&value) { _replyTo          = std::move(value); _bools1.set(1,true); }
-    void setCorrelationID   (std::string &&value) { _correlationID    = std::move(value); _bools1.set(2,true); }
-    void setHeaders         (Table &&value)       { _headers          = std::move(value); _bools1.set(5,true); }
-    void setContentEncoding (std::string &&value) { _contentEncoding  = std::move(value); _bools1.set(6,true); }
-    void setContentType     (std::string &&value) { _contentType      = std::move(value); _bools1.set(7,true); }
-    void setClusterID       (std::string &&value) { _clusterID        = std::move(value); _bools2.set(2,true); }
-    void setAppID           (std::string &&value) { _appID            = std::move(value); _bools2.set(3,true); }
-    void setUserID          (std::string &&value) { _userID           = std::move(value); _bools2.set(4,true); }
-    void setTypeName        (std::string &&value) { _typeName         = std::move(value); _bools2.set(5,true); }
-    void setMessageID       (std::string &&value) { _messageID        = std::move(value); _bools2.set(7,true); }
+    void setExpiration      (std::string &&value) { _expiration       = std::move(value); _bools1.set(0,true); _pending &= ~(1 << 8); }
+    void setReplyTo         (std::string &&value) { _replyTo          = std::move(value); _bools1.set(1,true); _pending &= ~(1 << 9); }
+    void setCorrelationID   (std::string &&value) { _correlationID    = std::move(value); _bools1.set(2,true); _pending &= ~(1 << 10); }
+    void setHeaders         (Table &&value)       { _headers          = std::move(value); _bools1.set(5,true); _pending &= ~(1 << 13); }
+    void setContentEncoding (std::string &&value) { _contentEncoding  = std::move(value); _bools1.set(6,true); _pending &= ~(1 << 14); }
+    void setContentType     (std::string &&value) { _contentType      = std::move(value); _bools1.set(7,true); _pending &= ~(1 << 15); }
+    void setClusterID       (std::string &&value) { _clusterID        = std::move(value); _bools2.set(2,true); _pending &= ~(1 << 2); }
+    void setAppID           (std::string &&value) { _appID            = std::move(value); _bools2.set(3,true); _pending &= ~(1 << 3); }
+    void setUserID          (std::string &&value) { _userID           = std::move(value); _bools2.set(4,true); _pending &= ~(1 << 4); }
+    void setTypeName        (std::string &&value) { _typeName         = std::move(value); _bools2.set(5,true); _pending &= ~(1 << 5); }
+    void setMessageID       (std::string &&value) { _messageID        = std::move(value); _bools2.set(7,true); _pending &= ~(1 << 7); }
 
     /**
      *  Retrieve the fields
      *  @return string
      */
-    const std::string &expiration     () const { return _expiration;        }
-    const std::string &replyTo        () const { return _replyTo;           }
-    const std::string &correlationID  () const { return _correlationID;     }
-          uint8_t      priority       () const { return _priority;          }
-          uint8_t      deliveryMode   () const { return _deliveryMode;      }
-    const Table       &headers        () const { return _headers;           }
-    const std::string &contentEncoding() const { return _contentEncoding;   }
-    const std::string &contentType    () const { return _contentType;       }
-    const std::string &clusterID      () const { return _clusterID;         }
-    const std::string &appID          () const { return _appID;             }
-    const std::string &userID         () const { return _userID;            }
-    const std::string &typeName       () const { return _typeName;          }
-          uint64_t     timestamp      () const { return _timestamp;         }
-    const std::string &messageID      () const { return _messageID;         }
+    const std::string &expiration     () const { prepare(8);  return _expiration;       }
+    const std::string &replyTo        () const { prepare(9);  return _replyTo;          }
+    const std::string &correlationID  () const { prepare(10); return _correlationID;    }
+          uint8_t      priority       () const { prepare(11); return _priority;         }
+          uint8_t      deliveryMode   () const { prepare(12); return _deliveryMode;     }
+    const Table       &headers        () const { prepare(13); return _headers;          }
+    const std::string &contentEncoding() const { prepare(14); return _contentEncoding;  }
+    const std::string &contentType    () const { prepare(15); return _contentType;      }
+    const std::string &clusterID      () const { prepare(2);  return _clusterID;        }
+    const std::string &appID          () const { prepare(3);  return _appID;            }
+    const std::string &userID         () const { prepare(4);  return _userID;           }
+    const std::string &typeName       () const { prepare(5);  return _typeName;         }
+          uint64_t     timestamp      () const { prepare(6);  return _timestamp;        }
+    const std::string &messageID      () const { prepare(7);  return _messageID;        }
 
     /**
      *  Is this a message with persistent storage
@@ -290,6 +399,7 @@ public:
             // we remove the field from the header
             _deliveryMode = 0;
             _bools1.set(4,false);
+            _pending &= ~(1 << 12);
         }
     }
 
@@ -299,6 +409,12 @@ public:
      */
     uint32_t size() const
     {
+        // if none of the received properties was decoded, changed or removed, we can use the raw data
+        if (unchanged()) return 2 + _rawSize;
+
+        // make sure all properties are decoded
+        decode();
+
         // the result (2 for the two boolean sets)
         uint32_t result = 2;
 
@@ -331,6 +447,12 @@ public:
         _bools1.fill(buffer);
         _bools2.fill(buffer);
 
+        // if none of the received properties was decoded, changed or removed, we can use the raw data
+        if (unchanged()) return buffer.add(raw(), _rawSize);
+
+        // make sure all properties are decoded
+        decode();
+
         // only copy the properties that were sent
         if (hasContentType())       _contentType.fill(buffer);
         if (hasContentEncoding())   _contentEncoding.fill(buffer);
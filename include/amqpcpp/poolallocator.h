@@ -0,0 +1,200 @@
+/**
+ *  PoolAllocator.h
+ *
+ *  Allocator that keeps released memory in a pool, so that it can be reused
+ *  for later allocations. Memory is handed out in size classes (powers of
+ *  two), and every size class has its own list of free blocks. When the
+ *  connection is in a steady state (publishing or consuming messages of
+ *  more or less the same size) the pool no longer calls malloc() or free().
+ *
+ *  The pool is not thread safe. This is normally not a problem, because a
+ *  connection should only be used from one thread anyway. If you have
+ *  multiple connections in the same thread, they can share a pool. The pool
+ *  must stay alive for as long as the connections that use it.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include "allocator.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class PoolAllocator : public Allocator
+{
+private:
+    /**
+     *  A free block of memory (the pointer is stored in the block itself)
+     */
+    struct Block
+    {
+        /**
+         *  The next free block
+         *  @var Block*
+         */
+        Block *next;
+    };
+
+    /**
+     *  Size of the smallest size class (2^6 = 64 bytes), and the number of
+     *  size classes (the largest class holds blocks of 2^20 = 1MB)
+     *  @var size_t
+     */
+    static constexpr size_t minshift = 6;
+    static constexpr size_t classes = 15;
+
+    /**
+     *  Lists of free blocks, one for every size class
+     *  @var Block*[]
+     */
+    Block *_free[classes];
+
+    /**
+     *  Max number of bytes that are kept in the pool
+     *  @var size_t
+     */
+    size_t _limit;
+
+    /**
+     *  Number of bytes that are currently kept in the pool
+     *  @var size_t
+     */
+    size_t _cached = 0;
+
+    /**
+     *  Find the size class for a number of bytes
+     *  @param  size        number of bytes
+     *  @return size_t      the size class, or 'classes' if the size is too big
+     */
+    static size_t sizeclass(size_t size)
+    {
+        // start with the smallest class
+        size_t result = 0;
+
+        // find the first class that is big enough
+        while (result < classes && ((size_t)1 << (result + minshift)) < size) result++;
+
+        // done
+        return result;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  limit       max number of bytes to keep in the pool
+     */
+    PoolAllocator(size_t limit = 16 * 1024 * 1024) : _limit(limit)
+    {
+        // all lists are empty
+        for (size_t i = 0; i < classes; ++i) _free[i] = nullptr;
+    }
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    PoolAllocator(const PoolAllocator &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~PoolAllocator()
+    {
+        // release all memory in the pool
+        for (size_t i = 0; i < classes; ++i)
+        {
+            // free all blocks in this list
+            while (_free[i])
+            {
+                // the next block
+                auto *next = _free[i]->next;
+
+                // release this one
+                free(_free[i]);
+
+                // move on
+                _free[i] = next;
+            }
+        }
+    }
+
+    /**
+     *  Allocate a block of memory
+     *  @param  size        number of bytes to allocate
+     *  @return void*       the allocated memory
+     */
+    virtual void *allocate(size_t size) override
+    {
+        // find the size class
+        auto index = sizeclass(size);
+
+        // big blocks are not pooled
+        if (index >= classes) return malloc(size);
+
+        // is there a free block that we can reuse?
+        if (_free[index] == nullptr) return malloc((size_t)1 << (index + minshift));
+
+        // take the block from the list
+        auto *block = _free[index];
+        _free[index] = block->next;
+
+        // update the pool size
+        _cached -= (size_t)1 << (index + minshift);
+
+        // done
+        return block;
+    }
+
+    /**
+     *  Deallocate a block of memory that was returned by allocate()
+     *  @param  pointer     the memory to release (may be nullptr)
+     *  @param  size        the size that was passed to allocate()
+     */
+    virtual void deallocate(void *pointer, size_t size) override
+    {
+        // nothing to do for null pointers
+        if (pointer == nullptr) return;
+
+        // find the size class
+        auto index = sizeclass(size);
+
+        // big blocks are not pooled, and we do not grow beyond the limit
+        if (index >= classes || _cached + ((size_t)1 << (index + minshift)) > _limit) return free(pointer);
+
+        // add the block to the list
+        auto *block = (Block *)pointer;
+        block->next = _free[index];
+        _free[index] = block;
+
+        // update the pool size
+        _cached += (size_t)1 << (index + minshift);
+    }
+
+    /**
+     *  Number of bytes that are currently kept in the pool
+     *  @return size_t
+     */
+    size_t cached() const
+    {
+        // expose member
+        return _cached;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,89 @@
+/**
+ *  PublishTemplate.h
+ *
+ *  If many messages are published to the same exchange, with the same routing
+ *  key and the same properties, you can create a publish template once, and
+ *  use it for all these messages. The template holds the encoded method frame
+ *  and header frame, so that publishing a message only requires the channel id
+ *  and the body size to be filled in, instead of encoding all frames again.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Forward declarations
+ */
+class MetaData;
+class ChannelImpl;
+
+/**
+ *  Class definition
+ */
+class PublishTemplate
+{
+private:
+    /**
+     *  The encoded method frame and header frame (with channel id 0 and body size 0)
+     *  @var std::string
+     */
+    std::string _data;
+
+    /**
+     *  Size of the method frame (the header frame starts right after it)
+     *  @var uint32_t
+     */
+    uint32_t _split = 0;
+
+    /**
+     *  The channel needs access to the frames
+     */
+    friend class ChannelImpl;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  The metadata can also be an Envelope or a Message, but only the properties are
+     *  used: the body is passed to the Channel::publish() method for each message.
+     *  The flags are the same as the flags of the regular Channel::publish() method.
+     *
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingkey  the routing key
+     *  @param  metadata    the properties of the messages
+     *  @param  flags       optional flags
+     */
+    PublishTemplate(const std::string &exchange, const std::string &routingKey, const MetaData &metadata, int flags = 0);
+
+    /**
+     *  Constructor for messages without properties
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingkey  the routing key
+     *  @param  flags       optional flags
+     */
+    PublishTemplate(const std::string &exchange, const std::string &routingKey, int flags = 0);
+
+    /**
+     *  Destructor
+     */
+    virtual ~PublishTemplate() {}
+};
+
+/**
+ *  End of namespace
+ */
+}
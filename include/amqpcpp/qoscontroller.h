@@ -0,0 +1,395 @@
+/**
+ *  QosController.h
+ *
+ *  Controller that adjusts the prefetch count of a channel at runtime. It
+ *  watches how fast the application acks the messages that are delivered,
+ *  and how long it takes before the broker uses the credit that an ack
+ *  frees up. When the application runs out of messages, the window grows to
+ *  twice the number of messages that are on their way (the bandwidth-delay
+ *  product). When messages keep waiting in client memory, the window shrinks
+ *  by half of that backlog. Periods in which the broker had nothing to send
+ *  are left out of the measurements.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  The metrics of the controller
+ */
+struct QosMetrics
+{
+    /**
+     *  The current prefetch count
+     *  @var uint16_t
+     */
+    uint16_t prefetch = 0;
+
+    /**
+     *  Number of messages that were delivered, but that are not yet acked
+     *  @var size_t
+     */
+    size_t outstanding = 0;
+
+    /**
+     *  Number of messages that are acked per second
+     *  @var double
+     */
+    double rate = 0.0;
+
+    /**
+     *  Average time between the delivery and the ack of a message, in microseconds
+     *  @var double
+     */
+    double latency = 0.0;
+
+    /**
+     *  Average time between an ack and the delivery that it made possible, in microseconds
+     *  @var double
+     */
+    double roundtrip = 0.0;
+
+    /**
+     *  Number of times that the prefetch count was increased and decreased
+     *  @var size_t
+     */
+    size_t increases = 0;
+    size_t decreases = 0;
+};
+
+/**
+ *  Class definition
+ */
+class QosController
+{
+private:
+    /**
+     *  The clock that is used
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     *  The bounds of the prefetch count
+     *  @var uint16_t
+     */
+    uint16_t _minimum;
+    uint16_t _maximum;
+
+    /**
+     *  Time between two decisions
+     *  @var Clock::duration
+     */
+    Clock::duration _interval;
+
+    /**
+     *  The messages that are not yet acked, and the time when they were delivered
+     *  @var std::deque
+     */
+    std::deque<std::pair<uint64_t, Clock::time_point>> _deliveries;
+
+    /**
+     *  The metrics
+     *  @var QosMetrics
+     */
+    QosMetrics _metrics;
+
+    /**
+     *  Total number of messages that were delivered and settled
+     *  @var uint64_t
+     */
+    uint64_t _received = 0;
+    uint64_t _released = 0;
+
+    /**
+     *  Start of the current interval
+     *  @var Clock::time_point
+     */
+    Clock::time_point _since;
+
+    /**
+     *  Number of acked messages during the interval
+     *  @var size_t
+     */
+    size_t _acked = 0;
+
+    /**
+     *  Lowest number of outstanding messages after an ack during the interval (if this
+     *  is not zero, these messages were waiting in memory during the entire interval)
+     *  @var size_t
+     */
+    size_t _lowest = std::numeric_limits<size_t>::max();
+
+    /**
+     *  Round trip measurement: the time of the ack, and the number of deliveries
+     *  that is reached with the delivery that the ack made possible
+     *  @var Clock::time_point
+     *  @var uint64_t
+     */
+    Clock::time_point _freed;
+    uint64_t _expected = 0;
+
+    /**
+     *  The last time that all outstanding messages were settled
+     *  @var Clock::time_point
+     */
+    Clock::time_point _emptied;
+
+    /**
+     *  Add a sample to an average
+     *  @param  average
+     *  @param  sample
+     */
+    static void sample(double &average, double sample)
+    {
+        // the first sample is used as is, later ones are smoothed (like the tcp rtt estimator)
+        average = average == 0.0 ? sample : average + (sample - average) / 8;
+    }
+
+    /**
+     *  Number of microseconds between two times
+     *  @param  from
+     *  @param  to
+     *  @return double
+     */
+    static double micro(Clock::time_point from, Clock::time_point to)
+    {
+        return std::chrono::duration<double, std::micro>(to - from).count();
+    }
+
+    /**
+     *  Remove a message that was processed
+     *  @param  iter        the message
+     *  @param  now         current time
+     */
+    void remove(std::deque<std::pair<uint64_t, Clock::time_point>>::iterator iter, Clock::time_point now)
+    {
+        // update the latency
+        sample(_metrics.latency, micro(iter->second, now));
+
+        // one more message was acked
+        ++_acked;
+        ++_released;
+
+        // forget the message
+        _deliveries.erase(iter);
+    }
+
+    /**
+     *  Start a new interval
+     *  @param  now         current time
+     */
+    void restart(Clock::time_point now)
+    {
+        // reset the counters
+        _since = now;
+        _acked = 0;
+        _lowest = std::numeric_limits<size_t>::max();
+    }
+
+    /**
+     *  Decide on the new prefetch count at the end of an interval
+     *  @param  now         current time
+     *  @return bool        was the prefetch count changed?
+     */
+    bool decide(Clock::time_point now)
+    {
+        // the ack rate during the interval
+        double rate = _acked / (micro(_since, now) / 1000000.0);
+        _metrics.rate = _metrics.rate == 0.0 ? rate : (_metrics.rate + rate) / 2;
+
+        // the number of messages that are on their way while an ack is turned into a new delivery
+        double flight = _metrics.rate * _metrics.roundtrip / 1000000.0;
+
+        // the current window
+        double target = _metrics.prefetch;
+
+        // if we ran out of messages, we need at least twice the messages in flight (or, if we do
+        // not know that number yet, twice the window), and if messages were waiting in memory all
+        // the time, we can do with half of them less (but still with twice the messages in flight)
+        if (_lowest == 0) target = std::max(target, _metrics.roundtrip > 0.0 ? flight * 2 : target * 2);
+        else target = std::max(flight * 2, target - _lowest / 2.0);
+
+        // apply the bounds
+        uint16_t prefetch = (uint16_t)std::max((double)_minimum, std::min((double)_maximum, std::ceil(target)));
+
+        // start the next interval
+        restart(now);
+
+        // small changes are ignored, they would only cost an extra roundtrip
+        if (std::abs((int)prefetch - (int)_metrics.prefetch) * 4 <= _metrics.prefetch) return false;
+
+        // update the counters
+        if (prefetch > _metrics.prefetch) ++_metrics.increases; else ++_metrics.decreases;
+
+        // store the new prefetch count
+        _metrics.prefetch = prefetch;
+
+        // done
+        return true;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  minimum     the lowest prefetch count (this is also where we start)
+     *  @param  maximum     the highest prefetch count
+     *  @param  interval    time between two decisions
+     */
+    QosController(uint16_t minimum, uint16_t maximum, std::chrono::milliseconds interval = std::chrono::milliseconds(100)) :
+        _minimum(std::max(minimum, (uint16_t)1)), _maximum(std::max(maximum, _minimum)), _interval(interval), _since(Clock::now())
+    {
+        // we start with the minimum
+        _metrics.prefetch = _minimum;
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~QosController() {}
+
+    /**
+     *  The current prefetch count
+     *  @return uint16_t
+     */
+    uint16_t prefetch() const
+    {
+        return _metrics.prefetch;
+    }
+
+    /**
+     *  The metrics
+     *  @return QosMetrics
+     */
+    QosMetrics metrics() const
+    {
+        // copy the metrics
+        QosMetrics result = _metrics;
+
+        // add the number of outstanding messages
+        result.outstanding = _deliveries.size();
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Register a message that was delivered
+     *  @param  tag         the delivery tag
+     */
+    void delivered(uint64_t tag)
+    {
+        // current time
+        auto now = Clock::now();
+
+        // one more delivery
+        ++_received;
+
+        // if we had run out of messages, and nothing arrived for an entire interval, the broker
+        // had nothing to send: the idle time tells nothing about the round trip or the ack rate
+        if (_deliveries.empty() && now - _emptied >= _interval)
+        {
+            // forget the running measurement and the interval
+            _expected = 0;
+            restart(now);
+        }
+
+        // if this is the delivery that an earlier ack made possible, we know the round trip
+        // (a round trip longer than the interval can not be used, so we do not record it)
+        if (_expected > 0 && _received >= _expected)
+        {
+            // update the round trip
+            if (now - _freed < _interval) sample(_metrics.roundtrip, micro(_freed, now));
+
+            // the measurement is done
+            _expected = 0;
+        }
+
+        // remember the message
+        _deliveries.emplace_back(tag, now);
+    }
+
+    /**
+     *  Register messages that were acked or rejected
+     *  @param  tag         the delivery tag
+     *  @param  multiple    are all earlier messages settled too?
+     *  @return bool        was the prefetch count changed?
+     */
+    bool settled(uint64_t tag, bool multiple)
+    {
+        // current time
+        auto now = Clock::now();
+
+        // remove all earlier messages
+        while (multiple && !_deliveries.empty() && _deliveries.front().first <= tag) remove(_deliveries.begin(), now);
+
+        // remove the message itself (normally it is the first one)
+        if (!multiple)
+        {
+            // find the message
+            auto iter = std::find_if(_deliveries.begin(), _deliveries.end(), [tag](const std::pair<uint64_t, Clock::time_point> &delivery) {
+                return delivery.first == tag;
+            });
+
+            // remove it
+            if (iter != _deliveries.end()) remove(iter, now);
+        }
+
+        // the backlog that is left
+        _lowest = std::min(_lowest, _deliveries.size());
+
+        // remember when we ran out of messages
+        if (_deliveries.empty()) _emptied = now;
+
+        // the broker may now send the message that brings the deliveries to the settled messages plus the
+        // window, we measure how long that takes (unless a measurement is already running)
+        if (_expected == 0 && _received < _released + _metrics.prefetch)
+        {
+            // start the measurement
+            _freed = now;
+            _expected = _released + _metrics.prefetch;
+        }
+
+        // decide on the new prefetch count at the end of the interval
+        return now - _since >= _interval && decide(now);
+    }
+
+    /**
+     *  Forget all outstanding messages (because they were recovered)
+     */
+    void clear()
+    {
+        // the messages are settled
+        _released += _deliveries.size();
+
+        // forget them
+        _deliveries.clear();
+
+        // stop the round trip measurement
+        _expected = 0;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
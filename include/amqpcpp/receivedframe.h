@@ -8,7 +8,7 @@
  *  This is a class that is used internally by the AMQP library. As a user
  *  of this library, you normally do not have to instantiate it.
  *
- *  @copyright 2014 - 2017 Copernica BV
+ *  @copyright 2014 - 2018 Copernica BV
  */
 
 /**
@@ -20,6 +20,7 @@
  *  Dependencies
  */
 #include <cstdint>
+#include "buffer.h"
 
 /**
  *  Set up namespace
@@ -68,6 +69,33 @@ private:
      */
     uint32_t _payloadSize = 0;
 
+    /**
+     *  Offset of the payload in the buffer (a frame starts with a 7 byte
+     *  header, a block of encoded fields has no header at all)
+     *  @var    uint8_t
+     */
+    uint8_t _payloadOffset = 7;
+
+    /**
+     *  Pointer to the frame in memory, if the buffer holds the complete
+     *  frame in one continuous block (nullptr otherwise)
+     *  @var    const char *
+     */
+    const char *_data = nullptr;
+
+    /**
+     *  Decode the frame header straight from memory
+     *  @param  data        pointer to the first byte of the frame
+     */
+    void decode(const char *data);
+
+    /**
+     *  Pointer to the next bytes in memory (only when _data is set)
+     *  @param  size        number of bytes to consume
+     *  @return const char*
+     */
+    const char *fetch(uint32_t size);
+
 
     /**
      *  Process a method frame
@@ -141,6 +169,14 @@ public:
      */
     ReceivedFrame(const Buffer &buffer, uint32_t max);
 
+    /**
+     *  Constructor for a buffer that does not hold a full frame, but only
+     *  a block of encoded fields (this is used to decode properties that
+     *  were copied out of the original frame)
+     *  @param  buffer      Binary buffer
+     */
+    explicit ReceivedFrame(const Buffer &buffer) : _buffer(buffer), _payloadSize((uint32_t)buffer.size()), _payloadOffset(0) {}
+
     /**
      *  Destructor
      */
@@ -187,6 +223,15 @@ public:
         return _payloadSize;
     }
 
+    /**
+     *  The number of payload bytes that have not yet been read
+     *  @return uint32_t
+     */
+    uint32_t remaining() const
+    {
+        return _payloadOffset + _payloadSize - _skip;
+    }
+
     /**
      *  Read the next uint8_t from the buffer
      *
@@ -0,0 +1,71 @@
+/**
+ *  Sink.h
+ *
+ *  Interface for objects that consume the body of messages while they are
+ *  being received, for example to write huge messages straight to disk or
+ *  to another socket (see DeferredConsumer::onSink()). A sink that can not
+ *  keep up can pause the connection, so that no more data is read from the
+ *  socket until the application resumes it.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class Sink
+{
+public:
+    /**
+     *  Destructor
+     */
+    virtual ~Sink() = default;
+
+    /**
+     *  Method that is called when a new message starts
+     *  @param  size        size of the message body
+     */
+    virtual void begin(uint64_t size) {}
+
+    /**
+     *  Method that is called for every chunk of the message body
+     *
+     *  If the sink can not accept more data right away, it should return false.
+     *  The connection then stops processing incoming data right after this chunk,
+     *  and no more data is read from the socket until Connection::resume() (or
+     *  TcpConnection::resume()) is called.
+     *
+     *  @param  data        the data
+     *  @param  size        size of the data
+     *  @return bool        may more data be passed to the sink right away?
+     */
+    virtual bool write(const char *data, size_t size) = 0;
+
+    /**
+     *  Method that is called when the message was completely received
+     *  @param  deliveryTag the delivery tag, you need this to acknowledge the message
+     *  @param  redelivered is this a redelivered message?
+     */
+    virtual void complete(uint64_t deliveryTag, bool redelivered) {}
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,141 @@
+/**
+ *  StringView.h
+ *
+ *  A string that is not owned, but that refers to memory elsewhere, normally
+ *  the buffer with data that was received from the RabbitMQ server. A view
+ *  is only valid for as long as the memory it refers to exists, which, for
+ *  views that are passed to callbacks, means: for the duration of the
+ *  callback. Call str() to turn it into a std::string that you own.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <string>
+#include <cstring>
+#include <ostream>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class StringView
+{
+private:
+    /**
+     *  The data
+     *  @var const char *
+     */
+    const char *_data;
+
+    /**
+     *  Number of bytes
+     *  @var size_t
+     */
+    size_t _size;
+
+public:
+    /**
+     *  Constructor
+     *  @param  data
+     *  @param  size
+     */
+    StringView(const char *data = "", size_t size = 0) : _data(data), _size(size) {}
+
+    /**
+     *  Constructor that refers to the data of a string (which must stay alive)
+     *  @param  string
+     */
+    explicit StringView(const std::string &string) : _data(string.data()), _size(string.size()) {}
+
+    /**
+     *  The data (this is not null terminated)
+     *  @return const char *
+     */
+    const char *data() const { return _data; }
+
+    /**
+     *  Number of bytes
+     *  @return size_t
+     */
+    size_t size() const { return _size; }
+
+    /**
+     *  Is the string empty?
+     *  @return bool
+     */
+    bool empty() const { return _size == 0; }
+
+    /**
+     *  Copy the data into a string that is owned by the caller
+     *  @return std::string
+     */
+    std::string str() const { return std::string(_data, _size); }
+
+    /**
+     *  Compare with a different view
+     *  @param  that
+     *  @return bool
+     */
+    bool operator==(const StringView &that) const
+    {
+        return _size == that._size && memcmp(_data, that._data, _size) == 0;
+    }
+
+    /**
+     *  Compare with a different view
+     *  @param  that
+     *  @return bool
+     */
+    bool operator!=(const StringView &that) const
+    {
+        return !operator==(that);
+    }
+
+    /**
+     *  Compare with a string
+     *  @param  that
+     *  @return bool
+     */
+    bool operator==(const std::string &that) const
+    {
+        return _size == that.size() && memcmp(_data, that.data(), _size) == 0;
+    }
+
+    /**
+     *  Compare with a string
+     *  @param  that
+     *  @return bool
+     */
+    bool operator!=(const std::string &that) const
+    {
+        return !operator==(that);
+    }
+
+    /**
+     *  Write to a stream
+     *  @param  stream
+     *  @param  view
+     *  @return std::ostream
+     */
+    friend std::ostream &operator<<(std::ostream &stream, const StringView &view)
+    {
+        return stream.write(view._data, view._size);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
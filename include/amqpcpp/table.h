@@ -1,7 +1,13 @@
 /**
  *  AMQP field table
  *
- *  @copyright 2014 Copernica BV
+ *  The table is stored in its encoded form: one block of memory that holds 
+ *  all the names, types and values. Setting a field encodes it into this
+ *  block, and copying or sending a table is just a matter of copying the
+ *  block. Fields are only decoded (into separate objects) when they are 
+ *  retrieved with the get() method.
+ *
+ *  @copyright 2014 - 2018 Copernica BV
  */
 
 /**
@@ -29,16 +35,50 @@ class Table : public Field
 {
 private:
     /**
-     *  We define a custom type for storing fields
+     *  We define a custom type for storing decoded fields
      *  @typedef    FieldMap
      */
     typedef std::map<std::string, std::shared_ptr<Field> > FieldMap;
 
     /**
-     *  Store the fields
+     *  The encoded fields (without the leading size), sorted by name
+     *  @var    std::string
+     */
+    std::string _data;
+
+    /**
+     *  Fields that were decoded because they were retrieved
      *  @var    FieldMap
      */
-    FieldMap _fields;
+    mutable FieldMap _decoded;
+
+    /**
+     *  Memory in which new decoded fields are constructed (each decoded field
+     *  keeps the arena in which it was constructed alive)
+     *  @var    std::shared_ptr<FieldArena>
+     */
+    mutable std::shared_ptr<FieldArena> _arena;
+
+    /**
+     *  Find the position of the next field in the encoded data
+     *  @param  pos     position of a field
+     *  @return size_t  position of the field after it
+     *  @throws ProtocolException   if the encoded data is invalid
+     */
+    size_t next(size_t pos) const;
+
+    /**
+     *  Find the position of a field in the encoded data
+     *  @param  name    field name
+     *  @return size_t  position of the field, or std::string::npos if it is not in the table
+     */
+    size_t find(const std::string &name) const;
+
+    /**
+     *  Remove a field from the encoded data
+     *  @param  name    field name
+     */
+    void remove(const std::string &name);
 
 public:
     /**
@@ -63,7 +103,7 @@ public:
      *  Move constructor
      *  @param  table
      */
-    Table(Table &&table) : _fields(std::move(table._fields)) {}
+    Table(Table &&table) : _data(std::move(table._data)), _decoded(std::move(table._decoded)), _arena(std::move(table._arena)) {}
 
     /**
      *  Destructor
@@ -104,7 +144,11 @@ public:
      *  Get the size this field will take when
      *  encoded in the AMQP wire-frame format
      */
-    virtual size_t size() const override;
+    virtual size_t size() const override
+    {
+        // the encoded fields, and four bytes for the size
+        return _data.size() + 4;
+    }
 
     /**
      *  Set a field
@@ -112,14 +156,7 @@ public:
      *  @param  value   field value
      *  @return Table
      */
-    Table &set(const std::string& name, const Field &value)
-    {
-        // copy to a new pointer and store it
-        _fields[name] = value.clone();
-
-        // allow chaining
-        return *this;
-    }
+    Table &set(const std::string& name, const Field &value);
 
     /**
      *  Aliases for setting values
@@ -146,7 +183,7 @@ public:
      */
     bool contains(const std::string &name) const
     {
-        return _fields.find(name) != _fields.end();
+        return find(name) != std::string::npos;
     }
 
     /**
@@ -237,13 +274,13 @@ public:
         bool first = true;
 
         // loop through all members
-        for (auto &iter : _fields)
+        for (auto &key : keys())
         {
             // split with comma
             if (!first) stream << ",";
 
             // show output
-            stream << iter.first << ":" << *iter.second;
+            stream << key << ":" << get(key);
 
             // no longer first iter
             first = false;
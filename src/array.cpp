@@ -5,6 +5,7 @@
  *
  */
 #include "includes.h"
+#include "fieldarena.h"
 
 // we live in the copernica namespace
 namespace AMQP {
@@ -18,6 +19,9 @@ Array::Array(ReceivedFrame &frame)
     // use this to see if we've read too many bytes.
     uint32_t charsToRead = frame.nextUint32();
 
+    // the fields are constructed in an arena that lives as long as one of the fields
+    auto arena = std::make_shared<FieldArena>();
+
     // keep going until all data is read
     while (charsToRead > 0)
     {
@@ -25,14 +29,14 @@ Array::Array(ReceivedFrame &frame)
         charsToRead -= 1;
 
         // read the field type and construct the field
-        Field *field = Field::decode(frame);
+        Field *field = Field::decode(frame, *arena);
         if (!field) continue;
 
         // less bytes to read
         charsToRead -= (uint32_t)field->size();
 
-        // add the additional field
-        _fields.push_back(std::shared_ptr<Field>(field));
+        // add the additional field (the pointer shares the ownership of the arena)
+        _fields.push_back(std::shared_ptr<Field>(arena, field));
     }
 }
 
@@ -107,7 +111,7 @@ size_t Array::size() const
     size_t size = 4;
 
     // iterate over all elements
-    for (auto item : _fields)
+    for (const auto &item : _fields)
     {
         // add the size of the field type and size of element
         size += sizeof(item->typeID());
@@ -128,7 +132,7 @@ void Array::fill(OutBuffer& buffer) const
     buffer.add(static_cast<uint32_t>(size()-4));
 
     // iterate over all elements
-    for (auto item : _fields)
+    for (const auto &item : _fields)
     {
         // encode the element type and element
         buffer.add((uint8_t)item->typeID());
@@ -13,8 +13,7 @@
  *  Dependencies
  */
 #include "basicframe.h"
-#include "amqpcpp/stringfield.h"
-#include "amqpcpp/booleanset.h"
+#include "amqpcpp/stringview.h"
 #include "amqpcpp/connectionimpl.h"
 #include "amqpcpp/deferredconsumer.h"
 
@@ -29,11 +28,18 @@ namespace AMQP{
 class BasicDeliverFrame : public BasicFrame
 {
 private:
+    /**
+     *  Storage for the strings of a frame that is created client side (the
+     *  strings of a received frame refer to the received data instead)
+     *  @var std::string
+     */
+    std::string _storage;
+
     /**
      *  identifier for the consumer, valid within current channel
-     *  @var ShortString
+     *  @var StringView
      */
-    ShortString _consumerTag;
+    StringView _consumerTag;
 
     /**
      *  server-assigned and channel specific delivery tag
@@ -43,21 +49,56 @@ private:
 
     /**
      *  indicates whether the message has been previously delivered to this (or another) client
-     *  @var BooleanSet
+     *  @var bool
      */
-    BooleanSet _redelivered;
+    bool _redelivered;
 
     /**
      *  the name of the exchange to publish to. An empty exchange name means the default exchange.
-     *  @var ShortString
+     *  @var StringView
      */
-    ShortString _exchange;
+    StringView _exchange;
 
     /**
      *  Message routing key
-     *  @var ShortString
+     *  @var StringView
+     */
+    StringView _routingKey;
+
+    /**
+     *  Decode a short string from the received data
+     *  @param  data        the received data
+     *  @param  size        size of the received data
+     *  @param  pos         position of the string, updated to the position after it
+     *  @return StringView
+     *  @throws ProtocolException   if the string does not fit in the data
+     */
+    static StringView decode(const char *data, size_t size, size_t &pos)
+    {
+        // the size byte must fit, and the string itself too
+        if (pos >= size || pos + 1 + (uint8_t)data[pos] > size) throw ProtocolException("frame out of range");
+
+        // the view on the string
+        StringView result(data + pos + 1, (uint8_t)data[pos]);
+
+        // move on to the next field
+        pos += 1 + result.size();
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Encode a short string
+     *  @param  buffer      buffer to write to
+     *  @param  view        the string to write
      */
-    ShortString _routingKey;
+    static void encode(OutBuffer &buffer, const StringView &view)
+    {
+        // the size, followed by the data
+        buffer.add((uint8_t)view.size());
+        buffer.add(view.data(), view.size());
+    }
 
 protected:
     /**
@@ -69,11 +110,11 @@ protected:
     {
         BasicFrame::fill(buffer);
 
-        _consumerTag.fill(buffer);
+        encode(buffer, _consumerTag);
         buffer.add(_deliveryTag);
-        _redelivered.fill(buffer);
-        _exchange.fill(buffer);
-        _routingKey.fill(buffer);
+        buffer.add((uint8_t)(_redelivered ? 1 : 0));
+        encode(buffer, _exchange);
+        encode(buffer, _routingKey);
     }
 
 public:
@@ -90,26 +131,48 @@ public:
     BasicDeliverFrame(uint16_t channel, const std::string& consumerTag, uint64_t deliveryTag, bool redelivered = false, const std::string& exchange = "", const std::string& routingKey = "") :
         BasicFrame(channel, (uint32_t)(consumerTag.length() + exchange.length() + routingKey.length() + 12)),
             // length of strings + 1 byte per string for stringsize, 8 bytes for uint64_t and 1 for bools
-        _consumerTag(consumerTag),
+        _storage(consumerTag + exchange + routingKey),
+        _consumerTag(_storage.data(), consumerTag.size()),
         _deliveryTag(deliveryTag),
         _redelivered(redelivered),
-        _exchange(exchange),
-        _routingKey(routingKey)
+        _exchange(_storage.data() + consumerTag.size(), exchange.size()),
+        _routingKey(_storage.data() + consumerTag.size() + exchange.size(), routingKey.size())
     {}
 
     /**
      *  Construct a basic deliver frame from a received frame
      *
+     *  The strings are not copied, they refer to the received data, and are
+     *  therefore only valid for as long as the frame is being processed.
+     *
      *  @param  frame   received frame
      */
     BasicDeliverFrame(ReceivedFrame &frame) :
-        BasicFrame(frame),
-        _consumerTag(frame),
-        _deliveryTag(frame.nextUint64()),
-        _redelivered(frame),
-        _exchange(frame),
-        _routingKey(frame)
-    {}
+        BasicFrame(frame)
+    {
+        // the rest of the frame holds the fields, we fetch it in one go so that
+        // the views remain valid even if the buffer is not contiguous
+        size_t size = frame.remaining(), pos = 0;
+        const char *data = frame.nextData((uint32_t)size);
+
+        // the consumer tag comes first
+        _consumerTag = decode(data, size, pos);
+
+        // followed by the delivery tag and the redelivered bit
+        if (pos + 9 > size) throw ProtocolException("frame out of range");
+
+        // decode the delivery tag
+        memcpy(&_deliveryTag, data + pos, sizeof(uint64_t));
+        _deliveryTag = be64toh(_deliveryTag);
+
+        // the redelivered flag is the first bit of the next octet
+        _redelivered = (data[pos + 8] & 1) != 0;
+        pos += 9;
+
+        // followed by the exchange and routing key
+        _exchange = decode(data, size, pos);
+        _routingKey = decode(data, size, pos);
+    }
 
     /**
      *  Destructor
@@ -120,7 +183,7 @@ public:
      *  Return the name of the exchange to publish to
      *  @return  string
      */
-    const std::string& exchange() const
+    const StringView &exchange() const
     {
         return _exchange;
     }
@@ -129,7 +192,7 @@ public:
      *  Return the routing key
      *  @return  string
      */
-    const std::string& routingKey() const
+    const StringView &routingKey() const
     {
         return _routingKey;
     }
@@ -167,7 +230,7 @@ public:
      *  Return the identifier for the consumer (channel specific)
      *  @return  string
      */
-    const std::string& consumerTag() const
+    const StringView &consumerTag() const
     {
         return _consumerTag;
     }
@@ -178,7 +241,7 @@ public:
      */
     bool redelivered() const
     {
-        return _redelivered.get(0);
+        return _redelivered;
     }
 
     /**
@@ -195,7 +258,7 @@ public:
         if (!channel) return false;
 
         // get the appropriate consumer object
-        auto consumer = channel->consumer(_consumerTag);
+        auto consumer = channel->consumer(_consumerTag.data(), _consumerTag.size());
 
         // skip if there was no consumer for this tag
         if (consumer == nullptr) return false;
@@ -180,7 +180,7 @@ public:
         if (receiver == nullptr) return false;
 
         // initialize the receiver for the upcoming message
-        receiver->initialize(_exchange, _routingKey);
+        receiver->initialize(StringView(_exchange.value()), StringView(_routingKey.value()));
 
         // done
         return true;
@@ -28,6 +28,7 @@
 #include "queuepurgeframe.h"
 #include "queuedeleteframe.h"
 #include "basicpublishframe.h"
+#include "templateframe.h"
 #include "basicheaderframe.h"
 #include "bodyframe.h"
 #include "basicqosframe.h"
@@ -488,34 +489,119 @@ DeferredDelete &ChannelImpl::removeQueue(const std::string &name, int flags)
  */
 DeferredPublisher &ChannelImpl::publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags)
 {
+    // make sure we have a deferred object to return
+    if (!_publisher) _publisher.reset(new DeferredPublisher(this));
+
+    // send the message (a message that can not be sent is dropped, like before)
+    send(exchange, routingKey, envelope, flags);
+
+    // done
+    return *_publisher;
+}
+
+/**
+ *  Publish a message using a publish template
+ *
+ *  The method frame and header frame are copied from the template, only the
+ *  channel id and the body size are filled in.
+ *
+ *  @param  tpl         the publish template
+ *  @param  data        the message body
+ *  @param  size        size of the message body
+ *  @return DeferredPublisher
+ */
+DeferredPublisher &ChannelImpl::publish(const PublishTemplate &tpl, const char *data, uint64_t size)
+{
+    // make sure we have a deferred object to return
+    if (!_publisher) _publisher.reset(new DeferredPublisher(this));
+
+    // send the message (a message that can not be sent is dropped, like before)
+    send(tpl, data, size);
+
+    // done
+    return *_publisher;
+}
+
+/**
+ *  Send a message to an exchange, and report whether it was sent
+ *
+ *  @param  exchange    the exchange to publish to
+ *  @param  routingkey  the routing key
+ *  @param  envelope    the full envelope to send
+ *  @param  flags       optional flags
+ *  @return bool
+ */
+bool ChannelImpl::send(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags)
+{
+    // send the method frame, the header frame and the body
+    return send(BasicPublishFrame(_id, exchange, routingKey, (flags & mandatory) != 0, (flags & immediate) != 0), BasicHeaderFrame(_id, envelope), envelope.body(), envelope.bodySize());
+}
+
+/**
+ *  Send a message using a publish template, and report whether it was sent
+ *
+ *  The method frame and header frame are copied from the template, only the
+ *  channel id and the body size are filled in.
+ *
+ *  @param  tpl         the publish template
+ *  @param  data        the message body
+ *  @param  size        size of the message body
+ *  @return bool
+ */
+bool ChannelImpl::send(const PublishTemplate &tpl, const char *data, uint64_t size)
+{
+    // the body size is stored after the frame header (7 bytes), the class id and the weight (2 bytes each)
+    TemplateFrame method(tpl._data.data(), tpl._split, _id);
+    TemplateFrame header(tpl._data.data() + tpl._split, (uint32_t)(tpl._data.size() - tpl._split), _id, 11, size);
+
+    // send the method frame, the header frame and the body
+    return send(method, header, data, size);
+}
+
+/**
+ *  Send a message given the method frame and the header frame
+ *
+ *  @param  method      the method frame
+ *  @param  header      the header frame
+ *  @param  data        the message body
+ *  @param  size        size of the message body
+ *  @return bool        was the message sent?
+ */
+bool ChannelImpl::send(const Frame &method, const Frame &header, const char *data, uint64_t size)
+{
+    // skip if channel is not connected
+    if (_state == state_closed || !_connection) return false;
+
+    // frames that are bigger than the max frame size can not be sent, and we check this
+    // before anything is sent, so that the server never sees a part of the message
+    if (method.totalSize() > _connection->maxFrame() || header.totalSize() > _connection->maxFrame()) return false;
+
     // we are going to send out multiple frames, each one will trigger a call to the handler,
     // which in turn could destruct the channel object, we need to monitor that
     Monitor monitor(this);
 
-    // @todo do not copy the entire buffer to individual frames
-    
-    // make sure we have a deferred object to return
-    if (!_publisher) _publisher.reset(new DeferredPublisher(this));
+    // if nothing is waiting to be sent, all frames can be passed to the handler in one
+    // go, and the body of the message does not have to be copied into the frames
+    if (usable() && !waiting() && _connection->passthrough()) return gather(method, header, data, size);
 
     // send the publish frame
-    if (!send(BasicPublishFrame(_id, exchange, routingKey, (flags & mandatory) != 0, (flags & immediate) != 0))) return *_publisher;
+    if (!send(method)) return false;
 
     // channel still valid?
-    if (!monitor.valid()) return *_publisher;
+    if (!monitor.valid()) return false;
 
     // send header
-    if (!send(BasicHeaderFrame(_id, envelope))) return *_publisher;
+    if (!send(header)) return false;
 
     // channel and connection still valid?
-    if (!monitor.valid() || !_connection) return *_publisher;
+    if (!monitor.valid() || !_connection) return false;
 
     // the max payload size is the max frame size minus the bytes for headers and trailer
     uint32_t maxpayload = _connection->maxPayload();
     uint64_t bytessent = 0;
 
-    // the buffer
-    const char *data = envelope.body();
-    uint64_t bytesleft = envelope.bodySize();
+    // the number of bytes that still have to be sent
+    uint64_t bytesleft = size;
 
     // split up the body in multiple frames depending on the max frame size
     while (bytesleft > 0)
@@ -524,10 +610,10 @@ DeferredPublisher &ChannelImpl::publish(const std::string &exchange, const std::
         uint64_t chunksize = std::min(static_cast<uint64_t>(maxpayload), bytesleft);
 
         // send out a body frame
-        if (!send(BodyFrame(_id, data + bytessent, (uint32_t)chunksize))) return *_publisher;
+        if (!send(BodyFrame(_id, data + bytessent, (uint32_t)chunksize))) return false;
 
         // channel still valid?
-        if (!monitor.valid()) return *_publisher;
+        if (!monitor.valid()) return false;
 
         // update counters
         bytessent += chunksize;
@@ -535,7 +621,49 @@ DeferredPublisher &ChannelImpl::publish(const std::string &exchange, const std::
     }
 
     // done
-    return *_publisher;
+    return true;
+}
+
+/**
+ *  Send a message by passing all frames to the handler in a single call
+ *
+ *  The method and header frame, and the headers and trailers of the body frames
+ *  are copied into a gather buffer, but the body itself is only referenced. This
+ *  only works if the connection can pass on the data right away.
+ *
+ *  @param  method      the method frame
+ *  @param  header      the header frame
+ *  @param  data        the message body
+ *  @param  size        size of the message body
+ *  @return bool        was the message sent?
+ */
+bool ChannelImpl::gather(const Frame &method, const Frame &header, const char *data, uint64_t size)
+{
+    // frames that are bigger than the max frame size can not be sent
+    if (method.totalSize() > _connection->maxFrame() || header.totalSize() > _connection->maxFrame()) return false;
+
+    // the max payload size is the max frame size minus the bytes for headers and trailer
+    uint32_t maxpayload = _connection->maxPayload();
+
+    // the buffer that will refer to the body
+    GatherBuffer buffer(data, size, size / maxpayload + 3);
+
+    // add the method and header frame
+    buffer.add(method);
+    buffer.add(header);
+
+    // split up the body in multiple frames depending on the max frame size
+    for (uint64_t bytessent = 0; bytessent < size; bytessent += maxpayload)
+    {
+        // size of this chunk
+        uint64_t chunksize = std::min(static_cast<uint64_t>(maxpayload), size - bytessent);
+
+        // add the body frame (the payload is not copied)
+        buffer.add(BodyFrame(_id, data + bytessent, (uint32_t)chunksize));
+    }
+
+    // pass everything to the connection
+    return _connection->send(buffer);
 }
 
 /**
@@ -550,10 +678,56 @@ DeferredPublisher &ChannelImpl::publish(const std::string &exchange, const std::
  */
 Deferred &ChannelImpl::setQos(uint16_t prefetchCount, bool global)
 {
+    // the prefetch count is no longer adjusted at runtime
+    _qos.reset();
+    _requalify = false;
+
     // send a qos frame
     return push(BasicQosFrame(_id, prefetchCount, global));
 }
 
+/**
+ *  Adjust the prefetch count at runtime
+ *
+ *  The prefetch count applies to the entire channel (the "global" bit is set),
+ *  because RabbitMQ only applies a new per-consumer limit to consumers that
+ *  are started later on.
+ *
+ *  @param  minimum     the lowest prefetch count (this is where we start)
+ *  @param  maximum     the highest prefetch count
+ */
+void ChannelImpl::adaptQos(uint16_t minimum, uint16_t maximum)
+{
+    // create the controller
+    _qos.reset(new QosController(minimum, maximum));
+
+    // send the initial prefetch count
+    push(BasicQosFrame(_id, _qos->prefetch(), true));
+}
+
+/**
+ *  Let the prefetch controller know that messages were acked or rejected
+ *  @param  deliveryTag     the delivery tag
+ *  @param  flags           the flags of the ack or reject
+ */
+void ChannelImpl::settled(uint64_t deliveryTag, int flags)
+{
+    // skip if the controller did not change the prefetch count
+    if (!_qos->settled(deliveryTag, (flags & multiple) != 0)) return;
+
+    // skip if the new prefetch count was already held back (it is read when it is sent)
+    if (_requalify) return;
+
+    // the prefetch count is sent with a synchronous frame, and all frames that are sent after it
+    // have to wait until the server has confirmed it, so we hold it back until the acks of the
+    // messages that are being processed have been sent (if acks are held back, the connection
+    // already knows that it should flush this channel)
+    if ((_acks && _acks->pending() > 0) || _connection->defer(this)) { _requalify = true; return; }
+
+    // send the new prefetch count right away
+    push(BasicQosFrame(_id, _qos->prefetch(), true));
+}
+
 /**
  *  Tell the RabbitMQ server that we're ready to consume messages
  *  @param  queue               the queue from which you want to consume
@@ -580,7 +754,7 @@ DeferredConsumer& ChannelImpl::consume(const std::string &queue, const std::stri
     BasicConsumeFrame frame(_id, queue, tag, (flags & nolocal) != 0, (flags & noack) != 0, (flags & exclusive) != 0, false, arguments);
 
     // send the frame, and create deferred object
-    auto deferred = std::make_shared<DeferredConsumer>(this, !send(frame));
+    auto deferred = std::make_shared<DeferredConsumer>(this, !send(frame), (flags & noack) != 0);
 
     // push to list
     push(deferred);
@@ -659,7 +833,7 @@ DeferredGet &ChannelImpl::get(const std::string &queue, int flags)
     BasicGetFrame frame(_id, queue, (flags & noack) != 0);
     
     // send the frame, and create deferred object
-    auto deferred = std::make_shared<DeferredGet>(this, !send(frame));
+    auto deferred = std::make_shared<DeferredGet>(this, !send(frame), (flags & noack) != 0);
 
     // push to list
     push(deferred);
@@ -676,8 +850,25 @@ DeferredGet &ChannelImpl::get(const std::string &queue, int flags)
  */
 bool ChannelImpl::ack(uint64_t deliveryTag, int flags)
 {
-    // send an ack frame
-    return send(BasicAckFrame(_id, deliveryTag, (flags & multiple) != 0));
+    // skip if channel is not connected
+    if (_state == state_closed || !_connection) return false;
+
+    // a single ack can be held back, otherwise it is sent right away
+    bool held = _acks && (flags & multiple) == 0 && _acks->ack(deliveryTag);
+
+    // an ack that is sent right away also settles the acks that it covers
+    if (_acks && !held) _acks->settle(deliveryTag, (flags & multiple) != 0);
+
+    // hold back the ack, or send an ack frame
+    bool result = held ? hold() : send(BasicAckFrame(_id, deliveryTag, (flags & multiple) != 0));
+
+    // the prefetch controller learns that messages were processed (after the ack was sent,
+    // because a new prefetch count is sent with a synchronous frame, and frames that are
+    // sent after it have to wait until the server has confirmed it)
+    if (_qos) settled(deliveryTag, flags);
+
+    // done
+    return result;
 }
 
 /**
@@ -688,17 +879,103 @@ bool ChannelImpl::ack(uint64_t deliveryTag, int flags)
  */
 bool ChannelImpl::reject(uint64_t deliveryTag, int flags)
 {
+    // acks that are held back must go first, a multiple nack would otherwise cover them
+    if (_acks && (flags & multiple) && !flushAcks()) return false;
+
+    // the message is no longer outstanding
+    if (_acks) _acks->settle(deliveryTag, (flags & multiple) != 0);
+
+    // was the frame sent?
+    bool result;
+
     // should we reject multiple messages?
     if (flags & multiple)
     {
         // send a nack frame
-        return send(BasicNackFrame(_id, deliveryTag, true, (flags & requeue) != 0));
+        result = send(BasicNackFrame(_id, deliveryTag, true, (flags & requeue) != 0));
     }
     else
     {
         // send a reject frame
-        return send(BasicRejectFrame(_id, deliveryTag, (flags & requeue) != 0));
+        result = send(BasicRejectFrame(_id, deliveryTag, (flags & requeue) != 0));
     }
+
+    // the prefetch controller learns that messages were processed (after the frame was sent,
+    // so that it does not have to wait for the server to confirm a new prefetch count)
+    if (_qos) settled(deliveryTag, flags);
+
+    // done
+    return result;
+}
+
+/**
+ *  Coalesce acknowledgements
+ *
+ *  Acks are held back until the connection is done parsing the data that it is
+ *  processing, until the threshold is reached, or until a synchronous frame is sent.
+ *  Acks for a run of messages are then combined into a single frame.
+ *
+ *  @param  threshold           max number of acks to hold back (0 to send them right away)
+ */
+void ChannelImpl::coalesceAcks(size_t threshold)
+{
+    // if the window already exists, we only change the threshold
+    if (_acks && threshold > 0) return _acks->threshold(threshold);
+
+    // if there is no window yet, we create one (from now on we keep track of the deliveries)
+    if (threshold > 0) { _acks.reset(new AckWindow(_delivered, threshold)); return; }
+
+    // coalescing is switched off, the acks that are held back are sent first
+    flushAcks();
+
+    // the window is no longer needed
+    _acks.reset();
+}
+
+/**
+ *  Send out the acknowledgements (and the new prefetch count) that are held back
+ *  @return bool
+ */
+bool ChannelImpl::flushAcks()
+{
+    // was everything sent?
+    bool result = true;
+
+    // send all ack frames
+    if (_acks) _acks->flush([this, &result](uint64_t deliveryTag, bool multiple) {
+
+        // send the ack frame
+        result = send(BasicAckFrame(_id, deliveryTag, multiple)) && result;
+    });
+
+    // skip if no new prefetch count was held back
+    if (!_requalify) return result;
+
+    // it is no longer held back
+    _requalify = false;
+
+    // send the new prefetch count (unless the prefetch count was fixed in the meantime)
+    if (_qos) push(BasicQosFrame(_id, _qos->prefetch(), true));
+
+    // done
+    return result;
+}
+
+/**
+ *  Hold back an ack that was registered in the window
+ *  @return bool
+ */
+bool ChannelImpl::hold()
+{
+    // if the threshold is reached, we send all acks
+    if (_acks->pending() >= _acks->threshold()) return flushAcks();
+
+    // the connection sends out the acks when it has time (this is only needed for the first one,
+    // and not at all if a new prefetch count is already held back)
+    if (_acks->pending() > 1 || _requalify || _connection->defer(this)) return true;
+
+    // the connection can not hold back frames, so we send it right away
+    return flushAcks();
 }
 
 /**
@@ -710,6 +987,12 @@ bool ChannelImpl::reject(uint64_t deliveryTag, int flags)
  */
 Deferred &ChannelImpl::recover(int flags)
 {
+    // acks that are held back must go first, or the messages would be redelivered
+    flushAcks();
+
+    // the messages that are not yet acked are redelivered, so the controller can forget them
+    if (_qos) _qos->clear();
+
     // send a nack frame
     return push(BasicRecoverFrame(_id, (flags & requeue) != 0));
 }
@@ -729,6 +1012,9 @@ bool ChannelImpl::send(const Frame &frame)
     // added to the list of deferred objects. it will be notified about
     // the error when the close operation succeeds
     if (_state == state_closing) return true;
+
+    // acks that are held back are sent before a synchronous frame
+    if (_acks && _acks->pending() > 0 && frame.synchronous() && !flushAcks()) return false;
     
     // are we currently in synchronous mode or are there
     // other frames waiting for their turn to be sent?
@@ -736,7 +1022,7 @@ bool ChannelImpl::send(const Frame &frame)
     {
         // we need to wait until the synchronous frame has
         // been processed, so queue the frame until it was
-        _queue.emplace(frame.synchronous(), frame);
+        _queue.emplace(frame.synchronous(), CopiedBuffer(frame, _connection->allocator()));
 
         // it was of course not actually sent but we pretend
         // that it was, because no error occured
@@ -840,6 +1126,19 @@ void ChannelImpl::reportError(const char *message, bool notifyhandler)
     // all callbacks have been processed, so we also can reset the pointer to the newest
     _newestCallback = nullptr;
 
+    // messages that were published in confirm mode, but that were not yet confirmed, are lost
+    if (_confirm)
+    {
+        // the channel is no longer in confirm mode (this also prevents that this is reported twice)
+        auto confirm = std::move(_confirm);
+
+        // report the lost messages
+        confirm->reportLost(message);
+
+        // leap out if channel no longer exists
+        if (!monitor.valid()) return;
+    }
+
     // inform handler
     if (notifyhandler && _errorCallback) _errorCallback(message);
 
@@ -853,17 +1152,32 @@ void ChannelImpl::reportError(const char *message, bool notifyhandler)
 }
 
 /**
- *  Get the current receiver for a given consumer tag
- *  @param  consumertag     the consumer frame
- *  @return DeferredConsumer
+ *  The allocator for message bodies
+ *  @return Allocator
  */
-DeferredConsumer *ChannelImpl::consumer(const std::string &consumertag) const
+Allocator *ChannelImpl::allocator() const
 {
-    // look in the map
-    auto iter = _consumers.find(consumertag);
-    
-    // return the result
-    return iter == _consumers.end() ? nullptr : iter->second.get();
+    // use the allocator of the connection, if we still have one
+    return _connection ? _connection->allocator() : Allocator::standard();
+}
+
+/**
+ *  Let the connection report the batch of a consumer when it is done parsing
+ *  @param  consumer        The consumer object
+ */
+void ChannelImpl::batch(const std::shared_ptr<DeferredConsumer> &consumer)
+{
+    // pass on to the connection (if we still have one)
+    if (_connection) _connection->batch(consumer);
+}
+
+/**
+ *  Pause the connection, because a sink can not keep up with the incoming data
+ */
+void ChannelImpl::throttle()
+{
+    // pass on to the connection (if we still have one)
+    if (_connection) _connection->pause();
 }
 
 /**
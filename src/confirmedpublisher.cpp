@@ -0,0 +1,216 @@
+/**
+ *  ConfirmedPublisher.cpp
+ *
+ *  Implementation of the ConfirmedPublisher class
+ *
+ *  @copyright 2018 Copernica BV
+ */
+#include "includes.h"
+#include <algorithm>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Constructor
+ *  @param  channel     the channel to publish over
+ *  @param  window      max number of unconfirmed messages
+ */
+ConfirmedPublisher::ConfirmedPublisher(Channel &channel, size_t window) :
+    _implementation(channel._implementation),
+    _window(window)
+{
+    // the callbacks may outlive the publisher, so they need a monitor
+    Monitor monitor(this);
+
+    // put the channel in confirm mode
+    _implementation->confirmSelect()
+        .onAck([monitor, this](uint64_t deliveryTag, bool multiple) {
+            // process the ack if the publisher still exists
+            if (monitor.valid()) process(deliveryTag, multiple, true);
+        })
+        .onNack([monitor, this](uint64_t deliveryTag, bool multiple, bool) {
+            // process the nack if the publisher still exists
+            if (monitor.valid()) process(deliveryTag, multiple, false);
+        })
+        .onLost([monitor, this](const char *message) {
+            // report the lost messages if the publisher still exists
+            if (monitor.valid()) lost(message);
+        });
+}
+
+/**
+ *  Add a message to the administration, after it was published
+ *  @return DeferredPublish
+ */
+DeferredPublish &ConfirmedPublisher::add()
+{
+    // is the ring full?
+    if (unconfirmed() >= _ring.size())
+    {
+        // create a ring that is twice as big
+        std::vector<std::shared_ptr<DeferredPublish>> ring(std::max(_ring.size() * 2, (size_t)16));
+
+        // move the unconfirmed messages to their slot in the new ring
+        for (uint64_t tag = _oldest; tag < _next; ++tag) ring[tag & (ring.size() - 1)] = std::move(slot(tag));
+
+        // use the new ring from now on
+        _ring.swap(ring);
+    }
+
+    // the slot for the message
+    auto &deferred = slot(_next++);
+
+    // create the object for this message
+    deferred = std::make_shared<DeferredPublish>();
+
+    // done
+    return *deferred;
+}
+
+/**
+ *  Return an object for a message that could not be published
+ *  @return DeferredPublish
+ */
+DeferredPublish &ConfirmedPublisher::reject()
+{
+    // create an object in a failed state
+    _rejected = std::make_shared<DeferredPublish>(true);
+
+    // done
+    return *_rejected;
+}
+
+/**
+ *  Process an ack or nack from the server
+ *  @param  tag         the delivery tag
+ *  @param  multiple    does it apply to all messages up to and including the tag?
+ *  @param  ack         was it an ack?
+ */
+void ConfirmedPublisher::process(uint64_t tag, bool multiple, bool ack)
+{
+    // ignore tags of messages that are already confirmed, or that were never published
+    if (tag < _oldest || tag >= _next) return;
+
+    // was the window full before the messages were confirmed?
+    bool wasfull = full();
+
+    // the callbacks could destruct the publisher
+    Monitor monitor(this);
+
+    // the first message that is confirmed
+    uint64_t current = multiple ? _oldest : tag;
+
+    // walk over the messages that are confirmed
+    while (current <= tag)
+    {
+        // take the message out of the ring (the slot is empty if it was already confirmed)
+        auto deferred = std::move(slot(current));
+
+        // move the start of the window to the oldest message that is not yet confirmed
+        while (_oldest < _next && !slot(_oldest)) ++_oldest;
+
+        // messages before the start of the window are already confirmed
+        current = std::max(current + 1, _oldest);
+
+        // skip empty slots
+        if (!deferred) continue;
+
+        // report the result
+        if (ack) deferred->reportAck();
+        else deferred->reportNack();
+
+        // we no longer need the object (this calls the finalize callback)
+        deferred.reset();
+
+        // leap out if the publisher no longer exists
+        if (!monitor.valid()) return;
+    }
+
+    // notify the user if there is room in the window again
+    if (wasfull && !full() && _availableCallback) _availableCallback();
+}
+
+/**
+ *  Report that all unconfirmed messages are lost
+ *  @param  message     the reason why the channel failed
+ */
+void ConfirmedPublisher::lost(const char *message)
+{
+    // no more messages can be published
+    _failed = true;
+
+    // the callbacks could destruct the publisher
+    Monitor monitor(this);
+
+    // walk over the messages that are not yet confirmed
+    while (_oldest < _next)
+    {
+        // take the message out of the ring
+        auto deferred = std::move(slot(_oldest++));
+
+        // skip empty slots
+        if (!deferred) continue;
+
+        // report the lost message
+        deferred->reportLost(message);
+
+        // we no longer need the object (this calls the finalize callback)
+        deferred.reset();
+
+        // leap out if the publisher no longer exists
+        if (!monitor.valid()) return;
+    }
+}
+
+/**
+ *  Publish a message to an exchange
+ *  @param  exchange    the exchange to publish to
+ *  @param  routingkey  the routing key
+ *  @param  envelope    the full envelope to send
+ *  @param  flags       optional flags
+ *  @return DeferredPublish
+ */
+DeferredPublish &ConfirmedPublisher::publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags)
+{
+    // the message can not be published if the window is full, or when the channel failed
+    if (_failed || full() || !_implementation->usable()) return reject();
+
+    // publish the message (a message that is not sent does not get a delivery tag)
+    if (!_implementation->send(exchange, routingKey, envelope, flags)) return reject();
+
+    // the channel may have failed while the message was sent
+    if (_failed) return reject();
+
+    // add the message to the administration
+    return add();
+}
+
+/**
+ *  Publish a message using a publish template
+ *  @param  tpl         the publish template
+ *  @param  message     the message to send
+ *  @param  size        size of the message
+ *  @return DeferredPublish
+ */
+DeferredPublish &ConfirmedPublisher::publish(const PublishTemplate &tpl, const char *message, size_t size)
+{
+    // the message can not be published if the window is full, or when the channel failed
+    if (_failed || full() || !_implementation->usable()) return reject();
+
+    // publish the message (a message that is not sent does not get a delivery tag)
+    if (!_implementation->send(tpl, message, size)) return reject();
+
+    // the channel may have failed while the message was sent
+    if (_failed) return reject();
+
+    // add the message to the administration
+    return add();
+}
+
+/**
+ *  End of namespace
+ */
+}
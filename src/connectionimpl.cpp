@@ -107,63 +107,182 @@ void ConnectionImpl::remove(const ChannelImpl *channel)
  *  @return             number of bytes that were processed
  */
 uint64_t ConnectionImpl::parse(const Buffer &buffer)
+{
+    // create a monitor object that checks if the connection still exists
+    Monitor monitor(this);
+
+    // we are busy parsing (frames that are held back are sent when we're done)
+    _parsing = true;
+
+    // process the frames
+    auto processed = receive(buffer);
+
+    // consumers that collect messages in batches can now report them
+    for (size_t i = 0; i < _batches.size() && monitor.valid(); ++i) _batches[i]->flush();
+
+    // leap out if the connection was destructed
+    if (!monitor.valid()) return processed;
+
+    // the batches have been reported
+    _batches.clear();
+
+    // we're done parsing
+    _parsing = false;
+
+    // send out the frames that were held back
+    flush();
+
+    // done
+    return processed;
+}
+
+/**
+ *  Let a channel send out the frames that it holds back at a later time
+ *  @param  channel
+ *  @return bool        false if the frames can not be held back
+ */
+bool ConnectionImpl::defer(const ChannelImpl *channel)
+{
+    // remember the channel
+    _pending.push_back(channel->id());
+
+    // if we are parsing, the frames are sent when we're done, and if there already were
+    // channels with pending frames, the handler already knows that it has to flush
+    if (_parsing || _pending.size() > 1) return true;
+
+    // ask the handler if it is going to call flush()
+    if (_handler->onPending(_parent)) return true;
+
+    // the frames can not be held back
+    _pending.clear();
+
+    // done
+    return false;
+}
+
+/**
+ *  Send out the frames that are held back by the channels
+ */
+void ConnectionImpl::flush()
+{
+    // create a monitor object that checks if the connection still exists
+    Monitor monitor(this);
+
+    // let all channels send out their frames (the channel could be gone already)
+    for (size_t i = 0; i < _pending.size(); ++i)
+    {
+        // find the channel
+        auto channel = this->channel(_pending[i]);
+
+        // send out its acks
+        if (channel) channel->flushAcks();
+
+        // leap out if the connection was destructed
+        if (!monitor.valid()) return;
+    }
+
+    // nothing is pending anymore
+    _pending.clear();
+}
+
+/**
+ *  Process the frames in a buffer
+ *
+ *  The data is processed in batches: the frame boundaries of the next group
+ *  of complete frames are first looked up in one scan over the headers, and
+ *  then these frames are processed one after the other. If the data is stored
+ *  in contiguous memory, the frames are decoded straight from that memory.
+ *
+ *  @param  buffer      buffer to decode
+ *  @return uint64_t    number of bytes that were processed
+ */
+uint64_t ConnectionImpl::receive(const Buffer &buffer)
 {
     // do not parse if already in an error state
     if (_state == state_closed) return 0;
 
-    // number of bytes processed
+    // number of bytes processed, and the number of bytes available
     uint64_t processed = 0;
+    uint64_t size = buffer.size();
+
+    // the data, if it is stored in contiguous memory
+    const char *data = buffer.contiguous(0, (size_t)size);
+
+    // sizes of the frames in the current batch
+    uint64_t frames[256];
 
     // create a monitor object that checks if the connection still exists
     Monitor monitor(this);
 
-    // keep looping until we have processed all bytes, and the monitor still
-    // indicates that the connection is in a valid state
-    while (processed < buffer.size() && monitor.valid())
+    // prevent protocol exceptions
+    try
     {
-        // prevent protocol exceptions
-        try
+        // keep looping until we have processed all bytes, and the monitor still
+        // indicates that the connection is in a valid state
+        while (processed < size && monitor.valid() && !_paused)
         {
-            // try to recognize the frame
-            ReducedBuffer reduced_buf(buffer, (size_t)processed);
-            ReceivedFrame receivedFrame(reduced_buf, _maxFrame);
-            
-            // do we have the full frame?
-            if (receivedFrame.complete())
+            // number of frames in this batch, and their combined size
+            size_t count = 0;
+            uint64_t total = 0;
+
+            // find the boundaries of the complete frames that follow
+            while (count < 256 && processed + total + 7 <= size)
             {
-                // process the frame
-                receivedFrame.process(this);
+                // the payload size is stored at offset 3 of the header
+                uint32_t payload;
+                if (data) memcpy(&payload, data + processed + total + 3, sizeof(uint32_t));
+                else buffer.copy((size_t)(processed + total + 3), sizeof(uint32_t), &payload);
 
-                // number of bytes processed
-                uint64_t bytes = receivedFrame.totalSize();
+                // size of the frame (payload + header + end-of-frame byte)
+                uint64_t bytes = (uint64_t)be32toh(payload) + 8;
 
-                // add bytes
-                processed += bytes;
+                // stop if the frame is incomplete
+                if (processed + total + bytes > size) break;
+
+                // store the frame size
+                frames[count++] = bytes;
+                total += bytes;
             }
-            else
+
+            // process the frames that were found
+            for (size_t i = 0; i < count && monitor.valid() && !_paused; ++i)
             {
-                // we do not yet have the complete frame, but if we do at least 
-                // have the initial bytes of the header, we already know how much 
-                // data we need for the next frame, otherwise we need at least 7
-                // bytes for processing the header of the next frame
-                _expected = receivedFrame.header() ? (uint32_t)receivedFrame.totalSize() : 7;
-                
-                // we're ready for now
-                return processed;
+                // recognize the frame (this also checks the end-of-frame marker) and process it
+                if (data) ReceivedFrame(ByteBuffer(data + processed, (size_t)frames[i]), _maxFrame).process(this);
+                else ReceivedFrame(ReducedBuffer(buffer, (size_t)processed), _maxFrame).process(this);
+
+                // add bytes
+                processed += frames[i];
             }
-        }
-        catch (const ProtocolException &exception)
-        {
-            // something terrible happened on the protocol (like data out of range)
-            reportError(exception.what());
 
-            // done
+            // if the batch was full we simply go on with the next batch
+            if (count == 256 || processed >= size || !monitor.valid() || _paused) continue;
+
+            // we do not yet have the complete next frame, but we parse the partial
+            // frame to find out how much data is needed (or to report a frame that
+            // exceeds the max frame size)
+            ReducedBuffer reduced(buffer, (size_t)processed);
+            ReceivedFrame receivedFrame(reduced, _maxFrame);
+
+            // if we do at least have the initial bytes of the header, we already know how
+            // much data we need for the next frame, otherwise we need at least 7 bytes
+            _expected = receivedFrame.header() ? (uint32_t)receivedFrame.totalSize() : 7;
+
+            // we're ready for now
             return processed;
         }
     }
+    catch (const ProtocolException &exception)
+    {
+        // something terrible happened on the protocol (like data out of range)
+        reportError(exception.what());
 
-    // leap out if the connection object no longer exists
-    if (!monitor.valid()) return processed;
+        // done
+        return processed;
+    }
+
+    // leap out if the connection object no longer exists, or if processing was paused
+    if (!monitor.valid() || _paused) return processed;
 
     // the entire buffer has been processed, the next call to parse() should at least
     // contain the size of the frame header to be meaningful for the amqp-cpp library
@@ -180,6 +299,27 @@ uint64_t ConnectionImpl::parse(const Buffer &buffer)
     return processed;
 }
 
+/**
+ *  Memory where the payload of a body frame is going to be stored
+ *  @param  channel     channel number from the frame header
+ *  @param  size        payload size from the frame header
+ *  @return char*       pointer to the memory, or nullptr if not available
+ */
+char *ConnectionImpl::destination(uint16_t channel, uint32_t size)
+{
+    // find the channel
+    auto iter = _channels.find(channel);
+    
+    // leap out if there is no such channel
+    if (iter == _channels.end()) return nullptr;
+
+    // the object that is receiving a message
+    auto *receiver = iter->second->receiver();
+
+    // ask the receiver
+    return receiver ? receiver->destination(size) : nullptr;
+}
+
 /**
  *  Fail all open channels, helper method
  *  @param  monitor     object to check if object still exists
@@ -400,7 +540,7 @@ bool ConnectionImpl::send(const Frame &frame)
     else
     {
         // the connection is still being set up, so we need to delay the message sending
-        _queue.emplace(frame);
+        _queue.emplace(frame, _allocator);
     }
 
     // done
@@ -433,6 +573,24 @@ bool ConnectionImpl::send(CopiedBuffer &&buffer)
     return true;
 }
 
+/**
+ *  Send a group of frames over the connection in a single call to the handler
+ *
+ *  @param  buffer      the segments with data to send
+ *  @return bool
+ */
+bool ConnectionImpl::send(const GatherBuffer &buffer)
+{
+    // the buffer refers to external data, so it can not be queued
+    if (!passthrough()) return false;
+
+    // pass all segments to the handler
+    _handler->onData(_parent, buffer);
+
+    // done
+    return true;
+}
+
 /**
  *  Send a ping / heartbeat frame to keep the connection alive
  *  @return bool
@@ -45,8 +45,8 @@ public:
      *  @param  frame
      */
     ConsumedMessage(const BasicDeliverFrame &frame) :
-        Message(frame.exchange(), frame.routingKey()),
-        _consumerTag(frame.consumerTag()), _deliveryTag(frame.deliveryTag()), _redelivered(frame.redelivered())
+        Message(frame.exchange().str(), frame.routingKey().str()),
+        _consumerTag(frame.consumerTag().str()), _deliveryTag(frame.deliveryTag()), _redelivered(frame.redelivered())
     {}
 
     /**
@@ -27,8 +27,59 @@ void DeferredConsumer::process(BasicDeliverFrame &frame)
     _deliveryTag = frame.deliveryTag();
     _redelivered = frame.redelivered();
 
+    // the channel keeps track of the deliveries (for coalescing acks)
+    _channel->delivered(_deliveryTag, _noack);
+
     // initialize the object for the next message
     initialize(frame.exchange(), frame.routingKey());
+
+    // the message is added to the batch (if messages are collected in batches)
+    if (_batch) _batch->begin(_deliveryTag, _redelivered, frame.exchange(), frame.routingKey());
+}
+
+/**
+ *  Indicate that a message was done
+ */
+void DeferredConsumer::complete()
+{
+    // if messages are not collected in batches, they are reported right away
+    if (!_batch) return DeferredExtReceiver::complete();
+
+    // the connection reports the batch when it is done parsing
+    if (_batch->complete()) _channel->batch(shared_from_this());
+
+    // the sink has received the full message
+    if (_sink) _sink->complete(_deliveryTag, _redelivered);
+
+    // a message may have been constructed for the onReceived() callback, we do not need it
+    _message.reset();
+
+    // we are now done executing, so the channel can forget the current receiving object
+    _channel->install(nullptr);
+}
+
+/**
+ *  Report the messages that were collected in the batch
+ */
+void DeferredConsumer::flush()
+{
+    // the batch could have been removed in the meantime
+    if (!_batch || _batch->size() == 0) return;
+
+    // make sure we stay in scope
+    auto self = shared_from_this();
+
+    // we take out the batch while the callback runs, because the callback could remove it
+    std::unique_ptr<MessageBatch> batch(std::move(_batch));
+
+    // report the messages
+    if (_batchCallback) _batchCallback(batch->messages(), batch->size());
+
+    // the messages are no longer needed
+    batch->clear();
+
+    // put the batch back, unless the callback removed it or installed a new one
+    if (_batchCallback && !_batch) _batch = std::move(batch);
 }
 
 /**
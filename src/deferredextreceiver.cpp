@@ -23,13 +23,13 @@ namespace AMQP {
  *  @param  exchange            the exchange to which the message was published
  *  @param  routingkey          the routing key that was used to publish the message
  */
-void DeferredExtReceiver::initialize(const std::string &exchange, const std::string &routingkey)
+void DeferredExtReceiver::initialize(const StringView &exchange, const StringView &routingkey)
 {
     // call base
     DeferredReceiver::initialize(exchange, routingkey);
     
     // do we have anybody interested in messages? in that case we construct the message
-    if (_messageCallback) _message.construct(exchange, routingkey);
+    if (_messageCallback) _message.construct(exchange.str(), routingkey.str(), _channel->allocator());
 }
 
 /**
@@ -45,6 +45,9 @@ void DeferredExtReceiver::complete()
 
     // do we have to inform anyone about completion?
     if (_deliveredCallback) _deliveredCallback(_deliveryTag, _redelivered);
+
+    // the sink has received the full message
+    if (_sink) _sink->complete(_deliveryTag, _redelivered);
     
     // for the next iteration we want a new message
     _message.reset();
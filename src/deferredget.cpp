@@ -32,6 +32,9 @@ const std::shared_ptr<Deferred> &DeferredGet::reportSuccess(uint32_t messagecoun
     _deliveryTag = deliveryTag;
     _redelivered = redelivered;
 
+    // the channel keeps track of the deliveries (for coalescing acks)
+    _channel->delivered(deliveryTag, _noack);
+
     // report the size (note that this is the size _minus_ the message that is retrieved
     // (and for which the callback will be called later), so it could be zero)
     if (_countCallback) _countCallback(messagecount);
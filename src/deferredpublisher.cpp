@@ -32,10 +32,10 @@ void DeferredPublisher::process(BasicReturnFrame &frame)
     if (_beginCallback) _beginCallback(_code, _description);
 
     // initialize the object for the next message
-    initialize(frame.exchange(), frame.routingKey());
+    initialize(StringView(frame.exchange()), StringView(frame.routingKey()));
 
     // do we have anybody interested in messages? in that case we construct the message
-    if (_bounceCallback) _message.construct(frame.exchange(), frame.routingKey());
+    if (_bounceCallback) _message.construct(frame.exchange(), frame.routingKey(), _channel->allocator());
 }
 
 /**
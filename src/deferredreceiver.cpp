@@ -25,10 +25,13 @@ namespace AMQP {
  *  @param  exchange
  *  @param  routingkey
  */
-void DeferredReceiver::initialize(const std::string &exchange, const std::string &routingkey)
+void DeferredReceiver::initialize(const StringView &exchange, const StringView &routingkey)
 {
-    // anybody interested in the new message?
-    if (_startCallback) _startCallback(exchange, routingkey);
+    // anybody interested in the views on the received data?
+    if (_startViewCallback) _startViewCallback(exchange, routingkey);
+
+    // anybody interested in the new message? (then we need copies of the strings)
+    if (_startCallback) _startCallback(exchange.str(), routingkey.str());
 }
 
 /**
@@ -47,6 +50,9 @@ void DeferredReceiver::process(BasicHeaderFrame &frame)
     // is user interested in the size?
     if (_sizeCallback) _sizeCallback(_bodySize);
 
+    // a sink gets the data of the new message
+    if (_sink) _sink->begin(_bodySize);
+
     // do we have a message?
     if (_message)
     {
@@ -55,6 +61,9 @@ void DeferredReceiver::process(BasicHeaderFrame &frame)
         _message->set(frame.metaData());
     }
 
+    // are messages collected in a batch?
+    if (_batch) _batch->properties(frame.metaData());
+
     // anybody interested in the headers?
     if (_headerCallback) _headerCallback(frame.metaData());
 
@@ -78,9 +87,15 @@ void DeferredReceiver::process(BodyFrame &frame)
     // anybody interested in the data?
     if (_dataCallback) _dataCallback(frame.payload(), frame.payloadSize());
 
+    // pass the data to the sink, and stop processing incoming data if it can not keep up
+    if (_sink && !_sink->write(frame.payload(), frame.payloadSize())) _channel->throttle();
+
     // do we have a message? then append the data
     if (_message) _message->append(frame.payload(), frame.payloadSize());
 
+    // are messages collected in a batch?
+    if (_batch) _batch->append(frame.payload(), frame.payloadSize());
+
     // if all bytes were received we are now complete
     if (_bodySize == 0) complete();
 }
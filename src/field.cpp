@@ -4,6 +4,7 @@
  *  @copyright 2014 Copernica BV
  */
 #include "includes.h"
+#include "fieldarena.h"
 
 /**
  *  Set up namespace
@@ -12,11 +13,12 @@ namespace AMQP {
 
 /**
  *  Decode a field by fetching a type and full field from a frame
- *  The returned field is allocated on the heap!
+ *  The returned field is constructed in the arena, and is destructed with it
  *  @param  frame
+ *  @param  arena
  *  @return Field*
  */
-Field *Field::decode(ReceivedFrame &frame)
+Field *Field::decode(ReceivedFrame &frame, FieldArena &arena)
 {
     // get the type
     uint8_t type = frame.nextUint8();
@@ -24,23 +26,23 @@ Field *Field::decode(ReceivedFrame &frame)
     // create field based on type
     switch (type)
     {
-        case 't':   return new BooleanSet(frame);
-        case 'b':   return new Octet(frame);
-        case 'B':   return new UOctet(frame);
-        case 'U':   return new Short(frame);
-        case 'u':   return new UShort(frame);
-        case 'I':   return new Long(frame);
-        case 'i':   return new ULong(frame);
-        case 'L':   return new LongLong(frame);
-        case 'l':   return new ULongLong(frame);
-        case 'f':   return new Float(frame);
-        case 'd':   return new Double(frame);
-        case 'D':   return new DecimalField(frame);
-        case 's':   return new ShortString(frame);
-        case 'S':   return new LongString(frame);
-        case 'A':   return new Array(frame);
-        case 'T':   return new Timestamp(frame);
-        case 'F':   return new Table(frame);
+        case 't':   return arena.construct<BooleanSet>(frame);
+        case 'b':   return arena.construct<Octet>(frame);
+        case 'B':   return arena.construct<UOctet>(frame);
+        case 'U':   return arena.construct<Short>(frame);
+        case 'u':   return arena.construct<UShort>(frame);
+        case 'I':   return arena.construct<Long>(frame);
+        case 'i':   return arena.construct<ULong>(frame);
+        case 'L':   return arena.construct<LongLong>(frame);
+        case 'l':   return arena.construct<ULongLong>(frame);
+        case 'f':   return arena.construct<Float>(frame);
+        case 'd':   return arena.construct<Double>(frame);
+        case 'D':   return arena.construct<DecimalField>(frame);
+        case 's':   return arena.construct<ShortString>(frame);
+        case 'S':   return arena.construct<LongString>(frame);
+        case 'A':   return arena.construct<Array>(frame);
+        case 'T':   return arena.construct<Timestamp>(frame);
+        case 'F':   return arena.construct<Table>(frame);
         default:    return nullptr;
     }
 }
@@ -0,0 +1,192 @@
+/**
+ *  FieldArena.h
+ *
+ *  Memory in which decoded fields are constructed. Instead of allocating
+ *  every field (and the control block of its shared pointer) separately,
+ *  the fields are placed one after the other in the arena, and they are
+ *  all destructed and released in one go when the arena is destructed.
+ *  Small arenas do not allocate at all beyond the arena object itself.
+ *
+ *  The arena is held in a std::shared_ptr, and the decoded fields are
+ *  exposed via shared pointers that share the ownership of the arena
+ *  (the aliasing constructor), so that they cost no allocations.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class FieldArena
+{
+private:
+    /**
+     *  The alignment of all allocations
+     *  @var size_t
+     */
+    static constexpr size_t alignment = alignof(std::max_align_t);
+
+    /**
+     *  Size of the memory that is allocated when the arena runs out of space
+     *  @var size_t
+     */
+    static constexpr size_t chunksize = 4096;
+
+    /**
+     *  Bookkeeping that is stored in front of every field, so that the
+     *  fields can be destructed (in reverse order) when the arena is destructed
+     */
+    struct alignas(std::max_align_t) Entry
+    {
+        Entry *previous;
+        Field *field;
+    };
+
+    /**
+     *  Memory that was allocated because the local memory was full, each chunk
+     *  starts with a pointer to the chunk that was allocated before it
+     *  @var void*
+     */
+    void *_chunks = nullptr;
+
+    /**
+     *  The memory that is currently being filled, and the number of bytes left
+     *  @var char*
+     *  @var size_t
+     */
+    char *_current;
+    size_t _left;
+
+    /**
+     *  The last field that was constructed
+     *  @var Entry*
+     */
+    Entry *_last = nullptr;
+
+    /**
+     *  Local memory that is used before anything has to be allocated
+     *  @var char[]
+     */
+    alignas(std::max_align_t) char _local[512];
+
+    /**
+     *  Round up a size to the alignment
+     *  @param  size
+     *  @return size_t
+     */
+    static size_t align(size_t size)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     *  Get memory
+     *  @param  size        number of bytes (already aligned)
+     *  @return void*
+     *  @throws std::bad_alloc
+     */
+    void *allocate(size_t size)
+    {
+        // allocate a new chunk if the current memory is full
+        if (size > _left)
+        {
+            // the chunk starts with the link to the previous chunk
+            size_t bytes = align(sizeof(void *)) + std::max(size, (size_t)chunksize);
+            void *chunk = malloc(bytes);
+            if (chunk == nullptr) throw std::bad_alloc();
+
+            // link the chunk
+            *(void **)chunk = _chunks;
+            _chunks = chunk;
+
+            // this is the memory that we fill now
+            _current = (char *)chunk + align(sizeof(void *));
+            _left = bytes - align(sizeof(void *));
+        }
+
+        // take the memory
+        void *result = _current;
+        _current += size;
+        _left -= size;
+
+        // done
+        return result;
+    }
+
+public:
+    /**
+     *  Constructor
+     */
+    FieldArena() : _current(_local), _left(sizeof(_local)) {}
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    FieldArena(const FieldArena &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~FieldArena()
+    {
+        // destruct the fields, the last one first
+        for (Entry *entry = _last; entry != nullptr; entry = entry->previous) entry->field->~Field();
+
+        // release the chunks
+        while (_chunks != nullptr)
+        {
+            // the chunk before this one
+            void *previous = *(void **)_chunks;
+
+            // release the chunk
+            free(_chunks);
+            _chunks = previous;
+        }
+    }
+
+    /**
+     *  Construct a field in the arena
+     *  @param  args        the arguments for the constructor
+     *  @return T*          the field, which is valid for as long as the arena exists
+     */
+    template <typename T, typename ...Args>
+    T *construct(Args&&... args)
+    {
+        // memory for the bookkeeping and the field
+        char *memory = (char *)allocate(sizeof(Entry) + align(sizeof(T)));
+
+        // construct the field (if this throws, the memory is simply not used)
+        T *field = new (memory + sizeof(Entry)) T(std::forward<Args>(args)...);
+
+        // remember that the field has to be destructed
+        _last = new (memory) Entry{ _last, field };
+
+        // done
+        return field;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,154 @@
+/**
+ *  FieldCheck.h
+ *
+ *  Class that checks an encoded field for its size. Tables and arrays are
+ *  kept in their encoded form and their fields are only decoded when they
+ *  are retrieved, so a received table is checked as a whole (including the
+ *  tables and arrays nested in it) while the frame is parsed.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Internal helper class that finds the size of an encoded field
+ */
+class FieldCheck
+{
+private:
+    /**
+     *  Size of the field
+     *  @var size_t
+     */
+    size_t _size;
+
+public:
+    /**
+     *  Constructor
+     *  @param  data        the encoded value (without the type)
+     *  @param  size        number of bytes that are available
+     *  @param  type        the type of the field
+     *  @param  nested      should the fields of a table or array be checked too?
+     *  @throws ProtocolException   if the field is invalid
+     */
+    FieldCheck(const char *data, size_t size, char type, bool nested)
+    {
+        // size of the value, and the size of the prefix that holds the size of variable-length values
+        uint64_t bytes = 0, prefix = 0;
+
+        // check the type
+        switch (type)
+        {
+            case 't':   bytes = 1; break;
+            case 'b':   bytes = 1; break;
+            case 'B':   bytes = 1; break;
+            case 'U':   bytes = 2; break;
+            case 'u':   bytes = 2; break;
+            case 'I':   bytes = 4; break;
+            case 'i':   bytes = 4; break;
+            case 'L':   bytes = 8; break;
+            case 'l':   bytes = 8; break;
+            case 'f':   bytes = 4; break;
+            case 'd':   bytes = 8; break;
+            case 'D':   bytes = 5; break;
+            case 'T':   bytes = 8; break;
+            case 's':   prefix = 1; break;
+            case 'S':   prefix = 4; break;
+            case 'A':   prefix = 4; break;
+            case 'F':   prefix = 4; break;
+            default:    throw ProtocolException("invalid field type");
+        }
+
+        // the prefix must fit
+        if (prefix > size) throw ProtocolException("frame out of range");
+
+        // read the size from the prefix
+        if (prefix == 1) bytes = 1 + (uint8_t)data[0];
+        else if (prefix == 4)
+        {
+            // decode the 32-bit size
+            uint32_t value;
+            memcpy(&value, data, sizeof(uint32_t));
+            bytes = 4 + (uint64_t)be32toh(value);
+        }
+
+        // the value must fit
+        if (bytes > size) throw ProtocolException("frame out of range");
+
+        // this is the size of the field
+        _size = (size_t)bytes;
+
+        // check the fields in a table or array
+        if (nested && type == 'F') table(data + 4, _size - 4);
+        if (nested && type == 'A') array(data + 4, _size - 4);
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~FieldCheck() {}
+
+    /**
+     *  Check the encoded fields of a table (without the leading size)
+     *  @param  data        the encoded fields
+     *  @param  size        size of the encoded fields
+     *  @throws ProtocolException   if a field is invalid
+     */
+    static void table(const char *data, size_t size)
+    {
+        // walk over the fields
+        for (size_t pos = 0; pos < size; )
+        {
+            // the field name is a short string, followed by the type
+            pos += 1 + (uint8_t)data[pos] + 1;
+
+            // the type must be there
+            if (pos > size) throw ProtocolException("frame out of range");
+
+            // skip the value
+            pos += FieldCheck(data + pos, size - pos, data[pos - 1], true).size();
+        }
+    }
+
+    /**
+     *  Check the encoded fields of an array (without the leading size)
+     *  @param  data        the encoded fields
+     *  @param  size        size of the encoded fields
+     *  @throws ProtocolException   if a field is invalid
+     */
+    static void array(const char *data, size_t size)
+    {
+        // walk over the fields
+        for (size_t pos = 0; pos < size; )
+        {
+            // each field starts with the type
+            char type = data[pos++];
+
+            // skip the value
+            pos += FieldCheck(data + pos, size - pos, type, true).size();
+        }
+    }
+
+    /**
+     *  Size of the field
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -41,8 +41,12 @@
 #include "amqpcpp/endian.h"
 #include "amqpcpp/buffer.h"
 #include "amqpcpp/bytebuffer.h"
+#include "amqpcpp/stringview.h"
+#include "amqpcpp/allocator.h"
+#include "amqpcpp/poolallocator.h"
 #include "amqpcpp/receivedframe.h"
 #include "amqpcpp/outbuffer.h"
+#include "amqpcpp/gatherbuffer.h"
 #include "amqpcpp/copiedbuffer.h"
 #include "amqpcpp/watchable.h"
 #include "amqpcpp/monitor.h"
@@ -61,6 +65,10 @@
 #include "amqpcpp/metadata.h"
 #include "amqpcpp/envelope.h"
 #include "amqpcpp/message.h"
+#include "amqpcpp/publishtemplate.h"
+#include "amqpcpp/messageview.h"
+#include "amqpcpp/messagebatch.h"
+#include "amqpcpp/sink.h"
 
 // mid level includes
 #include "amqpcpp/exchangetype.h"
@@ -69,6 +77,8 @@
 #include "amqpcpp/deferred.h"
 #include "amqpcpp/deferredconsumer.h"
 #include "amqpcpp/deferredpublisher.h"
+#include "amqpcpp/ackwindow.h"
+#include "amqpcpp/qoscontroller.h"
 #include "amqpcpp/deferredqueue.h"
 #include "amqpcpp/deferreddelete.h"
 #include "amqpcpp/deferredcancel.h"
@@ -76,6 +86,8 @@
 #include "amqpcpp/deferredget.h"
 #include "amqpcpp/channelimpl.h"
 #include "amqpcpp/channel.h"
+#include "amqpcpp/deferredpublish.h"
+#include "amqpcpp/confirmedpublisher.h"
 #include "amqpcpp/login.h"
 #include "amqpcpp/address.h"
 #include "amqpcpp/connectionhandler.h"
@@ -0,0 +1,60 @@
+/**
+ *  ConnectionPool.cpp
+ *
+ *  Implementation of the ConnectionPool class
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include "includes.h"
+#include "poolworker.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Constructor
+ *  @param  address     the address to connect to
+ *  @param  threads     number of threads and connections (0 for one per core)
+ *  @param  channels    number of channels per connection
+ */
+ConnectionPool::ConnectionPool(const Address &address, size_t threads, size_t channels) : _channels(std::max(channels, (size_t)1))
+{
+    // one thread per core if the number of threads was not set
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // start the workers
+    for (size_t i = 0; i < threads; ++i) _workers.emplace_back(new PoolWorker(address, _channels));
+}
+
+/**
+ *  Destructor
+ */
+ConnectionPool::~ConnectionPool() {}
+
+/**
+ *  Publish a message to an exchange
+ *  @param  exchange    the exchange to publish to
+ *  @param  routingkey  the routing key
+ *  @param  envelope    the full envelope to send
+ *  @param  flags       optional flags
+ *  @return bool
+ */
+bool ConnectionPool::publish(const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags)
+{
+    // messages with the same routing key always go to the same channel
+    size_t shard = std::hash<std::string>()(routingKey) % (_workers.size() * _channels);
+
+    // pass the message to the worker that owns the channel
+    return _workers[shard % _workers.size()]->publish(new PoolMessage(shard / _workers.size(), exchange, routingKey, envelope, flags));
+}
+
+/**
+ *  End of namespace
+ */
+}
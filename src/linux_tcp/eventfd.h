@@ -0,0 +1,118 @@
+/**
+ *  EventFd.h
+ *
+ *  Filedescriptor that is used to wake up the thread that runs an event loop.
+ *  Other threads call notify() after they have put work in a queue, the loop
+ *  thread watches the filedescriptor for readability, and calls reset()
+ *  before it processes the queue. When many threads call notify() before the
+ *  loop thread wakes up, only the first one makes a system call.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <atomic>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class EventFd
+{
+private:
+    /**
+     *  The filedescriptor
+     *  @var int
+     */
+    int _fd;
+
+    /**
+     *  Was the filedescriptor already notified since the last reset?
+     *  @var std::atomic<bool>
+     */
+    std::atomic<bool> _notified{false};
+
+public:
+    /**
+     *  Constructor
+     *  @throws std::runtime_error
+     */
+    EventFd() : _fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    {
+        // check for failure
+        if (_fd < 0) throw std::runtime_error(strerror(errno));
+    }
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    EventFd(const EventFd &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~EventFd()
+    {
+        // close the filedescriptor
+        close(_fd);
+    }
+
+    /**
+     *  Expose the filedescriptor
+     *  @return int
+     */
+    int fileno() const { return _fd; }
+
+    /**
+     *  Notify the loop thread (can be called from any thread)
+     */
+    void notify()
+    {
+        // skip the system call if the loop thread was already notified
+        if (_notified.exchange(true)) return;
+
+        // make the filedescriptor readable
+        uint64_t value = 1;
+        auto result = write(_fd, &value, sizeof(value));
+
+        // the write can not really fail (the counter can not overflow)
+        (void) result;
+    }
+
+    /**
+     *  Reset the filedescriptor, this must be called by the loop thread
+     *  _before_ it processes the work that was queued
+     */
+    void reset()
+    {
+        // make the filedescriptor unreadable
+        uint64_t value;
+        auto result = read(_fd, &value, sizeof(value));
+
+        // from now on, threads have to notify again (this must come after the read,
+        // otherwise a notification that comes in between would be swallowed)
+        _notified.store(false);
+
+        // it is no problem if the filedescriptor was not readable
+        (void) result;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
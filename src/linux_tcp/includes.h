@@ -22,7 +22,10 @@
 // mid level includes
 #include "amqpcpp/linux_tcp/tcpparent.h"
 #include "amqpcpp/linux_tcp/tcphandler.h"
+#include "amqpcpp/linux_tcp/tlsmetrics.h"
 #include "amqpcpp/linux_tcp/tcpconnection.h"
+#include "amqpcpp/linux_tcp/tcpchannel.h"
+#include "amqpcpp/linux_tcp/connectionpool.h"
 
 // classes that are very commonly used
 #include "addressinfo.h"
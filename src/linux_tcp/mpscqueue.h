@@ -0,0 +1,184 @@
+/**
+ *  MpscQueue.h
+ *
+ *  Queue with multiple producers and a single consumer. Any thread can push
+ *  objects into the queue, but only one thread (normally the thread that runs
+ *  the event loop) may take them out. Pushing is wait-free (it is a single
+ *  atomic exchange), popping does not block either.
+ *
+ *  The queue is intrusive: the objects must be derived from MpscNode. The
+ *  queue takes ownership of the pushed objects, and pop() hands it back.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <atomic>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Base class of the objects in the queue
+ */
+class MpscNode
+{
+private:
+    /**
+     *  The next object in the queue
+     *  @var std::atomic<MpscNode*>
+     */
+    std::atomic<MpscNode *> _next{nullptr};
+
+    /**
+     *  The queue may access the pointer
+     */
+    template <typename T> friend class MpscQueue;
+
+public:
+    /**
+     *  Destructor
+     */
+    virtual ~MpscNode() {}
+};
+
+/**
+ *  Class definition
+ */
+template <typename T>
+class MpscQueue
+{
+private:
+    /**
+     *  Dummy node, so that the queue is never really empty
+     *  @var MpscNode
+     */
+    MpscNode _stub;
+
+    /**
+     *  The most recently pushed node (producers only touch this member)
+     *  @var std::atomic<MpscNode*>
+     */
+    std::atomic<MpscNode *> _head{&_stub};
+
+    /**
+     *  The oldest node (this member is only used by the consumer)
+     *  @var MpscNode*
+     */
+    MpscNode *_tail = &_stub;
+
+    /**
+     *  Add a node to the queue
+     *  @param  node
+     */
+    void append(MpscNode *node)
+    {
+        // the node will be the last one
+        node->_next.store(nullptr, std::memory_order_relaxed);
+
+        // make it the head, and link the previous head to it (the consumer stops at
+        // the previous head until the link is set, it never sees a half-added node)
+        auto *previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->_next.store(node, std::memory_order_release);
+    }
+
+public:
+    /**
+     *  Constructor
+     */
+    MpscQueue() = default;
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    MpscQueue(const MpscQueue &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~MpscQueue()
+    {
+        // destruct the objects that are still in the queue
+        while (auto *object = pop()) delete object;
+    }
+
+    /**
+     *  Push an object into the queue (can be called from any thread)
+     *  @param  object      the object, the queue takes ownership
+     */
+    void push(T *object)
+    {
+        // add the node
+        append(object);
+    }
+
+    /**
+     *  Take the oldest object out of the queue (may only be called from the consumer thread)
+     *
+     *  This method returns nullptr if the queue is empty, but also if a producer
+     *  is in the middle of pushing the oldest object. The producer should therefore
+     *  notify the consumer after pushing, so that it will try again.
+     *
+     *  @return T*          the object (the caller takes ownership) or nullptr
+     */
+    T *pop()
+    {
+        // the oldest node, and the one after it
+        auto *tail = _tail;
+        auto *next = tail->_next.load(std::memory_order_acquire);
+
+        // skip the dummy node
+        if (tail == &_stub)
+        {
+            // nothing to do if the queue is empty
+            if (next == nullptr) return nullptr;
+
+            // move on to the first real node
+            _tail = tail = next;
+            next = next->_next.load(std::memory_order_acquire);
+        }
+
+        // if there is a node after the oldest one, the oldest one can be taken out
+        if (next != nullptr)
+        {
+            // the next node becomes the oldest
+            _tail = next;
+
+            // done
+            return static_cast<T *>(tail);
+        }
+
+        // if the oldest node is not the head, a producer is still busy adding a node
+        if (tail != _head.load(std::memory_order_acquire)) return nullptr;
+
+        // the oldest node is the only one, add the dummy node so that it can be taken out
+        append(&_stub);
+
+        // a producer might have added a node in the meantime
+        next = tail->_next.load(std::memory_order_acquire);
+
+        // if the link is not set, a producer is still busy
+        if (next == nullptr) return nullptr;
+
+        // the next node becomes the oldest
+        _tail = next;
+
+        // done
+        return static_cast<T *>(tail);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -220,6 +220,20 @@ int SSL_shutdown(SSL *ssl)
     return func(ssl);
 }
 
+/**
+ *  Set the shutdown state of the connection (without sending or receiving anything)
+ *  @param  ssl     ssl structure
+ *  @param  mode    combination of SSL_SENT_SHUTDOWN and SSL_RECEIVED_SHUTDOWN
+ */
+void SSL_set_shutdown(SSL *ssl, int mode)
+{
+    // create a function
+    static Function<decltype(::SSL_set_shutdown)> func(handle, "SSL_set_shutdown");
+
+    // call the openssl function
+    return func(ssl, mode);
+}
+
 /**
  *  Prepare SSL object to work in client or server mode
  *  @param  ssl     SSL object to set connect state on              
@@ -327,6 +341,195 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
     return func(ctx, cmd, larg, parg);
 }
 
+/**
+ *  Install the callback that is called when a new session is established
+ *  @param  ctx
+ *  @param  callback
+ */
+void SSL_CTX_sess_set_new_cb(SSL_CTX *ctx, int (*callback)(SSL *ssl, SSL_SESSION *session))
+{
+    // create a function
+    static Function<decltype(::SSL_CTX_sess_set_new_cb)> func(handle, "SSL_CTX_sess_set_new_cb");
+
+    // call the openssl function
+    return func(ctx, callback);
+}
+
+/**
+ *  Get the context from which an SSL structure was created
+ *  @param  ssl
+ *  @return SSL_CTX
+ */
+SSL_CTX *SSL_get_SSL_CTX(const SSL *ssl)
+{
+    // create a function
+    static Function<decltype(::SSL_get_SSL_CTX)> func(handle, "SSL_get_SSL_CTX");
+
+    // call the openssl function
+    return func(ssl);
+}
+
+/**
+ *  Get the servername that was set for the connection
+ *  @param  ssl
+ *  @param  type
+ *  @return const char *
+ */
+const char *SSL_get_servername(const SSL *ssl, const int type)
+{
+    // create a function
+    static Function<decltype(::SSL_get_servername)> func(handle, "SSL_get_servername");
+
+    // call the openssl function
+    return func(ssl, type);
+}
+
+/**
+ *  Set the session that the connection should try to resume
+ *  @param  ssl
+ *  @param  session
+ *  @return int
+ */
+int SSL_set_session(SSL *ssl, SSL_SESSION *session)
+{
+    // create a function
+    static Function<decltype(::SSL_set_session)> func(handle, "SSL_set_session");
+
+    // call the openssl function
+    return func(ssl, session);
+}
+
+/**
+ *  Check if the handshake resumed an earlier session
+ *  @param  ssl
+ *  @return int
+ */
+int SSL_session_reused(const SSL *ssl)
+{
+    // create a function
+    static Function<decltype(::SSL_session_reused)> func(handle, "SSL_session_reused");
+
+    // call the openssl function if it exists
+    if (func) return func(ssl);
+
+    // in openssl 1.0 this was a macro around SSL_ctrl (with SSL_CTRL_GET_SESSION_REUSED)
+    return (int)OpenSSL::SSL_ctrl(const_cast<SSL *>(ssl), 8, 0, nullptr);
+}
+
+/**
+ *  Decrement the refcount of a session (and free it if it is no longer used)
+ *  @param  session
+ */
+void SSL_SESSION_free(SSL_SESSION *session)
+{
+    // create a function
+    static Function<decltype(::SSL_SESSION_free)> func(handle, "SSL_SESSION_free");
+
+    // call the openssl function
+    return func(session);
+}
+
+/**
+ *  Get the BIO that is used for reading from the socket
+ *  @param  ssl
+ *  @return BIO
+ */
+BIO *SSL_get_rbio(const SSL *ssl)
+{
+    // create a function
+    static Function<decltype(::SSL_get_rbio)> func(handle, "SSL_get_rbio");
+
+    // call the openssl function
+    return func(ssl);
+}
+
+/**
+ *  Get the BIO that is used for writing to the socket
+ *  @param  ssl
+ *  @return BIO
+ */
+BIO *SSL_get_wbio(const SSL *ssl)
+{
+    // create a function
+    static Function<decltype(::SSL_get_wbio)> func(handle, "SSL_get_wbio");
+
+    // call the openssl function
+    return func(ssl);
+}
+
+/**
+ *  Control a BIO
+ *  @param  bio
+ *  @param  cmd
+ *  @param  larg
+ *  @param  parg
+ *  @return long
+ */
+long BIO_ctrl(BIO *bio, int cmd, long larg, void *parg)
+{
+    // create a function
+    static Function<decltype(::BIO_ctrl)> func(handle, "BIO_ctrl");
+
+    // call the openssl function
+    return func(bio, cmd, larg, parg);
+}
+
+/**
+ *  Get a new index for application data that is stored with openssl objects
+ *  @param  class_index     the type of object (CRYPTO_EX_INDEX_SSL_CTX for contexts)
+ *  @param  argl            value that is passed to the callbacks
+ *  @param  argp            value that is passed to the callbacks
+ *  @param  new_func        called when an object is created
+ *  @param  dup_func        called when an object is copied
+ *  @param  free_func       called when an object is freed
+ *  @return int             the index, or -1 on failure
+ */
+int CRYPTO_get_ex_new_index(int class_index, long argl, void *argp, CRYPTO_EX_new *new_func, CRYPTO_EX_dup *dup_func, CRYPTO_EX_free *free_func)
+{
+    // create a function
+    static Function<decltype(::CRYPTO_get_ex_new_index)> func(handle, "CRYPTO_get_ex_new_index");
+
+    // call the openssl function if it exists (and accepts a class index)
+    if (func) return func(class_index, argl, argp, new_func, dup_func, free_func);
+
+    // older openssl libraries have a separate function for contexts
+    static Function<int(long, void *, CRYPTO_EX_new *, CRYPTO_EX_dup *, CRYPTO_EX_free *)> old(handle, "SSL_CTX_get_ex_new_index");
+
+    // call the old one (only contexts are supported)
+    return class_index == CRYPTO_EX_INDEX_SSL_CTX && old ? old(argl, argp, new_func, dup_func, free_func) : -1;
+}
+
+/**
+ *  Store application data with a context
+ *  @param  ctx
+ *  @param  idx             the index from CRYPTO_get_ex_new_index()
+ *  @param  data
+ *  @return int             1 on success
+ */
+int SSL_CTX_set_ex_data(SSL_CTX *ctx, int idx, void *data)
+{
+    // create a function
+    static Function<decltype(::SSL_CTX_set_ex_data)> func(handle, "SSL_CTX_set_ex_data");
+
+    // call the openssl function
+    return func(ctx, idx, data);
+}
+
+/**
+ *  Get the application data that is stored with a context
+ *  @param  ctx
+ *  @param  idx             the index from CRYPTO_get_ex_new_index()
+ *  @return void*
+ */
+void *SSL_CTX_get_ex_data(const SSL_CTX *ctx, int idx)
+{
+    // create a function
+    static Function<decltype(::SSL_CTX_get_ex_data)> func(handle, "SSL_CTX_get_ex_data");
+
+    // call the openssl function
+    return func(ctx, idx);
+}
+
 /**
  *  Clear the SSL error queue
  *  @return void
@@ -44,6 +44,7 @@ int      SSL_shutdown(SSL *ssl);
 int      SSL_pending(const SSL *ssl);
 int      SSL_set_fd(SSL *ssl, int fd);
 int      SSL_get_shutdown(const SSL *ssl);
+void     SSL_set_shutdown(SSL *ssl, int mode);
 int      SSL_get_error(const SSL *ssl, int ret);
 int      SSL_use_certificate_file(SSL *ssl, const char *file, int type);
 void     SSL_set_connect_state(SSL *ssl);
@@ -51,6 +52,18 @@ void     SSL_CTX_free(SSL_CTX *ctx);
 void     SSL_free(SSL *ssl);
 long     SSL_ctrl(SSL *ssl, int cmd, long larg, void *parg);
 long     SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg);
+void     SSL_CTX_sess_set_new_cb(SSL_CTX *ctx, int (*callback)(SSL *ssl, SSL_SESSION *session));
+SSL_CTX *SSL_get_SSL_CTX(const SSL *ssl);
+const char *SSL_get_servername(const SSL *ssl, const int type);
+int      SSL_set_session(SSL *ssl, SSL_SESSION *session);
+int      SSL_session_reused(const SSL *ssl);
+void     SSL_SESSION_free(SSL_SESSION *session);
+BIO     *SSL_get_rbio(const SSL *ssl);
+BIO     *SSL_get_wbio(const SSL *ssl);
+long     BIO_ctrl(BIO *bio, int cmd, long larg, void *parg);
+int      CRYPTO_get_ex_new_index(int class_index, long argl, void *argp, CRYPTO_EX_new *new_func, CRYPTO_EX_dup *dup_func, CRYPTO_EX_free *free_func);
+int      SSL_CTX_set_ex_data(SSL_CTX *ctx, int idx, void *data);
+void    *SSL_CTX_get_ex_data(const SSL_CTX *ctx, int idx);
 void     ERR_clear_error(void);
 
 /**
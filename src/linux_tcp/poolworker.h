@@ -0,0 +1,410 @@
+/**
+ *  PoolWorker.h
+ *
+ *  Worker of a connection pool. Every worker runs its own thread with its
+ *  own event loop, and owns a TcpConnection with a number of channels. Other
+ *  threads pass messages to the worker through a lock-free queue, and wake
+ *  up the event loop with an eventfd. When the connection fails, the worker
+ *  sets up a new one, with an increasing delay between the attempts.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <poll.h>
+#include <thread>
+#include <chrono>
+#include "mpscqueue.h"
+#include "eventfd.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Message that is passed from a producer thread to the worker
+ */
+class PoolMessage : public MpscNode
+{
+public:
+    /**
+     *  The channel to publish over
+     *  @var size_t
+     */
+    size_t channel;
+
+    /**
+     *  Exchange, routing key and body of the message
+     *  @var std::string
+     */
+    std::string exchange;
+    std::string routingKey;
+    std::string body;
+
+    /**
+     *  The properties of the message (the envelope has no body)
+     *  @var Envelope
+     */
+    Envelope properties;
+
+    /**
+     *  The publish flags
+     *  @var int
+     */
+    int flags;
+
+    /**
+     *  Constructor
+     *  @param  channel     the channel to publish over
+     *  @param  exchange    the exchange to publish to
+     *  @param  routingKey  the routing key
+     *  @param  envelope    the message
+     *  @param  flags       the publish flags
+     */
+    PoolMessage(size_t channel, const std::string &exchange, const std::string &routingKey, const Envelope &envelope, int flags) :
+        channel(channel), exchange(exchange), routingKey(routingKey), body(envelope.body(), envelope.bodySize()), properties(nullptr, 0), flags(flags)
+    {
+        // copy the properties
+        properties.set(envelope);
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~PoolMessage() {}
+};
+
+/**
+ *  Class definition
+ */
+class PoolWorker : private TcpHandler
+{
+private:
+    /**
+     *  The address to connect to
+     *  @var Address
+     */
+    Address _address;
+
+    /**
+     *  Number of channels to open
+     *  @var size_t
+     */
+    size_t _channelCount;
+
+    /**
+     *  The messages that were passed in by other threads
+     *  @var MpscQueue
+     */
+    MpscQueue<PoolMessage> _queue;
+
+    /**
+     *  Filedescriptor to wake up the event loop
+     *  @var EventFd
+     */
+    EventFd _eventfd;
+
+    /**
+     *  Should the worker stop? And is the worker without a connection (messages
+     *  are not accepted until it starts a new one)?
+     *  @var std::atomic<bool>
+     */
+    std::atomic<bool> _stopping{false};
+    std::atomic<bool> _failed{false};
+
+    /**
+     *  The filedescriptors that the connection wants to be watched (only used by the worker thread)
+     *  @var std::map
+     */
+    std::map<int, int> _fds;
+
+    /**
+     *  The connection and the channels (only used by the worker thread)
+     *  @var std::unique_ptr
+     */
+    std::unique_ptr<TcpConnection> _connection;
+    std::vector<std::unique_ptr<TcpChannel>> _channels;
+
+    /**
+     *  Is the connection closed? And did it ever become ready? (only used by the worker thread)
+     *  @var bool
+     */
+    bool _closed = false;
+    bool _ready = false;
+
+    /**
+     *  The negotiated heartbeat interval in seconds (only used by the worker thread)
+     *  @var uint16_t
+     */
+    uint16_t _heartbeat = 0;
+
+    /**
+     *  The thread that runs the event loop
+     *  @var std::thread
+     */
+    std::thread _thread;
+
+    /**
+     *  Method that is called by the connection to register a filedescriptor
+     *  @param  connection
+     *  @param  fd
+     *  @param  flags
+     */
+    virtual void monitor(TcpConnection *connection, int fd, int flags) override
+    {
+        // update the administration
+        if (flags == 0) _fds.erase(fd);
+        else _fds[fd] = flags;
+    }
+
+    /**
+     *  Method that is called when the heartbeat interval is negotiated
+     *  @param  connection
+     *  @param  interval
+     *  @return uint16_t
+     */
+    virtual uint16_t onNegotiate(TcpConnection *connection, uint16_t interval) override
+    {
+        // the event loop sends the heartbeats
+        return _heartbeat = interval;
+    }
+
+    /**
+     *  Method that is called when the login attempt succeeded
+     *  @param  connection
+     */
+    virtual void onReady(TcpConnection *connection) override
+    {
+        // the connection works, the next attempt can start without a long delay
+        _ready = true;
+    }
+
+    /**
+     *  Method that is called when the connection is in an error state
+     *  @param  connection
+     *  @param  message
+     */
+    virtual void onError(TcpConnection *connection, const char *message) override
+    {
+        // no more messages are accepted
+        _failed = true;
+    }
+
+    /**
+     *  Method that is called when the connection is no longer in use
+     *  @param  connection
+     */
+    virtual void onDetached(TcpConnection *connection) override
+    {
+        // the event loop can stop
+        _closed = true;
+    }
+
+    /**
+     *  Publish the messages that were passed in by other threads
+     */
+    void drain()
+    {
+        // reset the eventfd before the queue is processed, so that no notifications are missed
+        _eventfd.reset();
+
+        // publish all messages
+        while (auto *message = _queue.pop())
+        {
+            // the envelope to publish
+            Envelope envelope(message->body.data(), message->body.size());
+            envelope.set(message->properties);
+
+            // publish it (the output is corked, so nothing is written yet)
+            _channels[message->channel]->publish(message->exchange, message->routingKey, envelope, message->flags);
+
+            // the message is no longer needed
+            delete message;
+        }
+
+        // write all messages at once
+        _connection->flush();
+
+        // close the connection if the worker has to stop (this only happens once, because close() fails the second time)
+        if (_stopping) _connection->close();
+    }
+
+    /**
+     *  Set up a connection, and run the event loop until the connection is closed
+     */
+    void session()
+    {
+        // start with a clean administration
+        _closed = _ready = false;
+        _heartbeat = 0;
+        _fds.clear();
+
+        // create the connection and the channels
+        _connection.reset(new TcpConnection(this, _address));
+        for (size_t i = 0; i < _channelCount; ++i) _channels.emplace_back(new TcpChannel(_connection.get()));
+
+        // output is flushed after every batch of messages
+        _connection->cork();
+
+        // messages are accepted again, and the ones that were already queued are published too
+        _failed = false;
+        _eventfd.notify();
+
+        // when the last heartbeat was sent
+        auto heartbeat = std::chrono::steady_clock::now();
+
+        // run until the connection is closed
+        while (!_closed)
+        {
+            // the filedescriptors to watch (the eventfd comes first)
+            std::vector<pollfd> fds;
+            fds.push_back(pollfd{ _eventfd.fileno(), POLLIN, 0 });
+            for (auto &iter : _fds) fds.push_back(pollfd{ iter.first, (short)((iter.second & readable ? POLLIN : 0) | (iter.second & writable ? POLLOUT : 0)), 0 });
+
+            // wait for activity (wake up in time to send heartbeats, at half the interval)
+            poll(fds.data(), fds.size(), _heartbeat > 0 ? _heartbeat * 500 : -1);
+
+            // pass the activity to the connection
+            for (size_t i = 1; i < fds.size(); ++i)
+            {
+                // the flags to pass on
+                int flags = (fds[i].revents & (POLLIN | POLLHUP | POLLERR) ? readable : 0) | (fds[i].revents & POLLOUT ? writable : 0);
+
+                // process the filedescriptor
+                if (flags) _connection->process(fds[i].fd, flags);
+            }
+
+            // publish the messages from other threads
+            if (fds[0].revents && !_closed) drain();
+
+            // is it time to send a heartbeat?
+            if (_heartbeat == 0 || _closed || std::chrono::steady_clock::now() - heartbeat < std::chrono::milliseconds(_heartbeat * 500)) continue;
+
+            // send the heartbeat
+            _connection->heartbeat();
+            heartbeat = std::chrono::steady_clock::now();
+        }
+
+        // the connection failed or was closed, no more messages are accepted
+        _failed = true;
+
+        // clean up (the channels first, they refer to the connection)
+        _channels.clear();
+        _connection.reset();
+    }
+
+    /**
+     *  Wait before the next connection attempt, or until the worker has to stop
+     *  @param  delay       time to wait
+     */
+    void wait(std::chrono::milliseconds delay)
+    {
+        // the end of the delay
+        auto until = std::chrono::steady_clock::now() + delay;
+
+        // keep waiting until the worker has to stop
+        while (!_stopping)
+        {
+            // the time that is left
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now());
+
+            // leap out if the delay is over
+            if (left.count() <= 0) return;
+
+            // wait for the eventfd, because the destructor uses it to wake us up
+            pollfd fd{ _eventfd.fileno(), POLLIN, 0 };
+            poll(&fd, 1, (int)left.count());
+
+            // messages that are queued are published over the next connection
+            if (fd.revents) _eventfd.reset();
+        }
+    }
+
+    /**
+     *  Run the worker: it sets up a new connection every time the connection fails
+     */
+    void run()
+    {
+        // the delay before the next attempt
+        std::chrono::milliseconds delay(100);
+
+        // keep going until the worker has to stop
+        while (!_stopping)
+        {
+            // set up a connection and use it until it fails or is closed
+            session();
+
+            // leap out if the connection was closed because the worker has to stop
+            if (_stopping) return;
+
+            // after a connection that worked, we start with a short delay again
+            if (_ready) delay = std::chrono::milliseconds(100);
+
+            // wait before the next attempt, and wait twice as long the next time (but at most 30 seconds)
+            wait(delay);
+            delay = std::min(delay * 2, std::chrono::milliseconds(30000));
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  address     the address to connect to
+     *  @param  channels    number of channels to open
+     */
+    PoolWorker(const Address &address, size_t channels) : _address(address), _channelCount(channels)
+    {
+        // start the thread
+        _thread = std::thread([this]() { run(); });
+    }
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    PoolWorker(const PoolWorker &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~PoolWorker()
+    {
+        // tell the thread to close the connection after the pending messages
+        _stopping = true;
+        _eventfd.notify();
+
+        // wait for it
+        _thread.join();
+    }
+
+    /**
+     *  Publish a message (can be called from any thread)
+     *  @param  message     the message, the worker takes ownership
+     *  @return bool
+     */
+    bool publish(PoolMessage *message)
+    {
+        // no more messages are accepted if the connection failed
+        if (_failed) { delete message; return false; }
+
+        // pass the message to the worker thread, and wake it up
+        _queue.push(message);
+        _eventfd.notify();
+
+        // done
+        return true;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,408 @@
+/**
+ *  ResolverPool.h
+ *
+ *  Pool of threads that do the DNS lookups for all TcpConnections in the
+ *  process. getaddrinfo() is a blocking call, so it can not be done by the
+ *  event loop thread, but instead of starting a thread for every connection,
+ *  the lookups are passed to a small number of shared threads. Connections
+ *  that look up the same hostname at the same time share a single lookup,
+ *  and the results are cached for a while, so that thousands of connections
+ *  that reconnect at once (for example after a broker failover) cost only
+ *  one lookup. Numeric addresses are resolved right away without a thread.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <arpa/inet.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
+#include "eventfd.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  An address that a socket can connect to
+ */
+struct Endpoint
+{
+    /**
+     *  Parameters for the call to socket()
+     *  @var int
+     */
+    int family;
+    int socktype;
+    int protocol;
+
+    /**
+     *  The address, and its size
+     *  @var struct sockaddr_storage
+     *  @var socklen_t
+     */
+    struct sockaddr_storage address;
+    socklen_t length;
+};
+
+/**
+ *  A lookup of a single connection
+ */
+class Lookup
+{
+private:
+    /**
+     *  Filedescriptor that becomes readable when the lookup is done
+     *  @var EventFd
+     */
+    EventFd _notify;
+
+    /**
+     *  Is the lookup done?
+     *  @var std::atomic<bool>
+     */
+    std::atomic<bool> _done{false};
+
+    /**
+     *  The addresses that were found
+     *  @var std::vector<Endpoint>
+     */
+    std::vector<Endpoint> _endpoints;
+
+    /**
+     *  The error if the hostname could not be resolved
+     *  @var std::string
+     */
+    std::string _error;
+
+public:
+    /**
+     *  Filedescriptor that becomes readable when the lookup is done
+     *  @return int
+     */
+    int fileno() const { return _notify.fileno(); }
+
+    /**
+     *  Store the result (called once, by any thread)
+     *  @param  endpoints   the addresses that were found
+     *  @param  error       the error if nothing was found
+     */
+    void complete(const std::vector<Endpoint> &endpoints, const std::string &error)
+    {
+        // store the result
+        _endpoints = endpoints;
+        _error = error;
+
+        // the result can now be read by the event loop thread
+        _done.store(true, std::memory_order_release);
+
+        // wake up the event loop
+        _notify.notify();
+    }
+
+    /**
+     *  Is the lookup done? (called by the event loop thread)
+     *  @return bool
+     */
+    bool done()
+    {
+        // make the filedescriptor unreadable
+        _notify.reset();
+
+        // check if the result was stored
+        return _done.load(std::memory_order_acquire);
+    }
+
+    /**
+     *  The addresses and the error (only valid when the lookup is done)
+     *  @return std::vector<Endpoint>
+     *  @return std::string
+     */
+    std::vector<Endpoint> &endpoints() { return _endpoints; }
+    const std::string &error() const { return _error; }
+};
+
+/**
+ *  Class definition
+ */
+class ResolverPool
+{
+private:
+    /**
+     *  Max number of threads
+     *  @var size_t
+     */
+    static const size_t _max = 4;
+
+    /**
+     *  Number of seconds that a result is cached
+     *  @var std::chrono::seconds
+     */
+    const std::chrono::seconds _ttl{60};
+
+    /**
+     *  A cached result
+     */
+    struct Entry
+    {
+        std::vector<Endpoint> endpoints;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    /**
+     *  Lock that protects all members below
+     *  @var std::mutex
+     */
+    std::mutex _mutex;
+
+    /**
+     *  Condition that is signalled when there is a job, or when the threads must stop
+     *  @var std::condition_variable
+     */
+    std::condition_variable _condition;
+
+    /**
+     *  The threads, and the number of threads that are waiting for a job
+     *  @var std::vector<std::thread>
+     *  @var size_t
+     */
+    std::vector<std::thread> _threads;
+    size_t _idle = 0;
+
+    /**
+     *  Keys of the hostnames that still have to be looked up
+     *  @var std::deque<std::string>
+     */
+    std::deque<std::string> _jobs;
+
+    /**
+     *  The lookups that wait for a hostname that is being looked up
+     *  @var std::unordered_map
+     */
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Lookup>>> _waiting;
+
+    /**
+     *  The cached results
+     *  @var std::unordered_map
+     */
+    std::unordered_map<std::string, Entry> _cache;
+
+    /**
+     *  Should the threads stop?
+     *  @var bool
+     */
+    bool _stop = false;
+
+    /**
+     *  Look up a hostname
+     *  @param  key         hostname and port, separated by a space
+     *  @param  endpoints   vector to fill
+     *  @return std::string the error, empty on success
+     */
+    static std::string lookup(const std::string &key, std::vector<Endpoint> &endpoints)
+    {
+        // the key holds the port and the hostname
+        auto separator = key.find(' ');
+
+        // prevent exceptions
+        try
+        {
+            // get address info
+            AddressInfo addresses(key.substr(separator + 1).data(), std::stoi(key.substr(0, separator)));
+
+            // copy the addresses
+            for (size_t i = 0; i < addresses.size(); ++i)
+            {
+                // the address
+                Endpoint endpoint;
+                endpoint.family = addresses[i]->ai_family;
+                endpoint.socktype = addresses[i]->ai_socktype;
+                endpoint.protocol = addresses[i]->ai_protocol;
+                endpoint.length = std::min((socklen_t)sizeof(endpoint.address), addresses[i]->ai_addrlen);
+                memcpy(&endpoint.address, addresses[i]->ai_addr, endpoint.length);
+
+                // add it
+                endpoints.push_back(endpoint);
+            }
+
+            // done
+            return endpoints.empty() ? "no addresses found" : "";
+        }
+        catch (const std::runtime_error &error)
+        {
+            // address could not be resolved
+            return error.what();
+        }
+    }
+
+    /**
+     *  Run a thread
+     */
+    void run()
+    {
+        // lock the members
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        // keep running until the pool is destructed
+        while (true)
+        {
+            // wait for a job
+            ++_idle;
+            _condition.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+            --_idle;
+
+            // leap out if we have to stop
+            if (_stop) return;
+
+            // take the job
+            auto key = std::move(_jobs.front());
+            _jobs.pop_front();
+
+            // do the lookup without the lock
+            lock.unlock();
+            std::vector<Endpoint> endpoints;
+            auto error = lookup(key, endpoints);
+            lock.lock();
+
+            // cache the result (errors are not cached, the next connection tries again)
+            if (error.empty()) _cache[key] = Entry{ endpoints, std::chrono::steady_clock::now() + _ttl };
+
+            // take out the lookups that were waiting for this hostname
+            auto waiting = std::move(_waiting[key]);
+            _waiting.erase(key);
+
+            // pass the result to the lookups
+            for (auto &lookup : waiting) lookup->complete(endpoints, error);
+        }
+    }
+
+    /**
+     *  Constructor
+     */
+    ResolverPool() = default;
+
+public:
+    /**
+     *  No copying
+     *  @param  that
+     */
+    ResolverPool(const ResolverPool &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~ResolverPool()
+    {
+        // tell the threads to stop
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _condition.notify_all();
+
+        // wait for them
+        for (auto &thread : _threads) thread.join();
+    }
+
+    /**
+     *  The pool that is shared by all connections
+     *  @return ResolverPool
+     */
+    static ResolverPool &instance()
+    {
+        // the pool is constructed the first time that it is needed
+        static ResolverPool pool;
+
+        // expose it
+        return pool;
+    }
+
+    /**
+     *  Start a lookup
+     *  @param  hostname    the hostname to look up
+     *  @param  port        the port to connect to
+     *  @return std::shared_ptr<Lookup>
+     */
+    std::shared_ptr<Lookup> resolve(const std::string &hostname, uint16_t port)
+    {
+        // the lookup
+        auto result = std::make_shared<Lookup>();
+
+        // the key in the cache
+        std::string key = std::to_string(port) + " " + hostname;
+
+        // numeric addresses are resolved right away, without a thread
+        char buffer[sizeof(struct in6_addr)];
+        if (inet_pton(AF_INET, hostname.data(), buffer) == 1 || inet_pton(AF_INET6, hostname.data(), buffer) == 1)
+        {
+            // do the lookup
+            std::vector<Endpoint> endpoints;
+            auto error = lookup(key, endpoints);
+
+            // store the result
+            result->complete(endpoints, error);
+            return result;
+        }
+
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // is the hostname in the cache?
+        auto iter = _cache.find(key);
+        if (iter != _cache.end() && iter->second.expires > std::chrono::steady_clock::now())
+        {
+            // use the cached result
+            result->complete(iter->second.endpoints, "");
+            return result;
+        }
+
+        // wait for the lookup, skip the rest if the hostname is already being looked up
+        auto &waiting = _waiting[key];
+        waiting.push_back(result);
+        if (waiting.size() > 1) return result;
+
+        // add the job
+        _jobs.push_back(std::move(key));
+
+        // start a new thread if all threads are busy
+        if (_idle < _jobs.size() && _threads.size() < _max) _threads.emplace_back(&ResolverPool::run, this);
+
+        // wake up a thread
+        _condition.notify_one();
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Remove a hostname from the cache (because none of its addresses could be reached)
+     *  @param  hostname    the hostname
+     *  @param  port        the port
+     */
+    void forget(const std::string &hostname, uint16_t port)
+    {
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // remove from the cache
+        _cache.erase(std::to_string(port) + " " + hostname);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -16,6 +16,7 @@
  */
 #include "tcpoutbuffer.h"
 #include "tcpinbuffer.h"
+#include "tcpbodybuffer.h"
 #include "poll.h"
 #include "sslwrapper.h"
 #include "sslshutdown.h"
@@ -48,6 +49,12 @@ private:
      *  @var TcpInBuffer
      */
     TcpInBuffer _in;
+
+    /**
+     *  Body frame of which the payload is being received straight into a message
+     *  @var std::unique_ptr<TcpBodyBuffer>
+     */
+    std::unique_ptr<TcpBodyBuffer> _body;
     
     /**
      *  Are we now busy with sending or receiving?
@@ -65,12 +72,145 @@ private:
      *  @var bool
      */
     bool _closed = false;
+
+    /**
+     *  Is there data in the input buffer that was not parsed because processing was paused?
+     *  @var bool
+     */
+    bool _stalled = false;
     
     /**
      *  Cached reallocation instruction
      *  @var size_t
      */
     size_t _reallocate = 0;
+
+    /**
+     *  Max number of bytes in a tls record
+     *  @var size_t
+     */
+    static constexpr size_t recordsize = 16384;
+
+    /**
+     *  A single buffer that can be passed to encrypt()
+     */
+    struct Contiguous
+    {
+        const char *buffer;
+        size_t bytes;
+        size_t count() const { return 1; }
+        const char *data(size_t) const { return buffer; }
+        size_t size(size_t) const { return bytes; }
+    };
+
+    /**
+     *  Encrypt and send one record
+     *  @param  data        the data for the record
+     *  @param  size        size of the data (at most recordsize)
+     *  @param  error       the result of SSL_get_error() on failure
+     *  @return bool
+     */
+    bool record(const char *data, size_t size, int &error)
+    {
+        // clear ssl-level error
+        OpenSSL::ERR_clear_error();
+
+        // send the record, and we are done if it was sent
+        int result = OpenSSL::SSL_write(_ssl, data, size);
+        if (result > 0) return true;
+
+        // find out what went wrong
+        error = OpenSSL::SSL_get_error(_ssl, result);
+        return false;
+    }
+
+    /**
+     *  Encrypt and send segments of data in records of at most 16KB. Small segments
+     *  (like the frames of a publish) are combined into one record, instead of each
+     *  of them costing a record header and a MAC. Every call to SSL_write() sends a
+     *  single record, so that a call that fails can be repeated later with the data
+     *  from the outgoing buffer (openssl needs the same data and at least as much).
+     *  @param  source      the segments (a GatherBuffer or a Contiguous buffer)
+     *  @param  error       the result of SSL_get_error() on failure
+     *  @return size_t      number of bytes sent, the rest must be buffered
+     */
+    template <typename SOURCE>
+    size_t encrypt(const SOURCE &source, int &error)
+    {
+        // the record that is assembled from small segments, and the number of bytes in it
+        char assembled[recordsize];
+        size_t fill = 0;
+
+        // number of bytes sent
+        size_t total = 0;
+
+        // iterate over the segments
+        for (size_t i = 0; i < source.count(); ++i)
+        {
+            // the data of the segment
+            const char *data = source.data(i);
+            size_t size = source.size(i);
+
+            // keep looping until the segment is used up
+            while (size > 0)
+            {
+                // a segment that fills a record by itself is sent without copying it
+                if (fill == 0 && size >= recordsize)
+                {
+                    // send the record
+                    if (!record(data, recordsize, error)) return total;
+
+                    // move on
+                    data += recordsize;
+                    size -= recordsize;
+                    total += recordsize;
+                }
+                else
+                {
+                    // copy as much as fits in the record
+                    size_t bytes = std::min(size, recordsize - fill);
+                    memcpy(assembled + fill, data, bytes);
+
+                    // move on
+                    data += bytes;
+                    size -= bytes;
+                    fill += bytes;
+
+                    // wait for more data if the record is not yet full
+                    if (fill < recordsize) continue;
+
+                    // send the record
+                    if (!record(assembled, fill, error)) return total;
+
+                    // the record is empty again
+                    total += fill;
+                    fill = 0;
+                }
+            }
+        }
+
+        // send the last record
+        if (fill > 0 && record(assembled, fill, error)) total += fill;
+
+        // done
+        return total;
+    }
+
+    /**
+     *  Method that is called after encrypt() could not send all data
+     *  @param  error       the result of SSL_get_error()
+     */
+    void blocked(int error)
+    {
+        // the operation failed, we may have to repeat our call. this may detect that
+        // ssl is in an error state, however that is ok because it will set an internal 
+        // state to the error state so that on the next calls to state-changing objects, 
+        // the tcp socket will be torn down
+        if (repeat(state_sending, error)) return;
+
+        // the repeat call failed, so we are going to find out with a readable file descriptor
+        _parent->onIdle(this, _socket, readable);
+    }
     
 
     /**
@@ -93,8 +233,8 @@ private:
         }
         else
         {
-            // let's wait until the socket becomes readable
-            _parent->onIdle(this, _socket, readable);
+            // let's wait until the socket becomes readable (unless processing is paused)
+            _parent->onIdle(this, _socket, events(false));
         }
         
         // done
@@ -182,6 +322,9 @@ private:
      */
     TcpState *parse(const Monitor &monitor, size_t size)
     {
+        // is the payload of a body frame being received straight into a message?
+        if (_body) return complete(monitor);
+
         // we need a local copy of the buffer - because it is possible that "this"
         // object gets destructed halfway through the call to the parse() method
         TcpInBuffer buffer(std::move(_in));
@@ -199,17 +342,47 @@ private:
         _in = std::move(buffer);
         
         // do we have to reallocate?
-        if (!_reallocate) return this;
-        
-        // reallocate the buffer
-        _in.reallocate(_reallocate); 
+        if (_reallocate) _in.reallocate(_reallocate); 
         
         // we can remove the reallocate instruction
         _reallocate = 0;
+
+        // if processing was paused, the rest of the buffer is parsed after it is resumed
+        _stalled = _parent->paused();
+
+        // check if the payload of the next frame can be received straight into a message
+        if (!_stalled) _body.reset(TcpBodyBuffer::create(_parent, _in));
         
         // done
         return this;
     }
+
+    /**
+     *  Parse a body frame of which the payload was received straight into the message
+     *  @param  monitor     object to check the existance of the connection object
+     *  @return TcpState
+     */
+    TcpState *complete(const Monitor &monitor)
+    {
+        // wait for more data if the frame is not yet complete
+        if (!_body->complete()) return this;
+
+        // the start of the frame in the input buffer is no longer needed
+        _in.shrink(_in.size());
+
+        // we need a local copy of the buffer - because it is possible that "this"
+        // object gets destructed halfway through the call to the parse() method
+        std::unique_ptr<TcpBodyBuffer> body(std::move(_body));
+
+        // the message could have been destructed after the last read
+        body->verify(_parent);
+
+        // parse the frame
+        _parent->onReceived(this, *body);
+
+        // "this" could be removed by now
+        return monitor.valid() ? this : nullptr;
+    }
     
     /**
      *  Check if the socket is readable
@@ -267,7 +440,7 @@ private:
         while (_out && !isReadable());
         
         // proceed with the read operation or the event loop
-        return isReadable() ? receive(monitor) : proceed();
+        return isReadable() && !_parent->paused() ? receive(monitor) : proceed();
     }
 
     /**
@@ -287,8 +460,12 @@ private:
             // assume default state
             _state = state_idle;
 
-            // read data from ssl into the buffer
-            auto result = _in.receivefrom(_ssl, _parent->expected());
+            // make sure that the message still exists if we read straight into it
+            if (_body) _body->verify(_parent);
+
+            // read data from ssl into the buffer (or straight into a message), unless the buffer
+            // holds data that was not yet parsed because processing was paused
+            auto result = _stalled ? 1 : _body ? _body->receivefrom(_ssl) : _in.receivefrom(_ssl, _parent->expected());
             
             // if this is a failure, we are going to repeat the operation
             if (result <= 0) return repeat(monitor, state_receiving, OpenSSL::SSL_get_error(_ssl, result));
@@ -299,7 +476,7 @@ private:
             // leap out if we moved to a different state
             if (nextstate != this) return nextstate;
         }
-        while (OpenSSL::SSL_pending(_ssl) > 0);
+        while (!_parent->paused() && OpenSSL::SSL_pending(_ssl) > 0);
         
         // proceed with the write operation or the event loop
         return _out && isWritable() ? write(monitor) : proceed();
@@ -317,7 +494,7 @@ public:
         TcpExtState(state),
         _ssl(std::move(ssl)),
         _out(std::move(buffer)),
-        _in(4096),
+        _in(_parent->allocator(), 4096),
         _state(_out ? state_sending : state_idle)
     {
         // tell the handler to monitor the socket if there is an out
@@ -335,6 +512,13 @@ public:
      */
     virtual std::size_t queued() const override { return _out.size(); }
 
+    /**
+     *  The high and low watermarks of the output buffer
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const override { return _out.high(); }
+    virtual std::size_t lowWatermark() const override { return _out.low(); }
+
     /**
      *  Process the filedescriptor in the object
      *  @param  monitor     Object that can be used to find out if connection object is still alive
@@ -356,6 +540,9 @@ public:
         // if we are in an error state, we close the tcp connection
         if (_state == state_error) return new TcpClosed(this);
         
+        // if processing is paused, we only write (and stop monitoring for readability)
+        if (_parent->paused()) return _out ? write(monitor) : proceed();
+
         // if the socket is readable, we are going to receive data
         if (flags & readable) return receive(monitor);
         
@@ -381,29 +568,105 @@ public:
         // if we're not idle, we can just add bytes to the buffer and we're done
         if (_state != state_idle) return _out.add(buffer, size);
 
-        // clear ssl-level error
-        OpenSSL::ERR_clear_error();
+        // when output is corked, small data is held back in the buffer
+        if (corked(size))
+        {
+            // remember if the buffer was empty
+            bool empty = !_out;
 
-        // get the result
-        int result = OpenSSL::SSL_write(_ssl, buffer, size);  
+            // add the data to the buffer
+            _out.add(buffer, size);
 
-        // if the result is larger than zero, we are successful
-        if (result > 0) return; 
-            
-        // check for error
-        auto error = OpenSSL::SSL_get_error(_ssl, result);
+            // check if the buffer should be flushed
+            return held(empty, _out.size());
+        }
 
-        // put the data in the outgoing buffer
-        _out.add(buffer, size);
+        // data that was held back must be sent first
+        if (_out && _parent->corked() > 0) flush();
 
-        // the operation failed, we may have to repeat our call. this may detect that
-        // ssl is in an error state, however that is ok because it will set an internal 
-        // state to the error state so that on the next calls to state-changing objects, 
-        // the tcp socket will be torn down
-        if (repeat(state_sending, error)) return;
+        // is there already a buffer of data that can not be sent?
+        if (_out) return _out.add(buffer, size);
 
-        // the repeat call failed, so we are going to find out with a readable file descriptor
-        _parent->onIdle(this, _socket, readable);
+        // send the data right away
+        int error = SSL_ERROR_NONE;
+        size_t bytes = encrypt(Contiguous{ buffer, size }, error);
+
+        // ok if all data was sent
+        if (bytes >= size) return;
+
+        // put the rest of the data in the outgoing buffer
+        _out.add(buffer + bytes, size - bytes);
+
+        // wait until we can go on
+        blocked(error);
+    }
+
+    /**
+     *  Send a group of segments over the connection
+     *  @param  buffer      buffer with segments to send
+     */
+    virtual void send(const GatherBuffer &buffer) override
+    {
+        // do nothing if already busy closing
+        if (_closed) return;
+
+        // if we're not idle, we can just add the segments to the buffer and we're done
+        if (_state != state_idle) return _out.add(buffer);
+
+        // when output is corked, small groups are held back in the buffer
+        if (corked(buffer.size()))
+        {
+            // remember if the buffer was empty
+            bool empty = !_out;
+
+            // add the segments to the buffer
+            _out.add(buffer);
+
+            // check if the buffer should be flushed
+            return held(empty, _out.size());
+        }
+
+        // data that was held back must be sent first
+        if (_out && _parent->corked() > 0) flush();
+
+        // is there already a buffer of data that can not be sent?
+        if (_out) return _out.add(buffer);
+
+        // send the segments right away
+        int error = SSL_ERROR_NONE;
+        size_t bytes = encrypt(buffer, error);
+
+        // ok if all data was sent
+        if (bytes >= buffer.size()) return;
+
+        // put the rest of the data in the outgoing buffer
+        _out.add(buffer, bytes);
+
+        // wait until we can go on
+        blocked(error);
+    }
+
+    /**
+     *  Flush the data that is held back in the outgoing buffer
+     *
+     *  Errors are not reported here, they will be noticed the next time that
+     *  the socket becomes active. The socket stays monitored for writability,
+     *  so that a possible remainder is sent when the socket becomes writable.
+     */
+    virtual void flush() override
+    {
+        // if an operation is in progress, the data is sent when it is done
+        if (_state != state_idle) return;
+
+        // send out the buffered data, one record at a time
+        while (_out)
+        {
+            // send a record
+            auto result = _out.sendto(_ssl);
+
+            // on failure we have to wait until we can go on
+            if (result <= 0) return blocked(OpenSSL::SSL_get_error(_ssl, result));
+        }
     }
 
     /**
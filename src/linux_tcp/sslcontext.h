@@ -61,6 +61,21 @@ public:
         OpenSSL::SSL_CTX_free(_ctx);
     }
     
+    /**
+     *  The context that is used by all connections for which the TcpHandler
+     *  does not supply one (sharing it allows sessions to be resumed)
+     *  @return SSL_CTX *
+     *  @throws std::runtime_error
+     */
+    static SSL_CTX *shared()
+    {
+        // the context is constructed the first time that it is needed
+        static SslContext context(OpenSSL::TLS_client_method());
+
+        // expose it
+        return context;
+    }
+
     /**
      *  Cast to the actual context
      *  @return SSL_CTX *
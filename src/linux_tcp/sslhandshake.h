@@ -20,6 +20,8 @@
 #include "poll.h"
 #include "sslwrapper.h"
 #include "sslcontext.h"
+#include "sslsessions.h"
+#include <chrono>
 
 /**
  *  Set up namespace
@@ -43,8 +45,52 @@ private:
      *  @var TcpOutBuffer
      */
     TcpOutBuffer _out;
-    
-    
+
+    /**
+     *  The hostname, to look up the session to resume
+     *  @var std::string
+     */
+    std::string _hostname;
+
+    /**
+     *  When the handshake was started
+     *  @var std::chrono::steady_clock::time_point
+     */
+    std::chrono::steady_clock::time_point _started;
+
+    /**
+     *  The context to use: the one from the handler, or the context that is shared by all connections
+     *  @return SSL_CTX
+     *  @throws std::runtime_error
+     */
+    SSL_CTX *context()
+    {
+        // ask the handler
+        SSL_CTX *ctx = _parent->context(this);
+
+        // new sessions of the context must end up in the cache
+        return SslSessions::instance().prepare(ctx ? ctx : SslContext::shared());
+    }
+
+    /**
+     *  Did the kernel take over the encryption in at least one direction? This
+     *  only happens if SSL_OP_ENABLE_KTLS was set on the context, and if the kernel
+     *  and openssl support kTLS for the negotiated cipher and protocol version
+     *  (openssl 3.0 for example only does tls 1.3 in the sending direction)
+     *  @return bool
+     */
+    bool offloaded() const
+    {
+#if defined(BIO_CTRL_GET_KTLS_SEND) && defined(BIO_CTRL_GET_KTLS_RECV)
+        // check both directions (BIO_get_ktls_send() and BIO_get_ktls_recv() are macros around BIO_ctrl())
+        return OpenSSL::BIO_ctrl(OpenSSL::SSL_get_wbio(_ssl), BIO_CTRL_GET_KTLS_SEND, 0, nullptr) > 0 ||
+               OpenSSL::BIO_ctrl(OpenSSL::SSL_get_rbio(_ssl), BIO_CTRL_GET_KTLS_RECV, 0, nullptr) > 0;
+#else
+        // the openssl headers that we were compiled with do not know about ktls
+        return false;
+#endif
+    }
+
     /**
      *  Report a new state
      *  @param  monitor
@@ -52,12 +98,20 @@ private:
      */
     TcpState *nextstate(const Monitor &monitor)
     {
+        // update the statistics
+        SslSessions::instance().succeeded(OpenSSL::SSL_session_reused(_ssl) == 1, std::chrono::steady_clock::now() - _started);
+
         // check if the handler allows the connection
         bool allowed = _parent->onSecured(this, _ssl);
         
         // leap out if the user space function destructed the object
         if (!monitor.valid()) return nullptr;
 
+        // we only count the connections for which the kernel does the encryption, the data
+        // still goes through openssl, because openssl also has to handle the records that
+        // do not hold application data (like session tickets, key updates and close_notify)
+        if (allowed && offloaded()) SslSessions::instance().offloaded();
+
         // if connection is allowed, we move to the next state
         if (allowed) return new SslConnected(this, std::move(_ssl), std::move(_out));
         
@@ -78,6 +132,12 @@ private:
      */
     TcpState *reportError(const Monitor &monitor)
     {
+        // update the statistics
+        SslSessions::instance().failed();
+
+        // the session that we offered could be the problem, the next connection starts from scratch
+        SslSessions::instance().forget(_ssl, _hostname);
+
         // we have an error - report this to the user
         _parent->onError(this, "failed to setup ssl connection");
         
@@ -107,20 +167,29 @@ public:
      *  Constructor
      *  @param  state       Earlier state
      *  @param  hostname    The hostname to connect to
-     *  @param  context     SSL context
      *  @param  buffer      The buffer that was already built
      *  @throws std::runtime_error
      */
     SslHandshake(TcpExtState *state, const std::string &hostname, TcpOutBuffer &&buffer) : 
         TcpExtState(state),
-        _ssl(SslContext(OpenSSL::TLS_client_method())),
-        _out(std::move(buffer))
+        _ssl(context()),
+        _out(std::move(buffer)),
+        _hostname(hostname),
+        _started(std::chrono::steady_clock::now())
     {
         // we will be using the ssl context as a client
         OpenSSL::SSL_set_connect_state(_ssl);
+
+        // writes that have to be repeated are repeated from a different buffer, this is set for the
+        // connection because the context could come from the handler. note that SSL_set_mode is a
+        // macro that expands to SSL_ctrl, so that is the real function that is used
+        OpenSSL::SSL_set_mode(_ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
         
         // associate domain name with the connection
         OpenSSL::SSL_ctrl(_ssl, SSL_CTRL_SET_TLSEXT_HOSTNAME, TLSEXT_NAMETYPE_host_name, (void *)hostname.data());
+
+        // try to resume the session of an earlier connection to the same host
+        SslSessions::instance().resume(_ssl, hostname);
         
         // associate the ssl context with the socket filedescriptor
         if (OpenSSL::SSL_set_fd(_ssl, _socket) == 0) throw std::runtime_error("failed to associate filedescriptor with ssl socket");
@@ -139,6 +208,13 @@ public:
      *  @return std::size_t
      */
     virtual std::size_t queued() const override { return _out.size(); }
+
+    /**
+     *  The high and low watermarks of the output buffer
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const override { return _out.high(); }
+    virtual std::size_t lowWatermark() const override { return _out.low(); }
     
     /**
      *  Process the filedescriptor in the object
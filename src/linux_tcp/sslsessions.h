@@ -0,0 +1,341 @@
+/**
+ *  SslSessions.h
+ *
+ *  Client-side cache of TLS sessions, shared by all connections in the
+ *  process. When a connection gets a session (or, with TLS 1.3, a session
+ *  ticket) from the server, it is stored here, and the next connection to
+ *  the same host with the same SSL_CTX offers it to the server, so that the
+ *  handshake can resume the session instead of doing a full handshake. The
+ *  sessions are stored with the SSL_CTX itself (as application data of the
+ *  context), so they are released together with the context. The cache also
+ *  keeps the statistics of the handshakes.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <map>
+#include <mutex>
+#include <chrono>
+#include "openssl.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class SslSessions
+{
+private:
+    /**
+     *  The sessions of one context, by hostname
+     */
+    struct Store
+    {
+        /**
+         *  Lock that protects the sessions
+         *  @var std::mutex
+         */
+        std::mutex mutex;
+
+        /**
+         *  The sessions
+         *  @var std::map
+         */
+        std::map<std::string, SSL_SESSION*> sessions;
+
+        /**
+         *  Destructor
+         */
+        ~Store()
+        {
+            // release the sessions
+            for (auto &entry : sessions) OpenSSL::SSL_SESSION_free(entry.second);
+        }
+    };
+
+    /**
+     *  Index under which the stores are kept in the contexts (-1 if openssl
+     *  could not give us one, in which case sessions are not cached)
+     *  @var int
+     */
+    int _index;
+
+    /**
+     *  Lock that protects the members below, and the preparation of contexts
+     *  @var std::mutex
+     */
+    std::mutex _mutex;
+
+    /**
+     *  The statistics
+     *  @var TlsMetrics
+     */
+    TlsMetrics _metrics;
+
+    /**
+     *  The store of the context of a connection
+     *  @param  ssl         the connection
+     *  @return Store*      nullptr if the context was not prepared
+     */
+    Store *lookup(const SSL *ssl) const
+    {
+        // without an index there are no stores
+        if (_index < 0) return nullptr;
+
+        // get the store from the context
+        return (Store *)OpenSSL::SSL_CTX_get_ex_data(OpenSSL::SSL_get_SSL_CTX(ssl), _index);
+    }
+
+    /**
+     *  Callback that is called by openssl when a context is freed
+     *  @param  parent      the context
+     *  @param  ptr         the store of the context (or nullptr)
+     *  @param  ad          the application data of the context
+     *  @param  idx         the index
+     *  @param  argl        unused
+     *  @param  argp        unused
+     */
+    static void release(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx, long argl, void *argp)
+    {
+        // make sure compilers dont complain about unused parameters
+        (void) parent;
+        (void) ad;
+        (void) idx;
+        (void) argl;
+        (void) argp;
+
+        // release the store and its sessions (this does not use the instance,
+        // because contexts may be freed after the instance was destructed)
+        delete (Store *)ptr;
+    }
+
+    /**
+     *  Callback that is called by openssl when a connection gets a new session
+     *  @param  ssl         the connection
+     *  @param  session     the session
+     *  @return int         1 if we keep the reference to the session
+     */
+    static int store(SSL *ssl, SSL_SESSION *session)
+    {
+        // the hostname that we connected to
+        const char *hostname = OpenSSL::SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+
+        // without a hostname we can not use the session
+        if (hostname == nullptr) return 0;
+
+        // the store of the context
+        auto *store = instance().lookup(ssl);
+        if (store == nullptr) return 0;
+
+        // lock the sessions
+        std::lock_guard<std::mutex> lock(store->mutex);
+
+        // the slot for the session
+        auto &slot = store->sessions[hostname];
+
+        // the new session replaces the old one
+        if (slot != nullptr) OpenSSL::SSL_SESSION_free(slot);
+
+        // store the session, we keep the reference that openssl gave us
+        slot = session;
+        return 1;
+    }
+
+    /**
+     *  Add a sample to an average
+     *  @param  average
+     *  @param  count       number of samples, including this one
+     *  @param  sample
+     */
+    static void sample(double &average, size_t count, double sample)
+    {
+        average += (sample - average) / count;
+    }
+
+    /**
+     *  Constructor
+     */
+    SslSessions() : _index(OpenSSL::CRYPTO_get_ex_new_index(CRYPTO_EX_INDEX_SSL_CTX, 0, nullptr, nullptr, nullptr, &SslSessions::release)) {}
+
+public:
+    /**
+     *  No copying
+     *  @param  that
+     */
+    SslSessions(const SslSessions &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~SslSessions() {}
+
+    /**
+     *  The cache that is shared by all connections
+     *  @return SslSessions
+     */
+    static SslSessions &instance()
+    {
+        // the cache is constructed the first time that it is needed
+        static SslSessions sessions;
+
+        // expose it
+        return sessions;
+    }
+
+    /**
+     *  Make sure that a context hands out its new sessions to the cache (the
+     *  context should not be destructed while connections are still using it,
+     *  the sessions of the context are released when the context is freed)
+     *  @param  ctx         the context
+     *  @return SSL_CTX*    the same context
+     */
+    SSL_CTX *prepare(SSL_CTX *ctx)
+    {
+        // without an index we can not store sessions with the context
+        if (_index < 0) return ctx;
+
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // skip if the context was already prepared
+        if (OpenSSL::SSL_CTX_get_ex_data(ctx, _index) != nullptr) return ctx;
+
+        // the store for the sessions, which is released by openssl together with the context
+        auto *store = new Store();
+
+        // store it with the context
+        if (OpenSSL::SSL_CTX_set_ex_data(ctx, _index, store) != 1)
+        {
+            // without a store, the context does not cache sessions
+            delete store;
+            return ctx;
+        }
+
+        // openssl should not keep its own client cache (it does not use it anyway), but it
+        // should call our callback. note that SSL_CTX_set_session_cache_mode is a macro that
+        // expands to SSL_CTX_ctrl, so that is the real function that is used
+        OpenSSL::SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        OpenSSL::SSL_CTX_sess_set_new_cb(ctx, &SslSessions::store);
+
+        // done
+        return ctx;
+    }
+
+    /**
+     *  Offer the cached session (if there is one) to the server
+     *  @param  ssl         the connection that is about to start its handshake
+     *  @param  hostname    the hostname that we connect to
+     *  @return bool        was a session offered?
+     */
+    bool resume(SSL *ssl, const std::string &hostname)
+    {
+        // the store of the context
+        auto *store = lookup(ssl);
+        if (store == nullptr) return false;
+
+        // lock the sessions
+        std::lock_guard<std::mutex> lock(store->mutex);
+
+        // find the session
+        auto iter = store->sessions.find(hostname);
+        if (iter == store->sessions.end()) return false;
+
+        // offer it (this increments the refcount of the session)
+        return OpenSSL::SSL_set_session(ssl, iter->second) == 1;
+    }
+
+    /**
+     *  Remove the session of a host (because the handshake failed)
+     *  @param  ssl         the connection
+     *  @param  hostname    the hostname
+     */
+    void forget(SSL *ssl, const std::string &hostname)
+    {
+        // the store of the context
+        auto *store = lookup(ssl);
+        if (store == nullptr) return;
+
+        // lock the sessions
+        std::lock_guard<std::mutex> lock(store->mutex);
+
+        // find the session
+        auto iter = store->sessions.find(hostname);
+        if (iter == store->sessions.end()) return;
+
+        // release it
+        OpenSSL::SSL_SESSION_free(iter->second);
+        store->sessions.erase(iter);
+    }
+
+    /**
+     *  Register a handshake that succeeded
+     *  @param  resumed     was an earlier session resumed?
+     *  @param  duration    duration of the handshake
+     */
+    void succeeded(bool resumed, std::chrono::steady_clock::duration duration)
+    {
+        // number of microseconds
+        double micro = std::chrono::duration<double, std::micro>(duration).count();
+
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // update the statistics
+        if (resumed) sample(_metrics.resumedTime, ++_metrics.resumed, micro);
+        else sample(_metrics.fullTime, ++_metrics.full, micro);
+    }
+
+    /**
+     *  Register a connection for which the kernel took over the encryption (in
+     *  at least one direction)
+     */
+    void offloaded()
+    {
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // update the statistics
+        ++_metrics.kernel;
+    }
+
+    /**
+     *  Register a handshake that failed
+     */
+    void failed()
+    {
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // update the statistics
+        ++_metrics.failed;
+    }
+
+    /**
+     *  The statistics
+     *  @return TlsMetrics
+     */
+    TlsMetrics metrics()
+    {
+        // lock the members
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // expose a copy
+        return _metrics;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
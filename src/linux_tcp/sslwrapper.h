@@ -67,6 +67,12 @@ public:
     {
         // do nothing if already moved away
         if (_ssl == nullptr) return;
+
+        // openssl refuses to resume the session of a connection that was not shut down properly (for
+        // example because the broker went away), but since tls 1.1 this is allowed, and it is exactly
+        // what we need when many connections reconnect at once (sessions of connections that failed
+        // with a fatal alert are still not resumed, openssl already invalidated those)
+        OpenSSL::SSL_set_shutdown(_ssl, OpenSSL::SSL_get_shutdown(_ssl) | SSL_SENT_SHUTDOWN);
         
         // destruct object
         OpenSSL::SSL_free(_ssl);
@@ -0,0 +1,284 @@
+/**
+ *  TcpBodyBuffer.h
+ *
+ *  Buffer for a body frame of which the payload is received straight into
+ *  the memory of the message that is being consumed. The frame header is
+ *  copied into this object, the payload is stored in the message, and the
+ *  end-of-frame byte is stored in this object again. Once the frame is
+ *  complete, the buffer is passed to the connection to be parsed like any
+ *  other buffer, and because the payload is already in place, it is not
+ *  copied into the message.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <sys/uio.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class TcpBodyBuffer : public Buffer
+{
+private:
+    /**
+     *  The frame header
+     *  @var char[]
+     */
+    char _header[7];
+
+    /**
+     *  The channel number from the header
+     *  @var uint16_t
+     */
+    uint16_t _channel;
+
+    /**
+     *  Memory for the payload
+     *  @var char *
+     */
+    char *_payload;
+
+    /**
+     *  Size of the payload
+     *  @var uint32_t
+     */
+    uint32_t _size;
+
+    /**
+     *  The end-of-frame byte
+     *  @var char
+     */
+    char _trailer = 0;
+
+    /**
+     *  Number of bytes received after the header (payload + trailer)
+     *  @var uint32_t
+     */
+    uint32_t _received = 0;
+
+    /**
+     *  Private memory for the payload, in case the message is no longer available
+     *  @var std::vector<char>
+     */
+    std::vector<char> _private;
+
+    /**
+     *  Helper buffer for data() calls that span multiple parts
+     *  @var std::vector<char>
+     */
+    mutable std::vector<char> _scratch;
+
+    /**
+     *  Update the number of received bytes
+     *  @param  result      result of the read operation
+     *  @return ssize_t
+     */
+    ssize_t update(ssize_t result)
+    {
+        // update number of bytes received on success
+        if (result > 0) _received += result;
+
+        // pass on the result
+        return result;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  buffer      the buffer holding the header (and maybe the start of the payload)
+     *  @param  channel     the channel number from the header
+     *  @param  payload     memory where the payload should be stored
+     *  @param  size        size of the payload
+     */
+    TcpBodyBuffer(const Buffer &buffer, uint16_t channel, char *payload, uint32_t size) : 
+        _channel(channel), _payload(payload), _size(size)
+    {
+        // copy the header
+        buffer.copy(0, 7, _header);
+
+        // the buffer may already hold the start of the payload
+        _received = std::min((uint32_t)(buffer.size() - 7), size);
+
+        // copy that as well
+        buffer.copy(7, _received, _payload);
+    }
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    TcpBodyBuffer(const TcpBodyBuffer &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~TcpBodyBuffer() {}
+
+    /**
+     *  Create a body buffer if the payload of the frame that is being received
+     *  can be received straight into a message
+     *  @param  parent      the parent object that knows where the payload should go
+     *  @param  buffer      buffer holding the start of the frame
+     *  @return TcpBodyBuffer*
+     */
+    static TcpBodyBuffer *create(TcpParent *parent, const Buffer &buffer)
+    {
+        // we need the full header of a body frame
+        if (buffer.size() < 7 || buffer.byte(0) != 3) return nullptr;
+
+        // decode the channel and the payload size
+        uint16_t channel; uint32_t size;
+        buffer.copy(1, sizeof(uint16_t), &channel);
+        buffer.copy(3, sizeof(uint32_t), &size);
+        channel = be16toh(channel);
+        size = be32toh(size);
+
+        // empty payloads and frames that were already received are not interesting
+        if (size == 0 || buffer.size() >= size + 8) return nullptr;
+
+        // find out where the payload should go
+        char *payload = parent->destination(channel, size);
+
+        // create the buffer if the payload can be received straight into the message
+        return payload ? new TcpBodyBuffer(buffer, channel, payload, size) : nullptr;
+    }
+
+    /**
+     *  Check if the memory for the payload is still valid. Because data is read 
+     *  in multiple iterations of the event loop, user space could have destructed
+     *  the message (by closing the channel or connection) in the meantime. In that
+     *  case the rest of the payload is received in private memory (the frame will
+     *  be ignored by the connection anyway). This should be called before every
+     *  read operation, and before the frame is parsed.
+     *  @param  parent      the parent object that knows where the payload should go
+     */
+    void verify(TcpParent *parent)
+    {
+        // nothing to check if the payload was already redirected
+        if (!_private.empty()) return;
+
+        // is the payload still expected at the same location?
+        if (parent->destination(_channel, _size) == _payload) return;
+
+        // use private memory instead
+        _private.resize(_size);
+        _payload = _private.data();
+    }
+
+    /**
+     *  Is the frame complete?
+     *  @return bool
+     */
+    bool complete() const
+    {
+        // payload and trailer must both have been received
+        return _received > _size;
+    }
+
+    /**
+     *  Total size of the buffer
+     *  @return size_t
+     */
+    virtual size_t size() const override
+    {
+        return 7 + _received;
+    }
+
+    /**
+     *  Get access to a single byte
+     *  @param  pos         position in the buffer
+     *  @return char        value of the byte in the buffer
+     */
+    virtual char byte(size_t pos) const override
+    {
+        // is it in the header, the payload, or is it the trailer?
+        if (pos < 7) return _header[pos];
+        if (pos < 7 + _size) return _payload[pos - 7];
+        return _trailer;
+    }
+
+    /**
+     *  Get access to the raw data
+     *  @param  pos         position in the buffer
+     *  @param  size        number of continuous bytes
+     *  @return char*
+     */
+    virtual const char *data(size_t pos, size_t size) const override
+    {
+        // the data could be entirely in the header or entirely in the payload
+        if (pos + size <= 7) return _header + pos;
+        if (pos >= 7 && pos + size <= 7 + _size) return _payload + pos - 7;
+
+        // otherwise we have to combine the parts
+        _scratch.resize(size);
+
+        // copy the data
+        return (const char *)copy(pos, size, _scratch.data());
+    }
+
+    /**
+     *  Copy bytes to a buffer
+     *  @param  pos         position in the buffer
+     *  @param  size        number of bytes to copy
+     *  @param  buffer      buffer to copy into
+     *  @return void*       pointer to buffer
+     */
+    virtual void *copy(size_t pos, size_t size, void *buffer) const override
+    {
+        // copy byte by byte (this is only used for the small header)
+        for (size_t i = 0; i < size; ++i) ((char *)buffer)[i] = byte(pos + i);
+
+        // done
+        return buffer;
+    }
+
+    /**
+     *  Receive data from a socket
+     *  @param  socket          socket to read from
+     *  @return ssize_t
+     */
+    ssize_t receivefrom(int socket)
+    {
+        // the rest of the payload goes into the message, the trailer into this object
+        struct iovec buffers[2];
+        buffers[0].iov_base = _payload + std::min(_received, _size);
+        buffers[0].iov_len = _size - std::min(_received, _size);
+        buffers[1].iov_base = &_trailer;
+        buffers[1].iov_len = 1;
+
+        // read the data
+        return update(readv(socket, buffers, 2));
+    }
+
+    /**
+     *  Receive data from a ssl connection
+     *  @param  ssl             ssl wrapped socket to read from
+     *  @return ssize_t
+     */
+    ssize_t receivefrom(SSL *ssl)
+    {
+        // is there still payload to receive?
+        if (_received < _size) return update(OpenSSL::SSL_read(ssl, _payload + _received, _size - _received));
+
+        // only the trailer remains
+        return update(OpenSSL::SSL_read(ssl, &_trailer, 1));
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
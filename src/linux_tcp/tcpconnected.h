@@ -18,6 +18,7 @@
  */
 #include "tcpoutbuffer.h"
 #include "tcpinbuffer.h"
+#include "tcpbodybuffer.h"
 #include "tcpextstate.h"
 #include "poll.h"
 
@@ -49,6 +50,12 @@ private:
      *  @var size_t
      */
     size_t _reallocate = 0;
+
+    /**
+     *  Body frame of which the payload is being received straight into a message
+     *  @var std::unique_ptr<TcpBodyBuffer>
+     */
+    std::unique_ptr<TcpBodyBuffer> _body;
     
     /**
      *  Did the user ask to elegantly close the connection?
@@ -56,6 +63,32 @@ private:
      */
     bool _closed = false;
 
+    /**
+     *  Is there data in the input buffer that was not parsed because processing was paused?
+     *  @var bool
+     */
+    bool _stalled = false;
+
+    /**
+     *  The events for which the socket is currently monitored
+     *  @var int
+     */
+    int _events = 0;
+
+    /**
+     *  Tell the parent for which events the socket should be monitored
+     *  (this is skipped if the events did not change)
+     *  @param  events      AMQP::readable and/or AMQP::writable
+     */
+    virtual void watch(int events) override
+    {
+        // skip if nothing changes
+        if (events == _events) return;
+
+        // pass on to the parent
+        _parent->onIdle(this, _socket, _events = events);
+    }
+
     
     /**
      *  Helper method to report an error
@@ -78,6 +111,63 @@ private:
         return true;
     }
     
+    /**
+     *  Write the segments of a gather buffer to the socket
+     *  @param  buffer      the segments to write
+     *  @return size_t      number of bytes written
+     */
+    size_t write(const GatherBuffer &buffer)
+    {
+        // total number of bytes written
+        size_t total = 0;
+
+        // we fill at most 64 buffers at a time
+        struct iovec vectors[64];
+
+        // keep looping until all segments are written
+        for (size_t index = 0; index < buffer.count();)
+        {
+            // number of filled vectors, and number of bytes in them
+            size_t count = 0, bytes = 0;
+
+            // fill the vectors
+            for (; count < 64 && index < buffer.count(); ++count, ++index)
+            {
+                // fill the vector
+                vectors[count].iov_base = (void *)buffer.data(index);
+                vectors[count].iov_len = buffer.size(index);
+
+                // update number of bytes
+                bytes += vectors[count].iov_len;
+            }
+
+            // create the message header
+            struct msghdr header;
+
+            // make sure the members of the header are empty
+            memset(&header, 0, sizeof(header));
+
+            // save the buffers in the message header
+            header.msg_iov = vectors;
+            header.msg_iovlen = count;
+
+            // send the data
+            auto result = sendmsg(_socket, &header, AMQP_CPP_MSG_NOSIGNAL);
+
+            // stop on error
+            if (result <= 0) return total;
+
+            // update total number of bytes written
+            total += result;
+
+            // stop if the socket did not accept all data
+            if ((size_t)result < bytes) return total;
+        }
+
+        // done
+        return total;
+    }
+    
     /**
      *  Construct the final state
      *  @param  monitor     Object that monitors whether connection still exists
@@ -99,13 +189,13 @@ public:
     TcpConnected(TcpExtState *state, TcpOutBuffer &&buffer) : 
         TcpExtState(state),
         _out(std::move(buffer)),
-        _in(4096)
+        _in(_parent->allocator(), 4096)
     {
         // if there is already an output buffer, we have to send out that first
         if (_out) _out.sendto(_socket);
         
         // tell the handler to monitor the socket, if there is an out
-        _parent->onIdle(this, _socket, _out ? readable | writable : readable);
+        watch(_out ? readable | writable : readable);
     }
     
     /**
@@ -119,6 +209,13 @@ public:
      */
     virtual std::size_t queued() const override { return _out.size(); }
 
+    /**
+     *  The high and low watermarks of the output buffer
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const override { return _out.high(); }
+    virtual std::size_t lowWatermark() const override { return _out.low(); }
+
     /**
      *  Process the filedescriptor in the object
      *  @param  monitor     Monitor to check if the object is still alive
@@ -147,14 +244,21 @@ public:
             if (_closed) shutdown(_socket, SHUT_WR);
             
             // check for readability (to find more data, or to be notified that connection is gone)
-            _parent->onIdle(this, _socket, readable);
+            watch(events(false));
         }
         
         // should we check for readability too?
         if (flags & readable)
         {
-            // read data from buffer
-            ssize_t result = _in.receivefrom(_socket, _parent->expected());
+            // if processing is paused, we stop monitoring the socket for readability
+            if (_parent->paused()) { watch(events(_out)); return this; }
+
+            // is the payload of a body frame being received straight into a message?
+            if (_body) return receive(monitor);
+
+            // read data from the socket, unless the buffer holds data that was not yet parsed
+            // because processing was paused (it is parsed first, the socket is read next time)
+            ssize_t result = _stalled ? 1 : _in.receivefrom(_socket, _parent->expected());
             
             // did we encounter end-of-file or are we in an error state?
             if (reportError(result)) return finalState(monitor);
@@ -180,12 +284,57 @@ public:
             
             // we can remove the reallocate instruction
             _reallocate = 0;
+
+            // if processing was paused, the rest of the buffer is parsed after it is resumed
+            _stalled = _parent->paused();
+
+            // update the events (the socket is no longer monitored for readability when paused)
+            watch(events(_out));
+
+            // check if the payload of the next frame can be received straight into a message
+            if (!_stalled) _body.reset(TcpBodyBuffer::create(_parent, _in));
         }
         
         // keep same object
         return this;
     }
 
+    /**
+     *  Receive the payload of a body frame straight into the message
+     *  @param  monitor     monitor to check if the connection object still exists
+     *  @return TcpState*
+     */
+    TcpState *receive(const Monitor &monitor)
+    {
+        // make sure that the message still exists
+        _body->verify(_parent);
+
+        // read data into the message
+        auto result = _body->receivefrom(_socket);
+
+        // did we encounter end-of-file or are we in an error state?
+        if (reportError(result)) return finalState(monitor);
+
+        // wait for more data if the frame is not yet complete
+        if (!_body->complete()) return this;
+
+        // the start of the frame in the input buffer is no longer needed
+        _in.shrink(_in.size());
+
+        // we need a local copy of the buffer - because it is possible that "this"
+        // object gets destructed halfway through the call to the parse() method
+        std::unique_ptr<TcpBodyBuffer> body(std::move(_body));
+
+        // the message could have been destructed after the last read
+        body->verify(_parent);
+
+        // parse the frame
+        _parent->onReceived(this, *body);
+
+        // "this" could be removed by now
+        return monitor.valid() ? this : nullptr;
+    }
+
     /**
      *  Send data over the connection
      *  @param  buffer      buffer to send
@@ -195,6 +344,22 @@ public:
     {
         // we stop sending when connection is closed
         if (_closed) return;
+
+        // when output is corked, small data is held back in the buffer
+        if (corked(size))
+        {
+            // remember if the buffer was empty
+            bool empty = !_out;
+
+            // add the data to the buffer
+            _out.add(buffer, size);
+
+            // check if the buffer should be flushed
+            return held(empty, _out.size());
+        }
+
+        // data that was held back must be sent first
+        if (_out && _parent->corked() > 0) flush();
         
         // is there already a buffer of data that can not be sent?
         if (_out) return _out.add(buffer, size);
@@ -212,9 +377,63 @@ public:
         _out.add(buffer + bytes, size - bytes);
         
         // start monitoring the socket to find out when it is writable
-        _parent->onIdle(this, _socket, readable | writable);
+        watch(events(true));
     }
     
+    /**
+     *  Send a group of segments over the connection
+     *  @param  buffer      buffer with segments to send
+     */
+    virtual void send(const GatherBuffer &buffer) override
+    {
+        // we stop sending when connection is closed
+        if (_closed) return;
+
+        // when output is corked, small groups are held back in the buffer
+        if (corked(buffer.size()))
+        {
+            // remember if the buffer was empty
+            bool empty = !_out;
+
+            // add the segments to the buffer
+            _out.add(buffer);
+
+            // check if the buffer should be flushed
+            return held(empty, _out.size());
+        }
+
+        // data that was held back must be sent first
+        if (_out && _parent->corked() > 0) flush();
+
+        // is there already a buffer of data that can not be sent?
+        if (_out) return _out.add(buffer);
+
+        // there is no buffer, send the data right away
+        size_t bytes = write(buffer);
+
+        // ok if all data was sent
+        if (bytes >= buffer.size()) return;
+
+        // add the remaining data to the buffer
+        _out.add(buffer, bytes);
+
+        // start monitoring the socket to find out when it is writable
+        watch(events(true));
+    }
+
+    /**
+     *  Flush the data that is held back in the outgoing buffer
+     *
+     *  Errors are not reported here, they will be noticed the next time that
+     *  the socket becomes active. The socket stays monitored for writability,
+     *  so that a possible remainder is sent when the socket becomes writable.
+     */
+    virtual void flush() override
+    {
+        // send out the buffered data
+        if (_out) _out.sendto(_socket);
+    }
+
     /**
      *  Gracefully close the connection
      */
@@ -235,7 +454,7 @@ public:
         
         // we still monitor the socket for readability to see if our close call was
         // confirmed by the peer
-        _parent->onIdle(this, _socket, readable);
+        watch(events(false));
     }
 
     /**
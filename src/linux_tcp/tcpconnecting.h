@@ -0,0 +1,366 @@
+/**
+ *  TcpConnecting.h
+ *
+ *  State of the connection while a TCP connection is being set up to one of
+ *  the addresses of the RabbitMQ server. The connects are non-blocking, and
+ *  the event loop tells us when a socket becomes writable (which means that
+ *  it is connected, or that the connect failed). Like "Happy Eyeballs" (RFC
+ *  8305), the addresses are tried in parallel: the next address is tried when
+ *  the previous attempt failed, or when it did not succeed within 250ms, and
+ *  the first socket that is connected is used.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include "tcpstate.h"
+#include "tcpclosed.h"
+#include "tcpconnected.h"
+#include "sslhandshake.h"
+#include "resolverpool.h"
+#include "timerfd.h"
+#include <fcntl.h>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class TcpConnecting : public TcpExtState
+{
+private:
+    /**
+     *  The hostname, for the tls handshake and to remove it from the cache when all addresses fail
+     *  @var std::string
+     */
+    std::string _hostname;
+
+    /**
+     *  The portnumber
+     *  @var uint16_t
+     */
+    uint16_t _port;
+
+    /**
+     *  Should we be using a secure connection?
+     *  @var bool
+     */
+    bool _secure;
+
+    /**
+     *  The addresses, in the order in which they are tried
+     *  @var std::vector<Endpoint>
+     */
+    std::vector<Endpoint> _endpoints;
+
+    /**
+     *  Index of the next address to try
+     *  @var size_t
+     */
+    size_t _next = 0;
+
+    /**
+     *  Sockets of the attempts that are still in progress
+     *  @var std::vector<int>
+     */
+    std::vector<int> _attempts;
+
+    /**
+     *  Timer that expires when the next address should be tried
+     *  @var TimerFd
+     */
+    TimerFd _timer;
+
+    /**
+     *  The error of the last attempt that failed
+     *  @var std::string
+     */
+    std::string _error;
+
+    /**
+     *  Data that was sent to the connection while it was being set up
+     *  @var TcpOutBuffer
+     */
+    TcpOutBuffer _buffer;
+
+    /**
+     *  Sort the addresses: the address families take turns, starting with the
+     *  family of the first address (getaddrinfo() already puts the preferred
+     *  address first), so that a broken family does not delay the other one
+     */
+    void interleave()
+    {
+        // the addresses of the preferred family, and of the other families
+        std::vector<Endpoint> preferred, others;
+        for (auto &endpoint : _endpoints) (endpoint.family == _endpoints.front().family ? preferred : others).push_back(endpoint);
+
+        // merge them
+        _endpoints.clear();
+        for (size_t i = 0; i < std::max(preferred.size(), others.size()); ++i)
+        {
+            // take one of each
+            if (i < preferred.size()) _endpoints.push_back(preferred[i]);
+            if (i < others.size()) _endpoints.push_back(others[i]);
+        }
+    }
+
+    /**
+     *  Start connecting to the next address (addresses that fail right away are skipped)
+     */
+    void attempt()
+    {
+        // keep looping until an attempt is in progress
+        while (_next < _endpoints.size())
+        {
+            // the address to try
+            const auto &endpoint = _endpoints[_next++];
+
+            // create the socket
+            int socket = ::socket(endpoint.family, endpoint.socktype, endpoint.protocol);
+
+            // move on on failure
+            if (socket < 0) { _error = strerror(errno); continue; }
+
+            // turn socket into a non-blocking socket and set the close-on-exec bit
+            fcntl(socket, F_SETFL, O_NONBLOCK);
+            fcntl(socket, F_SETFD, FD_CLOEXEC);
+
+            // start connecting, this normally does not complete right away
+            if (connect(socket, (const struct sockaddr *)&endpoint.address, endpoint.length) == 0 || errno == EINPROGRESS)
+            {
+                // the socket becomes writable when the attempt is done
+                _attempts.push_back(socket);
+                _parent->onIdle(this, socket, writable);
+
+                // the next address is tried if this one does not succeed in time
+                if (_next < _endpoints.size()) _timer.set(std::chrono::milliseconds(250));
+
+                // done
+                return;
+            }
+
+            // log the error for the time being
+            _error = strerror(errno);
+
+            // close socket because connect failed
+            ::close(socket);
+        }
+
+        // if no attempt is in progress, the timer makes sure that we report the error
+        if (_attempts.empty()) _timer.set(std::chrono::microseconds(0));
+    }
+
+    /**
+     *  Stop an attempt
+     *  @param  socket      the socket of the attempt
+     *  @param  close       should the socket be closed?
+     */
+    void stop(int socket, bool close)
+    {
+        // stop monitoring the socket
+        _parent->onIdle(this, socket, 0);
+
+        // close it
+        if (close) ::close(socket);
+
+        // forget the attempt
+        _attempts.erase(std::find(_attempts.begin(), _attempts.end(), socket));
+    }
+
+    /**
+     *  Proceed to the next state with the socket that is connected
+     *  @param  monitor     object to check if the connection still exists
+     *  @param  socket      the socket
+     *  @return TcpState*
+     */
+    TcpState *proceed(const Monitor &monitor, int socket)
+    {
+        // the socket is no longer an attempt, and the other attempts are no longer needed
+        stop(socket, false);
+        while (!_attempts.empty()) stop(_attempts.back(), true);
+
+        // this is now our socket
+        _socket = socket;
+
+        // we want to enable "nodelay" on sockets (otherwise all send operations are s-l-o-w
+        int optval = 1;
+
+        // set the option
+        setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(int));
+
+#ifdef AMQP_CPP_USE_SO_NOSIGPIPE
+        set_sockopt_nosigpipe(_socket);
+#endif
+
+        // prevent exceptions
+        try
+        {
+            // report that the network-layer is connected
+            _parent->onConnected(this);
+
+            // handler callback might have destroyed connection
+            if (!monitor.valid()) return nullptr;
+
+            // if we need a secure connection, we move to the tls handshake (this could throw)
+            if (_secure) return new SslHandshake(this, std::move(_hostname), std::move(_buffer));
+
+            // otherwise we have a valid regular tcp connection
+            else return new TcpConnected(this, std::move(_buffer));
+        }
+        catch (const std::runtime_error &error)
+        {
+            // report error
+            return fail(monitor, error.what());
+        }
+    }
+
+    /**
+     *  Report an error and move to the closed state
+     *  @param  monitor     object to check if the connection still exists
+     *  @param  message     the error
+     *  @return TcpState*
+     */
+    TcpState *fail(const Monitor &monitor, const char *message)
+    {
+        // report error
+        _parent->onError(this, message, false);
+
+        // handler callback might have destroyed connection
+        if (!monitor.valid()) return nullptr;
+
+        // create dummy implementation
+        return new TcpClosed(this);
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  state       the previous state
+     *  @param  hostname    the hostname
+     *  @param  port        the portnumber
+     *  @param  secure      do we need a secure tls connection when connected?
+     *  @param  endpoints   the addresses to try
+     *  @param  buffer      data that was already sent to the connection
+     */
+    TcpConnecting(TcpExtState *state, std::string hostname, uint16_t port, bool secure, std::vector<Endpoint> &&endpoints, TcpOutBuffer &&buffer) :
+        TcpExtState(state),
+        _hostname(std::move(hostname)),
+        _port(port),
+        _secure(secure),
+        _endpoints(std::move(endpoints)),
+        _buffer(std::move(buffer))
+    {
+        // sort the addresses
+        if (!_endpoints.empty()) interleave();
+
+        // tell the event loop to monitor the timer
+        _parent->onIdle(this, _timer.fileno(), readable);
+
+        // start the first attempt
+        attempt();
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~TcpConnecting() noexcept
+    {
+        // stop the attempts that are still in progress
+        while (!_attempts.empty()) stop(_attempts.back(), true);
+
+        // stop monitoring the timer
+        _parent->onIdle(this, _timer.fileno(), 0);
+    }
+
+    /**
+     *  Number of bytes in the outgoing buffer
+     *  @return std::size_t
+     */
+    virtual std::size_t queued() const override { return _buffer.size(); }
+
+    /**
+     *  The high and low watermarks of the output buffer
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const override { return _buffer.high(); }
+    virtual std::size_t lowWatermark() const override { return _buffer.low(); }
+
+    /**
+     *  Process a filedescriptor that became active
+     *  @param  monitor     Object to check if connection still exists
+     *  @param  fd          The filedescriptor that is active
+     *  @param  flags       Flags to indicate that fd is readable and/or writable
+     *  @return             New implementation object
+     */
+    virtual TcpState *process(const Monitor &monitor, int fd, int flags) override
+    {
+        // did the timer expire?
+        if (fd == _timer.fileno())
+        {
+            // the timer is done
+            _timer.reset();
+
+            // try the next address
+            attempt();
+
+            // if there still is an attempt in progress, we wait for it
+            if (!_attempts.empty()) return this;
+
+            // none of the addresses could be reached, the next connection looks up the hostname again
+            ResolverPool::instance().forget(_hostname, _port);
+
+            // report the error
+            return fail(monitor, _error.empty() ? "no addresses found" : _error.data());
+        }
+
+        // it must be one of the attempts
+        if (std::find(_attempts.begin(), _attempts.end(), fd) == _attempts.end()) return this;
+
+        // find out if the connect succeeded
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) error = errno;
+
+        // if the socket is connected, we can move on
+        if (error == 0) return proceed(monitor, fd);
+
+        // log the error for the time being
+        _error = strerror(error);
+
+        // this attempt failed
+        stop(fd, true);
+
+        // try the next address right away (this also makes sure that an error is reported if there is none)
+        _timer.reset();
+        attempt();
+
+        // wait for the other attempts
+        return this;
+    }
+
+    /**
+     *  Send data over the connection
+     *  @param  buffer      buffer to send
+     *  @param  size        size of the buffer
+     */
+    virtual void send(const char *buffer, size_t size) override
+    {
+        // add data to buffer
+        _buffer.add(buffer, size);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
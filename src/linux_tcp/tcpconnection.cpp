@@ -13,6 +13,7 @@
 #include "includes.h"
 #include "tcpresolver.h"
 #include "tcpstate.h"
+#include "tcpsubmissions.h"
 
 /**
  *  Set up namespace
@@ -27,16 +28,33 @@ namespace AMQP {
 TcpConnection::TcpConnection(TcpHandler *handler, const Address &address) :
     _handler(handler),
     _state(new TcpResolver(this, address.hostname(), address.port(), address.secure())),
-    _connection(this, address.login(), address.vhost()) 
+    _connection(this, address.login(), address.vhost()),
+    _submissions(new TcpSubmissions())
 {
     // tell the handler
     _handler->onAttached(this);
+
+    // the event loop watches the submission queue, so that other threads can post operations
+    if (_submissions->watch()) _handler->monitor(this, _submissions->fileno(), readable);
 }
 
 /**
  *  Destructor
  */
-TcpConnection::~TcpConnection() noexcept = default;
+TcpConnection::~TcpConnection() noexcept
+{
+    // stop monitoring the submission queue
+    unwatch();
+}
+
+/**
+ *  Stop monitoring the submission queue (if it was monitored at all)
+ */
+void TcpConnection::unwatch()
+{
+    // tell the handler if the filedescriptor was monitored
+    if (_submissions->unwatch()) _handler->monitor(this, _submissions->fileno(), 0);
+}
 
 /**
  *  The filedescriptor that is used for this connection
@@ -57,6 +75,118 @@ std::size_t TcpConnection::queued() const
     return _state->queued();
 }
 
+/**
+ *  The high watermark of the output buffer
+ *  @return std::size_t
+ */
+std::size_t TcpConnection::highWatermark() const
+{
+    return _state->highWatermark();
+}
+
+/**
+ *  The low watermark of the output buffer
+ *  @return std::size_t
+ */
+std::size_t TcpConnection::lowWatermark() const
+{
+    return _state->lowWatermark();
+}
+
+/**
+ *  Write all data that is held back because output is corked to the socket
+ */
+void TcpConnection::flush()
+{
+    // monitor the object for destruction, because sending frames could report an error
+    Monitor monitor(this);
+
+    // the channels send out the acks that they hold back
+    _connection.flush();
+
+    // pass on to the state object
+    if (monitor.valid()) _state->flush();
+}
+
+/**
+ *  Method that is called when the connection holds back frames outside a call to parse()
+ *  @param  connection      The connection that holds back frames
+ *  @return bool            Will we call Connection::flush()?
+ */
+bool TcpConnection::onPending(Connection *connection)
+{
+    // the frames are sent in the next iteration of the event loop
+    post([this]() { _connection.flush(); });
+
+    // we will call flush()
+    return true;
+}
+
+/**
+ *  Resume reading from the socket
+ */
+void TcpConnection::resume()
+{
+    // skip if we were not paused
+    if (!_connection.paused()) return;
+
+    // resume the connection
+    _connection.resume();
+
+    // the data that is already buffered is processed in the next iteration of the event
+    // loop (as if the socket became readable, which also starts monitoring it again)
+    post([this]() { if (!_connection.paused()) process(fileno(), readable); });
+}
+
+/**
+ *  Submit an operation from a different thread
+ *  @param  task            the operation to run in the event loop thread
+ */
+void TcpConnection::post(std::function<void()> task)
+{
+    // pass on to the queue
+    _submissions->push(std::move(task));
+}
+
+/**
+ *  Run all operations that were submitted by other threads
+ */
+void TcpConnection::drain()
+{
+    // monitor the object for destruction, because the operations may destruct it
+    Monitor monitor(this);
+
+    // reset the notification before the queue is processed, so that no submissions are missed
+    _submissions->reset();
+
+    // the output is corked for as long as the operations run, so that the frames
+    // that they create are written at once (this leaves the user's settings alone)
+    bool draining = _draining;
+    _draining = true;
+
+    // run all operations
+    while (auto *submission = _submissions->pop())
+    {
+        // the operation is destructed when it is done
+        std::unique_ptr<TcpSubmission> ptr(submission);
+
+        // run it
+        ptr->task();
+
+        // leap out if the connection was destructed
+        if (!monitor.valid()) return;
+    }
+
+    // the operations are done
+    _draining = draining;
+
+    // nothing else to do if the output is corked by the user
+    if (_threshold > 0 || _draining) return;
+
+    // write everything that was held back
+    flush();
+}
+
 /**
  *  Is the connection closed and full dead? The entire TCP connection has been discarded.
  *  @return bool
@@ -77,6 +207,9 @@ bool TcpConnection::closed() const
  */
 void TcpConnection::process(int fd, int flags)
 {
+    // operations that were submitted by other threads
+    if (fd == _submissions->fileno()) return drain();
+
     // monitor the object for destruction, because you never know what the user
     Monitor monitor(this);
 
@@ -173,6 +306,17 @@ void TcpConnection::onData(Connection *connection, const char *buffer, size_t si
     _state->send(buffer, size);
 }
 
+/**
+ *  Method that is called by the connection when a group of frames needs to be sent
+ *  @param  connection      The connection that created this output
+ *  @param  buffer          Segments with data to send
+ */
+void TcpConnection::onData(Connection *connection, const GatherBuffer &buffer)
+{
+    // send the segments over the connection
+    _state->send(buffer);
+}
+
 /**
  *  Method called when the AMQP connection ends up in an error state
  *  @param  connection      The connection that entered the error state
@@ -230,6 +374,9 @@ void TcpConnection::onError(TcpState *state, const char *message, bool connected
     // we wait for the subsequent call to the onLost() method
     if (connected || !monitor.valid()) return;
     
+    // the submission queue no longer has to be watched
+    unwatch();
+
     // tell the handler that no further events will be fired
     _handler->onDetached(this);
 }
@@ -249,10 +396,23 @@ void TcpConnection::onLost(TcpState *state)
     // leap out if object was destructed
     if (!monitor.valid()) return;
     
+    // the submission queue no longer has to be watched
+    unwatch();
+
     // tell the handler that no further events will be fired
     _handler->onDetached(this);
 }
 
+/**
+ *  Statistics of the TLS handshakes of all secure connections in the process
+ *  @return TlsMetrics
+ */
+TlsMetrics TcpConnection::tlsMetrics()
+{
+    // the statistics are kept by the session cache
+    return SslSessions::instance().metrics();
+}
+
 /**
  *  End of namespace
  */
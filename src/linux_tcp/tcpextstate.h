@@ -12,6 +12,11 @@
  */
 #pragma once
 
+/**
+ *  Dependencies
+ */
+#include <chrono>
+
 /**
  *  Begin of namespace
  */
@@ -28,6 +33,12 @@ protected:
      *  @var int
      */
     int _socket;
+
+    /**
+     *  Moment when data was first held back in the outgoing buffer (when output is corked)
+     *  @var std::chrono::steady_clock::time_point
+     */
+    std::chrono::steady_clock::time_point _since;
     
     /**
      *  Clean-up the socket, and call the onClosed() method
@@ -49,6 +60,63 @@ protected:
         // tell the handler that the connection is now lost
         _parent->onLost(this);
     }
+
+    /**
+     *  Tell the parent for which events the socket should be monitored
+     *  @param  events      AMQP::readable and/or AMQP::writable
+     */
+    virtual void watch(int events)
+    {
+        // pass on to the parent
+        _parent->onIdle(this, _socket, events);
+    }
+
+    /**
+     *  The events for which the socket should be monitored (the socket is not
+     *  monitored for readability while processing of incoming data is paused)
+     *  @param  write       is there data that has to be written?
+     *  @return int
+     */
+    int events(bool write) const
+    {
+        return (_parent->paused() ? 0 : readable) | (write ? writable : 0);
+    }
+
+    /**
+     *  Should data of a certain size be held back because output is corked?
+     *  @param  size        number of bytes that are going to be sent
+     *  @return bool
+     */
+    bool corked(size_t size) const
+    {
+        // the max number of bytes that may be held back
+        auto threshold = _parent->corked();
+
+        // data that is bigger than the threshold can be sent right away
+        return threshold > 0 && size < threshold;
+    }
+
+    /**
+     *  Method that is called after data was held back in the outgoing buffer
+     *  @param  empty       was the buffer empty before the data was added?
+     *  @param  buffered    number of bytes in the buffer now
+     */
+    void held(bool empty, size_t buffered)
+    {
+        // current time
+        auto now = std::chrono::steady_clock::now();
+
+        // if this is the first data, we wait for the socket to become writable
+        // (which normally happens in the next iteration of the event loop)
+        if (empty) { _since = now; watch(events(true)); }
+
+        // the max number of microseconds that data may be held back
+        auto latency = _parent->latency();
+
+        // flush if the buffer is big enough, or if data was held back too long
+        if (buffered >= _parent->corked()) flush();
+        else if (latency > 0 && now - _since >= std::chrono::microseconds(latency)) flush();
+    }
     
     
 protected:
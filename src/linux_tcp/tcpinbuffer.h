@@ -27,13 +27,28 @@ namespace AMQP {
  */
 class TcpInBuffer : public ByteBuffer
 {
+private:
+    /**
+     *  The allocator for the buffer
+     *  @var Allocator
+     */
+    Allocator *_allocator;
+    
+    /**
+     *  Number of bytes allocated
+     *  @var size_t
+     */
+    size_t _capacity;
+
 public:
     /**
      *  Constructor
      *  Note that we pass 0 to the constructor because the buffer seems to be empty
+     *  @param  allocator   the allocator to use
      *  @param  size        initial size to allocated
      */
-    TcpInBuffer(size_t size) : ByteBuffer((char *)malloc(size), 0) {}
+    TcpInBuffer(Allocator *allocator, size_t size) : 
+        ByteBuffer((char *)allocator->allocate(size), 0), _allocator(allocator), _capacity(size) {}
     
     /**
      *  No copy'ing
@@ -45,7 +60,12 @@ public:
      *  Move constructor
      *  @param  that
      */
-    TcpInBuffer(TcpInBuffer &&that) : ByteBuffer(std::move(that)) {}
+    TcpInBuffer(TcpInBuffer &&that) : 
+        ByteBuffer(std::move(that)), _allocator(that._allocator), _capacity(that._capacity) 
+    {
+        // the other object no longer owns memory
+        that._capacity = 0;
+    }
     
     /**
      *  Destructor
@@ -53,7 +73,7 @@ public:
     virtual ~TcpInBuffer()
     {
         // free memory
-        if (_data) free((void *)_data);
+        if (_data) _allocator->deallocate((void *)_data, _capacity);
     }
 
     /**
@@ -65,9 +85,17 @@ public:
         // skip self-assignment
         if (this == &that) return *this;
         
+        // release our own memory
+        if (_data) _allocator->deallocate((void *)_data, _capacity);
+        
         // call base
         ByteBuffer::operator=(std::move(that));
         
+        // take over the allocation
+        _allocator = that._allocator;
+        _capacity = that._capacity;
+        that._capacity = 0;
+        
         // done
         return *this;
     }
@@ -78,12 +106,28 @@ public:
      */
     void reallocate(size_t size)
     {
+        // allocate new memory
+        auto *data = (char *)_allocator->allocate(size);
+        
+        // copy the data that we already have
+        if (_size > 0) memcpy(data, _data, std::min(_size, size));
+        
+        // release the old memory
+        if (_data) _allocator->deallocate((void *)_data, _capacity);
+        
         // update data
-        _data = (char *)realloc((void *)_data, size);
-   }
+        _data = data;
+        _size = std::min(_size, size);
+        _capacity = size;
+    }
     
     /**
      *  Receive data from a socket
+     *
+     *  Not only the bytes that the library expects are read, but everything that
+     *  is available and that fits in the buffer, so that multiple frames can be
+     *  parsed in one go.
+     *
      *  @param  socket          socket to read from
      *  @param  expected        number of bytes that the library expects
      *  @return ssize_t
@@ -100,8 +144,8 @@ public:
         // by the remote client, so we do have to call read() anyway, assume a default buffer
         if (available == 0) available = 1;
         
-        // number of bytes to read
-        size_t bytes = std::min((uint32_t)(expected - _size), available);
+        // number of bytes to read (at least the expected bytes, and as much as fits)
+        size_t bytes = std::min(std::max((size_t)expected, _capacity) - _size, (size_t)available);
         
         // read data into the buffer
         auto result = read(socket, (void *)(_data + _size), bytes);
@@ -122,7 +166,7 @@ public:
     ssize_t receivefrom(SSL *ssl, uint32_t expected)
     {
         // number of bytes to that still fit in the buffer
-        size_t bytes = expected - _size;
+        size_t bytes = std::max((size_t)expected, _capacity) - _size;
         
         // read data
         auto result = OpenSSL::SSL_read(ssl, (void *)(_data + _size), bytes);
@@ -135,11 +179,14 @@ public:
     }
     
     /**
-     *  Shrink the buffer (in practice this is always called with the full buffer size)
+     *  Remove bytes that were processed from the front of the buffer
      *  @param  size
      */
     void shrink(size_t size)
     {
+        // move the bytes that were not yet processed (normally a partial frame) to the front
+        if (size > 0 && size < _size) memmove((char *)_data, _data + size, _size - size);
+
         // update size
         _size -= size;
     }
@@ -2,7 +2,9 @@
  *  TcpOutBuffer.h
  *
  *  When data could not be sent out immediately, it is buffered in a temporary
- *  output buffer. This is the implementation of that buffer
+ *  output buffer. This is the implementation of that buffer. The data is
+ *  stored in a ring of fixed size slabs, and slabs that have been sent are
+ *  recycled, so that a busy connection does not allocate memory all the time.
  *
  *  @author Emiel Bruijntjes <emiel.bruijntjes@copernica.com>
  *  @copyright 2015 - 2018 Copernica BV
@@ -18,6 +20,10 @@
  */
 #include <sys/ioctl.h>
 #include <sys/uio.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 #include "openssl.h"
 
 /**
@@ -39,16 +45,47 @@ class TcpOutBuffer
 {
 private:
     /**
-     *  All output buffers
-     *  @var std::deque
+     *  Size of each slab
+     *  @var size_t
+     */
+    static constexpr size_t slabsize = 16384;
+
+    /**
+     *  Max number of unused slabs that are kept for later reuse
+     *  @var size_t
+     */
+    static constexpr size_t maxspare = 16;
+
+    /**
+     *  Ring of slabs that hold the data (the first slab is at index _head)
+     *  @var std::vector<char*>
      */
-    mutable std::deque<std::vector<char>> _buffers;
+    std::vector<char *> _ring;
 
     /**
-     *  Number of bytes in first buffer that is no longer in use
+     *  Index of the first slab in the ring, and the number of slabs in use
+     *  @var size_t
+     */
+    size_t _head = 0;
+    size_t _count = 0;
+
+    /**
+     *  Slabs that are no longer in use, and that can be recycled
+     *  @var std::vector<char*>
+     */
+    std::vector<char *> _spare;
+
+    /**
+     *  Number of bytes in first slab that is no longer in use
      *  @var size_t
      */
     size_t _skip = 0;
+
+    /**
+     *  Number of bytes in use in the last slab
+     *  @var size_t
+     */
+    size_t _fill = 0;
     
     /**
      *  Total number of bytes in the buffer
@@ -56,6 +93,86 @@ private:
      */
     size_t _size = 0;
 
+    /**
+     *  The high watermark (max number of bytes that were ever buffered), and 
+     *  the low watermark (the lowest size that the buffer drained to since then)
+     *  @var size_t
+     */
+    size_t _high = 0;
+    size_t _low = 0;
+
+    /**
+     *  Get access to a slab in the ring
+     *  @param  index       index relative to the first slab
+     *  @return char*
+     */
+    char *slab(size_t index) const
+    {
+        // the ring size is always a power of two
+        return _ring[(_head + index) & (_ring.size() - 1)];
+    }
+
+    /**
+     *  Append a new slab to the ring
+     */
+    void grow()
+    {
+        // do we need a bigger ring?
+        if (_count == _ring.size())
+        {
+            // construct a new ring that is twice as big (with the slabs in the right order)
+            std::vector<char *> ring(std::max(_ring.size() * 2, (size_t)8));
+            
+            // copy the slabs
+            for (size_t i = 0; i < _count; ++i) ring[i] = slab(i);
+
+            // use the new ring
+            _ring.swap(ring);
+            _head = 0;
+        }
+
+        // take a slab from the spare slabs, or allocate a new one
+        char *buffer = _spare.empty() ? (char *)malloc(slabsize) : _spare.back();
+
+        // remove it from the spare slabs
+        if (!_spare.empty()) _spare.pop_back();
+
+        // add it to the ring
+        _ring[(_head + _count++) & (_ring.size() - 1)] = buffer;
+
+        // nothing is used in the new slab
+        _fill = 0;
+    }
+
+    /**
+     *  Remove the first slab from the ring
+     */
+    void pop()
+    {
+        // the first slab
+        char *buffer = slab(0);
+
+        // remove from the ring
+        _head = (_head + 1) & (_ring.size() - 1);
+        _count -= 1;
+
+        // recycle the slab, or free it if we already have enough spare ones
+        if (_spare.size() < maxspare) _spare.push_back(buffer);
+        else free(buffer);
+    }
+
+    /**
+     *  Free all slabs
+     */
+    void release()
+    {
+        // free all slabs in use
+        for (size_t i = 0; i < _count; ++i) free(slab(i));
+
+        // and all spare slabs
+        for (auto *buffer : _spare) free(buffer);
+    }
+
 public:
     /**
      *  Regular constructor
@@ -73,13 +190,30 @@ public:
      *  @param  that
      */
     TcpOutBuffer(TcpOutBuffer &&that) : 
-        _buffers(std::move(that._buffers)), 
-        _skip(that._skip), 
-        _size(that._size)
+        _ring(std::move(that._ring)),
+        _head(that._head),
+        _count(that._count),
+        _spare(std::move(that._spare)),
+        _skip(that._skip),
+        _fill(that._fill),
+        _size(that._size),
+        _high(that._high),
+        _low(that._low)
     {
         // reset other object
-        that._skip = 0;
-        that._size = 0;
+        that._ring.clear();
+        that._spare.clear();
+        that._head = that._count = 0;
+        that._skip = that._fill = that._size = 0;
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~TcpOutBuffer()
+    {
+        // free all memory
+        release();
     }
     
     /**
@@ -91,12 +225,18 @@ public:
         // skip self-assignment
         if (this == &that) return *this;
         
-        // swap buffers
-        _buffers.swap(that._buffers);
+        // swap the slabs
+        _ring.swap(that._ring);
+        _spare.swap(that._spare);
         
         // swap integers
+        std::swap(_head, that._head);
+        std::swap(_count, that._count);
         std::swap(_skip, that._skip);
+        std::swap(_fill, that._fill);
         std::swap(_size, that._size);
+        std::swap(_high, that._high);
+        std::swap(_low, that._low);
         
         // done
         return *this;
@@ -132,6 +272,34 @@ public:
         return _size;
     }
 
+    /**
+     *  The high watermark: the max number of bytes that were buffered at the same time
+     *  @return size_t
+     */
+    size_t high() const
+    {
+        // expose member
+        return _high;
+    }
+
+    /**
+     *  The low watermark: the lowest number of bytes that were buffered
+     *  since the high watermark was reached
+     *  @return size_t
+     */
+    size_t low() const
+    {
+        // expose member
+        return _low;
+    }
+
+    /**
+     *  Number of slabs that are in use, and number of slabs that are kept for reuse
+     *  @return size_t
+     */
+    size_t slabs() const { return _count; }
+    size_t spare() const { return _spare.size(); }
+
     /**
      *  Add data to the buffer
      *  @param  buffer
@@ -139,11 +307,53 @@ public:
      */
     void add(const char *buffer, size_t size)
     {
-        // add element
-        _buffers.emplace_back(buffer, buffer + size);
-    
         // update total size
         _size += size;
+
+        // update the watermarks
+        if (_size > _high) _high = _low = _size;
+
+        // keep looping until all data is copied
+        while (size > 0)
+        {
+            // we need a slab with free space
+            if (_count == 0 || _fill == slabsize) grow();
+
+            // number of bytes that fit in the last slab
+            size_t bytes = std::min(size, slabsize - _fill);
+
+            // copy the data
+            memcpy(slab(_count - 1) + _fill, buffer, bytes);
+
+            // update counters
+            _fill += bytes;
+            buffer += bytes;
+            size -= bytes;
+        }
+    }
+
+    /**
+     *  Add all segments of a gather buffer to the buffer
+     *  @param  buffer      the segments to add
+     *  @param  skip        number of leading bytes that should be skipped
+     */
+    void add(const GatherBuffer &buffer, size_t skip = 0)
+    {
+        // iterate over the segments
+        for (size_t i = 0; i < buffer.count(); ++i)
+        {
+            // size of this segment
+            size_t size = buffer.size(i);
+
+            // skip the entire segment if it was already sent
+            if (skip >= size) { skip -= size; continue; }
+
+            // add the remaining part of the segment
+            add(buffer.data(i) + skip, size - skip);
+
+            // nothing more to skip
+            skip = 0;
+        }
     }
     
     /**
@@ -155,39 +365,38 @@ public:
         // are we removing everything?
         if (toremove >= _size)
         {
+            // recycle all slabs
+            while (_count > 0) pop();
+
             // reset all
-            _buffers.clear(); 
-            _skip = _size = 0;
+            _skip = _fill = _size = _low = 0;
         }
         else
         {
+            // update the size and the low watermark
+            _size -= toremove;
+            _low = std::min(_low, _size);
+
             // keep looping
             while (toremove > 0)
             {
-                // access to the first buffer
-                const auto &first = _buffers.front();
-                
-                // actual used bytes in first buffer
-                size_t bytes = first.size() - _skip;
+                // actual used bytes in first slab
+                size_t bytes = (_count == 1 ? _fill : slabsize) - _skip;
                 
-                // can we remove the first buffer completely?
+                // can we remove the first slab completely?
                 if (toremove >= bytes)
                 {
-                    // we're going to remove the first item, update sizes
-                    _size -= bytes;
-                    _skip = 0;
-                    
                     // number of bytes that still have to be removed
                     toremove -= bytes;
                     
-                    // remove first buffer
-                    _buffers.pop_front();
+                    // remove first slab
+                    pop();
+                    _skip = 0;
                 }
                 else
                 {
-                    // we should remove the first buffer partially
+                    // we should remove the first slab partially
                     _skip += toremove;
-                    _size -= toremove;
                     
                     // done
                     toremove = 0;
@@ -201,11 +410,8 @@ public:
      */
     void clear()
     {
-        // clear all buffers
-        _buffers.clear();
-        
-        // reset members
-        _skip = _size = 0;
+        // remove all data
+        shrink(_size);
     }
     
     /**
@@ -216,22 +422,23 @@ public:
      */
     size_t fill(struct iovec buffers[], size_t count) const
     {
-        // index counter
-        size_t index = 0;
+        // number of buffers to fill
+        count = std::min(count, _count);
 
-        // iterate over the buffers
-        for (const auto &str : _buffers)
+        // iterate over the slabs
+        for (size_t index = 0; index < count; ++index)
         {
+            // begin and end of the data in this slab
+            size_t begin = index == 0 ? _skip : 0;
+            size_t end = index == _count - 1 ? _fill : slabsize;
+
             // fill buffer
-            buffers[index].iov_base = (void *)(index == 0 ? str.data() + _skip : str.data());
-            buffers[index].iov_len = index == 0 ? str.size() - _skip : str.size();
-            
-            // update counter for next iteration
-            if (++index >= count) return count;
+            buffers[index].iov_base = (void *)(slab(index) + begin);
+            buffers[index].iov_len = end - begin;
         }
         
         // done
-        return index;
+        return count;
     }
     
     /**
@@ -282,25 +489,46 @@ public:
     
     /**
      *  Send the buffer to an SSL connection
+     *
+     *  Every call writes one tls record of at most 16KB (which is also the size
+     *  of a slab), that is assembled from the two slabs at the front of the
+     *  buffer if the first one holds less. When the call has to be repeated,
+     *  the record starts with the same data and is at least as big, which is
+     *  what openssl requires.
+     *
      *  @param  ssl         the ssl context to send data to
      *  @return ssize_t     number of bytes sent, or the return value of ssl_write
      */
     ssize_t sendto(SSL *ssl)
     {
-        // we're going to fill a lot of buffers (for ssl only one buffer at a time can be sent)
-        struct iovec buffer[1];
+        // the record is taken from at most two slabs
+        struct iovec buffer[2];
         
         // fill the buffers, and leap out if there is no data
-        auto buffers = fill(buffer, 1);
+        auto buffers = fill(buffer, 2);
         
         // just to be sure we do this check
         if (buffers == 0) return 0;
+
+        // size of the record
+        size_t size = std::min(_size, (size_t)slabsize);
+
+        // memory to assemble the record in, if the first slab does not hold all of it
+        char record[slabsize];
+
+        // assemble the record if necessary
+        if (buffer[0].iov_len < size)
+        {
+            // copy the data from the two slabs
+            memcpy(record, buffer[0].iov_base, buffer[0].iov_len);
+            memcpy(record + buffer[0].iov_len, buffer[1].iov_base, size - buffer[0].iov_len);
+        }
         
         // make sure that the error queue is currently completely empty, so the error queue can be checked
         OpenSSL::ERR_clear_error();
 
         // send the data
-        auto result = OpenSSL::SSL_write(ssl, buffer[0].iov_base, buffer[0].iov_len);
+        auto result = OpenSSL::SSL_write(ssl, buffer[0].iov_len < size ? record : buffer[0].iov_base, size);
         
         // on success we shrink the buffer
         if (result > 0) shrink(result);
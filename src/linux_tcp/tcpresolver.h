@@ -1,8 +1,9 @@
 /**
  *  TcpResolver.h
  *
- *  Class that is used for the DNS lookup of the hostname of the RabbitMQ 
- *  server, and to make the initial connection
+ *  State of the connection while the hostname of the RabbitMQ server is
+ *  being looked up. The lookup is done by a pool of threads that is shared
+ *  by all connections, after it the connection moves on to TcpConnecting.
  *
  *  @author Emiel Bruijntjes <emiel.bruijntjes@copernica.com>
  *  @copyright 2015 - 2018 Copernica BV
@@ -16,13 +17,11 @@
 /**
  *  Dependencies
  */
-#include "pipe.h"
 #include "tcpstate.h"
 #include "tcpclosed.h"
-#include "tcpconnected.h"
+#include "tcpconnecting.h"
+#include "resolverpool.h"
 #include "openssl.h"
-#include "sslhandshake.h"
-#include <thread>
 
 /**
  *  Set up namespace
@@ -54,95 +53,16 @@ private:
     uint16_t _port;
     
     /**
-     *  A pipe that is used to send back the socket that is connected to RabbitMQ
-     *  @var Pipe
+     *  The lookup that is done by the shared resolver pool
+     *  @var std::shared_ptr<Lookup>
      */
-    Pipe _pipe;
-    
-    /**
-     *  Possible error that occured
-     *  @var std::string
-     */
-    std::string _error;
+    std::shared_ptr<Lookup> _lookup;
     
     /**
      *  Data that was sent to the connection, while busy resolving the hostname
      *  @var TcpBuffer
      */
     TcpOutBuffer _buffer;
-    
-    /**
-     *  Thread in which the DNS lookup occurs
-     *  @var std::thread
-     */
-    std::thread _thread;
-
-
-    /**
-     *  Run the thread
-     */
-    void run()
-    {
-        // prevent exceptions
-        try
-        {
-            // check if we support openssl in the first place
-            if (_secure && !OpenSSL::valid()) throw std::runtime_error("Secure connection cannot be established: libssl.so cannot be loaded");
-            
-            // get address info
-            AddressInfo addresses(_hostname.data(), _port);
-    
-            // iterate over the addresses
-            for (size_t i = 0; i < addresses.size(); ++i)
-            {
-                // create the socket
-                _socket = socket(addresses[i]->ai_family, addresses[i]->ai_socktype, addresses[i]->ai_protocol);
-                
-                // move on on failure
-                if (_socket < 0) continue;
-                
-                // connect to the socket
-                if (connect(_socket, addresses[i]->ai_addr, addresses[i]->ai_addrlen) == 0) break;
-                
-                // log the error for the time being
-                _error = strerror(errno);
-
-                // close socket because connect failed
-                ::close(_socket);
-                    
-                // socket no longer is valid
-                _socket = -1;
-            }
-            
-            // connection succeeded, mark socket as non-blocking
-            if (_socket >= 0) 
-            {
-                // turn socket into a non-blocking socket and set the close-on-exec bit
-                fcntl(_socket, F_SETFL, O_NONBLOCK | O_CLOEXEC);
-                
-                // we want to enable "nodelay" on sockets (otherwise all send operations are s-l-o-w
-                int optval = 1;
-                
-                // set the option
-                setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(int));
-
-#ifdef AMQP_CPP_USE_SO_NOSIGPIPE
-                set_sockopt_nosigpipe(_socket);
-#endif
-            }
-        }
-        catch (const std::runtime_error &error)
-        {
-            // address could not be resolved, we ignore this for now, but store the error
-            _error = error.what();
-        }
-            
-        // notify the master thread by sending a byte over the pipe
-        if (!_pipe.notify())
-        {
-            _error = strerror(errno);
-        }
-    }
 
 public:
     /**
@@ -156,16 +76,11 @@ public:
         TcpExtState(parent), 
         _hostname(std::move(hostname)),
         _secure(secure),
-        _port(port)
+        _port(port),
+        _lookup(ResolverPool::instance().resolve(_hostname, _port))
     {
-        // tell the event loop to monitor the filedescriptor of the pipe
-        parent->onIdle(this, _pipe.in(), readable);
-        
-        // we can now start the thread (must be started after filedescriptor is monitored!)
-        std::thread thread(std::bind(&TcpResolver::run, this));
-        
-        // store thread in member
-        _thread.swap(thread);
+        // tell the event loop to monitor the filedescriptor that becomes readable when the lookup is done
+        parent->onIdle(this, _lookup->fileno(), readable);
     }
     
     /**
@@ -173,11 +88,8 @@ public:
      */
     virtual ~TcpResolver() noexcept
     {
-        // stop monitoring the pipe filedescriptor
-        _parent->onIdle(this, _pipe.in(), 0);
-
-        // wait for the thread to be ready
-        _thread.join();
+        // stop monitoring the filedescriptor (the pool may still finish the lookup, but nobody listens)
+        _parent->onIdle(this, _lookup->fileno(), 0);
     }
     
     /**
@@ -185,9 +97,17 @@ public:
      *  @return std::size_t
      */
     virtual std::size_t queued() const override { return _buffer.size(); }
+
+    /**
+     *  The high and low watermarks of the output buffer
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const override { return _buffer.high(); }
+    virtual std::size_t lowWatermark() const override { return _buffer.low(); }
     
     /**
      *  Proceed to the next state
+     *  @param  monitor     Object to check if connection still exists
      *  @return TcpState *
      */
     TcpState *proceed(const Monitor &monitor)
@@ -195,20 +115,14 @@ public:
         // prevent exceptions
         try
         {
-            // socket should be connected by now
-            if (_socket < 0) throw std::runtime_error(_error.data());
-        
-            // report that the network-layer is connected
-            _parent->onConnected(this);
+            // check if we support openssl in the first place
+            if (_secure && !OpenSSL::valid()) throw std::runtime_error("Secure connection cannot be established: libssl.so cannot be loaded");
 
-            // handler callback might have destroyed connection
-            if (!monitor.valid()) return nullptr;
-            
-            // if we need a secure connection, we move to the tls handshake (this could throw)
-            if (_secure) return new SslHandshake(this, std::move(_hostname), std::move(_buffer));
-            
-            // otherwise we have a valid regular tcp connection
-            else return new TcpConnected(this, std::move(_buffer));
+            // the hostname should be resolved by now
+            if (_lookup->endpoints().empty()) throw std::runtime_error(_lookup->error());
+
+            // start connecting to the addresses
+            return new TcpConnecting(this, std::move(_hostname), _port, _secure, std::move(_lookup->endpoints()), std::move(_buffer));
         }
         catch (const std::runtime_error &error)
         {
@@ -232,8 +146,8 @@ public:
      */
     virtual TcpState *process(const Monitor &monitor, int fd, int flags) override
     {
-        // only works if the incoming pipe is readable
-        if (fd != _pipe.in() || !(flags & readable)) return this;
+        // only works if the lookup is done
+        if (fd != _lookup->fileno() || !(flags & readable) || !_lookup->done()) return this;
 
         // proceed to the next state
         return proceed(monitor);
@@ -62,6 +62,14 @@ public:
      *  @return size_t
      */
     virtual std::size_t queued() const { return 0; }
+
+    /**
+     *  The max number of outgoing bytes that were queued at the same time, and
+     *  the lowest number of queued bytes since that peak was reached
+     *  @return size_t
+     */
+    virtual std::size_t highWatermark() const { return 0; }
+    virtual std::size_t lowWatermark() const { return 0; }
     
     /**
      *  Is this a closed / dead state?
@@ -98,6 +106,21 @@ public:
         // default does nothing
     }
 
+    /**
+     *  Send a group of segments over the connection
+     *  @param  buffer      Buffer with segments to send
+     */
+    virtual void send(const GatherBuffer &buffer)
+    {
+        // default implementation sends the segments one by one
+        for (size_t i = 0; i < buffer.count(); ++i) send(buffer.data(i), buffer.size(i));
+    }
+
+    /**
+     *  Flush data that is held back in the outgoing buffer
+     */
+    virtual void flush() {}
+
     /**
      *  Gracefully start closing the connection
      */
@@ -0,0 +1,161 @@
+/**
+ *  TcpSubmissions.h
+ *
+ *  Queue with operations that other threads have submitted to a TcpConnection.
+ *  Producers push onto a lock-free queue and wake up the event loop of the
+ *  connection with an eventfd, the event loop thread runs all operations
+ *  that were submitted in one go.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <functional>
+#include <atomic>
+#include "mpscqueue.h"
+#include "eventfd.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Operation that was submitted by a different thread
+ */
+class TcpSubmission : public MpscNode
+{
+public:
+    /**
+     *  The operation to run in the event loop thread
+     *  @var std::function<void()>
+     */
+    std::function<void()> task;
+
+    /**
+     *  Constructor
+     *  @param  task
+     */
+    TcpSubmission(std::function<void()> &&task) : task(std::move(task)) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~TcpSubmission() {}
+};
+
+/**
+ *  Class definition
+ */
+class TcpSubmissions
+{
+private:
+    /**
+     *  The submitted operations
+     *  @var MpscQueue<TcpSubmission>
+     */
+    MpscQueue<TcpSubmission> _queue;
+
+    /**
+     *  Eventfd to wake up the event loop
+     *  @var EventFd
+     */
+    EventFd _eventfd;
+
+    /**
+     *  Is the eventfd watched by the event loop (1), or will it never be watched again (2)?
+     *  @var std::atomic<int>
+     */
+    std::atomic<int> _watched{0};
+
+public:
+    /**
+     *  Constructor
+     */
+    TcpSubmissions() = default;
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    TcpSubmissions(const TcpSubmissions &that) = delete;
+
+    /**
+     *  Destructor (operations that did not yet run are discarded)
+     */
+    virtual ~TcpSubmissions() {}
+
+    /**
+     *  The filedescriptor that becomes readable when operations were submitted
+     *  @return int
+     */
+    int fileno() const { return _eventfd.fileno(); }
+
+    /**
+     *  Start watching the queue, this returns true only the first time, in which
+     *  case the caller should let the event loop monitor the filedescriptor
+     *  @return bool
+     */
+    bool watch()
+    {
+        // change the state from "not watched" to "watched"
+        int expected = 0;
+        return _watched.compare_exchange_strong(expected, 1);
+    }
+
+    /**
+     *  Stop watching the queue for good, this returns true if the queue was
+     *  watched, in which case the caller should stop monitoring the filedescriptor
+     *  @return bool
+     */
+    bool unwatch()
+    {
+        // operations that are submitted from now on are never run
+        return _watched.exchange(2) == 1;
+    }
+
+    /**
+     *  Submit an operation (this method may be called from any thread)
+     *  @param  task
+     */
+    void push(std::function<void()> &&task)
+    {
+        // add to the queue
+        _queue.push(new TcpSubmission(std::move(task)));
+
+        // wake up the event loop (this is a no-op if it was already woken up)
+        _eventfd.notify();
+    }
+
+    /**
+     *  Reset the notification, this should be called by the event loop thread
+     *  right before it starts to run the operations
+     */
+    void reset()
+    {
+        // pass on to the eventfd
+        _eventfd.reset();
+    }
+
+    /**
+     *  Take the next operation from the queue (only from the event loop thread)
+     *  @return TcpSubmission*     the operation, or nullptr if the queue is empty
+     */
+    TcpSubmission *pop()
+    {
+        // pass on to the queue
+        return _queue.pop();
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,107 @@
+/**
+ *  TimerFd.h
+ *
+ *  One-shot timer that is exposed as a filedescriptor, so that it can be
+ *  watched by the event loop like any other filedescriptor. The library
+ *  has no timers of its own, this is used for the delay between two
+ *  connection attempts.
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <chrono>
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class TimerFd
+{
+private:
+    /**
+     *  The filedescriptor
+     *  @var int
+     */
+    int _fd;
+
+public:
+    /**
+     *  Constructor
+     *  @throws std::runtime_error
+     */
+    TimerFd() : _fd(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK))
+    {
+        // check for failure
+        if (_fd < 0) throw std::runtime_error(strerror(errno));
+    }
+
+    /**
+     *  No copying
+     *  @param  that
+     */
+    TimerFd(const TimerFd &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~TimerFd()
+    {
+        // close the filedescriptor
+        close(_fd);
+    }
+
+    /**
+     *  Expose the filedescriptor
+     *  @return int
+     */
+    int fileno() const { return _fd; }
+
+    /**
+     *  Make the filedescriptor readable after a certain time
+     *  @param  delay       the delay (zero makes it readable right away)
+     */
+    void set(std::chrono::microseconds delay)
+    {
+        // a timer of zero would disarm the timer, so we use one nanosecond instead
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = delay.count() / 1000000;
+        spec.it_value.tv_nsec = delay.count() > 0 ? (delay.count() % 1000000) * 1000 : 1;
+
+        // arm the timer
+        timerfd_settime(_fd, 0, &spec, nullptr);
+    }
+
+    /**
+     *  Disarm the timer, and make the filedescriptor unreadable
+     */
+    void reset()
+    {
+        // disarm the timer
+        struct itimerspec spec = {};
+        timerfd_settime(_fd, 0, &spec, nullptr);
+
+        // read the expirations (this fails if the timer did not expire, which is fine)
+        uint64_t expirations;
+        auto result = read(_fd, &expirations, sizeof(expirations));
+        (void) result;
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
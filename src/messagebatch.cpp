@@ -0,0 +1,155 @@
+/**
+ *  MessageBatch.cpp
+ *
+ *  Implementation of the MessageBatch class
+ *
+ *  @copyright 2018 Copernica BV
+ */
+#include "includes.h"
+#include "stringbuffer.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Start a new message
+ *  @param  deliveryTag     the delivery tag
+ *  @param  redelivered     is this a redelivered message?
+ *  @param  exchange        the exchange to which it was published
+ *  @param  routingkey      the routing key that was used
+ */
+void MessageBatch::begin(uint64_t deliveryTag, bool redelivered, const StringView &exchange, const StringView &routingkey)
+{
+    // a message that was not completed is discarded
+    if (_messages.size() > _complete)
+    {
+        // remove its data
+        _data.resize(_messages.back()._exchange);
+        _messages.pop_back();
+    }
+
+    // add the message
+    _messages.emplace_back();
+    auto &message = _messages.back();
+
+    // store the tag
+    message._deliveryTag = deliveryTag;
+    message._redelivered = redelivered;
+
+    // store the exchange and routing key
+    message._exchange = _data.size();
+    message._exchangeSize = exchange.size();
+    _data.append(exchange.data(), exchange.size());
+    message._routingkey = _data.size();
+    message._routingkeySize = routingkey.size();
+    _data.append(routingkey.data(), routingkey.size());
+
+    // the properties and body follow, they are empty for now
+    message._properties = message._body = _data.size();
+}
+
+/**
+ *  Store the properties of the message that is being received
+ *  @param  metadata        the properties
+ */
+void MessageBatch::properties(const MetaData &metadata)
+{
+    // skip if no message is being received (the batch was created halfway a message)
+    if (_messages.size() == _complete) return;
+
+    // the message that is being received
+    auto &message = _messages.back();
+
+    // encode the properties (this is a simple copy of the received data)
+    message._properties = _data.size();
+    StringBuffer buffer(_data);
+    metadata.fill(buffer);
+    message._propertiesSize = _data.size() - message._properties;
+
+    // the body follows
+    message._body = _data.size();
+}
+
+/**
+ *  Append body data to the message that is being received
+ *  @param  data
+ *  @param  size
+ */
+void MessageBatch::append(const char *data, size_t size)
+{
+    // skip if no message is being received
+    if (_messages.size() == _complete) return;
+
+    // add to the data
+    _data.append(data, size);
+
+    // update the size of the body
+    _messages.back()._bodySize += size;
+}
+
+/**
+ *  Mark the message that is being received as complete
+ *  @return bool            is this the first complete message of the batch?
+ */
+bool MessageBatch::complete()
+{
+    // skip if no message is being received
+    if (_messages.size() == _complete) return false;
+
+    // one more message that is complete
+    return ++_complete == 1;
+}
+
+/**
+ *  The complete messages
+ *  @return const MessageView *
+ */
+const MessageView *MessageBatch::messages()
+{
+    // the data does not move anymore, so the messages can refer to it
+    for (size_t i = 0; i < _complete; ++i) _messages[i]._base = _data.data();
+
+    // expose the messages
+    return _messages.data();
+}
+
+/**
+ *  Remove the complete messages from the batch
+ */
+void MessageBatch::clear()
+{
+    // if all messages are complete, we can simply forget everything
+    if (_messages.size() == _complete)
+    {
+        // reset all members (but keep the memory)
+        _messages.clear();
+        _data.clear();
+        _complete = 0;
+        return;
+    }
+
+    // the message that is still being received, and where its data starts
+    MessageView message = _messages.back();
+    size_t start = message._exchange;
+
+    // move its data to the front
+    _data.erase(0, start);
+
+    // update the offsets
+    message._exchange -= start;
+    message._routingkey -= start;
+    message._properties -= start;
+    message._body -= start;
+
+    // it is now the only message
+    _messages.clear();
+    _messages.push_back(message);
+    _complete = 0;
+}
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,40 @@
+/**
+ *  MessageView.cpp
+ *
+ *  Implementation of the MessageView class
+ *
+ *  @copyright 2018 Copernica BV
+ */
+#include "includes.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Decode the properties of the message
+ *
+ *  The properties are first wrapped in a MetaData object that holds a view on
+ *  the memory of the batch, which is reused for the next batch. The object that
+ *  is returned is a copy, which owns the properties that are not yet decoded.
+ *
+ *  @return MetaData
+ */
+MetaData MessageView::metaData() const
+{
+    // the properties are stored in the same format as they were received
+    ByteBuffer buffer(_base + _properties, _propertiesSize);
+    ReceivedFrame frame(buffer);
+
+    // wrap them
+    MetaData metadata(frame);
+
+    // return a copy that does not refer to the batch
+    return MetaData(metadata);
+}
+
+/**
+ *  End of namespace
+ */
+}
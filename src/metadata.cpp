@@ -0,0 +1,107 @@
+/**
+ *  MetaData.cpp
+ *
+ *  Implementation of the lazy decoding of received meta data
+ *
+ *  @copyright 2018 Copernica BV
+ */
+#include "includes.h"
+#include "fieldcheck.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Read incoming frame
+ *
+ *  The properties are not yet decoded, the object only keeps a view on the
+ *  raw data in the frame (the properties are copied when the meta data is
+ *  assigned to a message with the set() method).
+ *
+ *  @param  frame
+ */
+MetaData::MetaData(ReceivedFrame &frame) :
+    _bools1(frame),
+    _bools2(frame)
+{
+    // the properties that were sent, none of them is decoded yet
+    _received = _pending = flags();
+
+    // nothing else to do if no properties were sent
+    if (_received == 0) return;
+
+    // the properties fill up the rest of the frame
+    _rawSize = frame.remaining();
+    _view = frame.nextData(_rawSize);
+
+    // check all properties (including the fields in the headers table, so that malformed
+    // data is reported right away and not when a property is accessed), and find out 
+    // where the last one ends
+    uint32_t offset = 0;
+    for (uint32_t bit = 15; bit >= 2; --bit) if (_received & (1 << bit)) offset = skip(bit, offset, true);
+
+    // trailing data is not part of the properties
+    _rawSize = offset;
+}
+
+/**
+ *  Find the offset of the property after a certain property in the raw data
+ *  @param  bit         the bit of the property (see flags())
+ *  @param  offset      offset of the property in the raw data
+ *  @param  nested      should the fields in the headers table be checked too?
+ *  @return uint32_t
+ *  @throws ProtocolException   if the property does not fit in the raw data
+ */
+uint32_t MetaData::skip(uint32_t bit, uint32_t offset, bool nested) const
+{
+    // delivery mode and priority are single octets, the timestamp is a 64-bit integer,
+    // the headers are a table, and all other properties are short strings
+    char type = bit == 12 || bit == 11 ? 'B' : bit == 6 ? 'T' : bit == 13 ? 'F' : 's';
+
+    // this is where the next property starts
+    return offset + (uint32_t)FieldCheck(raw() + offset, _rawSize - offset, type, nested).size();
+}
+
+/**
+ *  Decode a property that was received, but not yet decoded
+ *  @param  bit         the bit of the property (see flags())
+ */
+void MetaData::decode(uint32_t bit) const
+{
+    // the property is no longer pending (even if it turns out to be malformed)
+    _pending &= ~(1 << bit);
+
+    // skip all the properties that come before it
+    uint32_t offset = 0;
+    for (uint32_t i = 15; i > bit; --i) if (_received & (1 << i)) offset = skip(i, offset);
+
+    // the property is decoded from the raw data
+    ByteBuffer buffer(raw() + offset, _rawSize - offset);
+    ReceivedFrame frame(buffer);
+
+    // decode the property
+    switch (bit)
+    {
+        case 15:    _contentType = ShortString(frame); break;
+        case 14:    _contentEncoding = ShortString(frame); break;
+        case 13:    _headers = Table(frame); break;
+        case 12:    _deliveryMode = UOctet(frame); break;
+        case 11:    _priority = UOctet(frame); break;
+        case 10:    _correlationID = ShortString(frame); break;
+        case 9:     _replyTo = ShortString(frame); break;
+        case 8:     _expiration = ShortString(frame); break;
+        case 7:     _messageID = ShortString(frame); break;
+        case 6:     _timestamp = Timestamp(frame); break;
+        case 5:     _typeName = ShortString(frame); break;
+        case 4:     _userID = ShortString(frame); break;
+        case 3:     _appID = ShortString(frame); break;
+        case 2:     _clusterID = ShortString(frame); break;
+    }
+}
+
+/**
+ *  End of namespace
+ */
+}
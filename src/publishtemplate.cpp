@@ -0,0 +1,62 @@
+/**
+ *  PublishTemplate.cpp
+ *
+ *  Implementation of the PublishTemplate class
+ *
+ *  @copyright 2018 Copernica BV
+ */
+#include "includes.h"
+#include "basicpublishframe.h"
+#include "basicheaderframe.h"
+#include "stringbuffer.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Constructor
+ *  @param  exchange    the exchange to publish to
+ *  @param  routingkey  the routing key
+ *  @param  metadata    the properties of the messages
+ *  @param  flags       optional flags
+ */
+PublishTemplate::PublishTemplate(const std::string &exchange, const std::string &routingKey, const MetaData &metadata, int flags)
+{
+    // the header frame is constructed from an envelope, which gets the properties (the body is not used)
+    Envelope envelope(nullptr, 0);
+    envelope.set(metadata);
+
+    // the frames are encoded for channel 0, and with an empty body
+    BasicPublishFrame publishframe(0, exchange, routingKey, (flags & mandatory) != 0, (flags & immediate) != 0);
+    BasicHeaderFrame headerframe(0, envelope);
+
+    // the frames are filled via their base class
+    const Frame &method = publishframe, &header = headerframe;
+
+    // allocate all the memory at once (the end-of-frame separators are not stored)
+    _data.reserve(method.totalSize() + header.totalSize() - 2);
+
+    // encode the method frame, the header frame starts right after it
+    StringBuffer buffer(_data);
+    method.fill(buffer);
+    _split = _data.size();
+
+    // encode the header frame
+    header.fill(buffer);
+}
+
+/**
+ *  Constructor for messages without properties
+ *  @param  exchange    the exchange to publish to
+ *  @param  routingkey  the routing key
+ *  @param  flags       optional flags
+ */
+PublishTemplate::PublishTemplate(const std::string &exchange, const std::string &routingKey, int flags) :
+    PublishTemplate(exchange, routingKey, Envelope(nullptr, 0), flags) {}
+
+/**
+ *  End of namespace
+ */
+}
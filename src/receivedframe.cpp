@@ -90,11 +90,20 @@ ReceivedFrame::ReceivedFrame(const Buffer &buffer, uint32_t max) : _buffer(buffe
     // we need enough room for type, channel, the payload size, 
     // the the end-of-frame byte is not yet necessary
     if (buffer.size() < 7) return;
-    
+
+    // if the buffer is stored in one continuous block of memory, we can
+    // decode straight from memory instead of going through the virtual methods
+    const char *data = buffer.contiguous(0, buffer.size());
+
     // get the information
-    _type = nextUint8();
-    _channel = nextUint16();
-    _payloadSize = nextUint32();
+    if (data) decode(data);
+    else
+    {
+        // read via the buffer
+        _type = nextUint8();
+        _channel = nextUint16();
+        _payloadSize = nextUint32();
+    }
 
     // is the frame size bigger than the max frame size?
     if (max > 0 && _payloadSize > max - 8) throw ProtocolException("frame size exceeded");
@@ -103,10 +112,49 @@ ReceivedFrame::ReceivedFrame(const Buffer &buffer, uint32_t max) : _buffer(buffe
     if (!complete()) return;
 
     // buffer is big enough, check for a valid end-of-frame marker
-    if ((uint8_t)buffer.byte(_payloadSize+7) == END_OF_FRAME) return;
+    if ((uint8_t)(data ? data[_payloadSize+7] : buffer.byte(_payloadSize+7)) != END_OF_FRAME) throw ProtocolException("invalid end of frame marker");
+
+    // the frame is complete, from now on all fields can be read straight from memory
+    _data = data;
+}
+
+/**
+ *  Decode the frame header straight from memory
+ *  @param  data        pointer to the first byte of the frame
+ */
+void ReceivedFrame::decode(const char *data)
+{
+    // the type is stored in the first byte
+    _type = (uint8_t)data[0];
+
+    // followed by the channel and the payload size in network byte order
+    memcpy(&_channel, data + 1, sizeof(uint16_t));
+    memcpy(&_payloadSize, data + 3, sizeof(uint32_t));
+
+    // convert to host-byte-order
+    _channel = be16toh(_channel);
+    _payloadSize = be32toh(_payloadSize);
+
+    // the header has been processed
+    _skip = 7;
+}
+
+/**
+ *  Pointer to the next bytes in memory, for frames that are stored in
+ *  continuous memory, this is the only bounds check that is needed
+ *  @param  size        number of bytes to consume
+ *  @return const char*
+ */
+inline const char *ReceivedFrame::fetch(uint32_t size)
+{
+    // the frame is complete, we only have to check that we do not read past its end
+    if (size > _payloadSize + 7 - _skip) throw ProtocolException("frame out of range");
+
+    // update the number of bytes to skip
+    _skip += size;
 
-    // the frame is invalid because it does not end with the expected char
-    throw ProtocolException("invalid end of frame marker");
+    // expose the data
+    return _data + _skip - size;
 }
 
 /**
@@ -135,6 +183,9 @@ bool ReceivedFrame::complete() const
  */
 uint8_t ReceivedFrame::nextUint8()
 {
+    // read straight from memory if possible
+    if (_data) return (uint8_t)*fetch(1);
+
     // check if there is enough size
     FrameCheck check(this, 1);
     
@@ -150,6 +201,9 @@ uint8_t ReceivedFrame::nextUint8()
  */
 int8_t ReceivedFrame::nextInt8()
 {
+    // read straight from memory if possible
+    if (_data) return (int8_t)*fetch(1);
+
     // check if there is enough size
     FrameCheck check(this, 1);
     
@@ -164,12 +218,20 @@ int8_t ReceivedFrame::nextInt8()
  */
 uint16_t ReceivedFrame::nextUint16()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(uint16_t));
-    
-    // get two bytes, and convert to host-byte-order
+    // the value to read
     uint16_t value;
-    _buffer.copy(_skip, sizeof(uint16_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(uint16_t)), sizeof(uint16_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(uint16_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(uint16_t), &value);
+    }
+
     return be16toh(value);
 }
 
@@ -180,12 +242,20 @@ uint16_t ReceivedFrame::nextUint16()
  */
 int16_t ReceivedFrame::nextInt16()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(int16_t));
-    
-    // get two bytes, and convert to host-byte-order
+    // the value to read
     int16_t value;
-    _buffer.copy(_skip, sizeof(int16_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(int16_t)), sizeof(int16_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(int16_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(int16_t), &value);
+    }
+
     return be16toh(value);
 }
 
@@ -196,12 +266,20 @@ int16_t ReceivedFrame::nextInt16()
  */
 uint32_t ReceivedFrame::nextUint32()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(uint32_t));
-    
-    // get four bytes, and convert to host-byte-order
+    // the value to read
     uint32_t value;
-    _buffer.copy(_skip, sizeof(uint32_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(uint32_t)), sizeof(uint32_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(uint32_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(uint32_t), &value);
+    }
+
     return be32toh(value);
 }
 
@@ -212,12 +290,20 @@ uint32_t ReceivedFrame::nextUint32()
  */
 int32_t ReceivedFrame::nextInt32()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(int32_t));
-    
-    // get four bytes, and convert to host-byte-order
+    // the value to read
     int32_t value;
-    _buffer.copy(_skip, sizeof(int32_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(int32_t)), sizeof(int32_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(int32_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(int32_t), &value);
+    }
+
     return be32toh(value);
 }
 
@@ -228,12 +314,20 @@ int32_t ReceivedFrame::nextInt32()
  */
 uint64_t ReceivedFrame::nextUint64()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(uint64_t));
-    
-    // get eight bytes, and convert to host-byte-order
+    // the value to read
     uint64_t value;
-    _buffer.copy(_skip, sizeof(uint64_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(uint64_t)), sizeof(uint64_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(uint64_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(uint64_t), &value);
+    }
+
     return be64toh(value);
 }
 
@@ -244,12 +338,20 @@ uint64_t ReceivedFrame::nextUint64()
  */
 int64_t ReceivedFrame::nextInt64()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(int64_t));
-    
-    // get eight bytes, and convert to host-byte-order
+    // the value to read
     int64_t value;
-    _buffer.copy(_skip, sizeof(int64_t), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(int64_t)), sizeof(int64_t));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(int64_t));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(int64_t), &value);
+    }
+
     return be64toh(value);
 }
 
@@ -260,12 +362,20 @@ int64_t ReceivedFrame::nextInt64()
  */
 float ReceivedFrame::nextFloat()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(float));
-    
-    // get four bytes
+    // the value to read
     float value;
-    _buffer.copy(_skip, sizeof(float), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(float)), sizeof(float));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(float));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(float), &value);
+    }
+
     return value;
 }
 
@@ -276,12 +386,20 @@ float ReceivedFrame::nextFloat()
  */
 double ReceivedFrame::nextDouble()
 {
-    // check if there is enough size
-    FrameCheck check(this, sizeof(double));
-    
-    // get eight bytes, and convert to host-byte-order
+    // the value to read
     double value;
-    _buffer.copy(_skip, sizeof(double), &value);
+
+    // read straight from memory if possible
+    if (_data) memcpy(&value, fetch(sizeof(double)), sizeof(double));
+    else
+    {
+        // check if there is enough size
+        FrameCheck check(this, sizeof(double));
+        
+        // get the bytes
+        _buffer.copy(_skip, sizeof(double), &value);
+    }
+
     return value;
 }
 
@@ -292,6 +410,9 @@ double ReceivedFrame::nextDouble()
  */
 const char * ReceivedFrame::nextData(uint32_t size)
 {
+    // expose straight from memory if possible
+    if (_data) return fetch(size);
+
     // check if there is enough size
     FrameCheck check(this, size);
     
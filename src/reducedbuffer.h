@@ -93,6 +93,17 @@ public:
     {
         return _buffer.copy(pos + _skip, size, buffer);
     }
+
+    /**
+     *  Get access to the raw data, if it is stored continuously
+     *  @param  pos         position in the buffer
+     *  @param  size        number of continuous bytes
+     *  @return char*
+     */
+    virtual const char *contiguous(size_t pos, size_t size) const override
+    {
+        return _buffer.contiguous(pos + _skip, size);
+    }
 };
 
 /**
@@ -0,0 +1,66 @@
+/**
+ *  StringBuffer.h
+ *
+ *  Output buffer that appends all data to a std::string, this is used to
+ *  encode fields into tables
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <string>
+#include "amqpcpp/outbuffer.h"
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class StringBuffer : public OutBuffer
+{
+private:
+    /**
+     *  The string to append to
+     *  @var std::string
+     */
+    std::string &_target;
+
+protected:
+    /**
+     *  The method that adds the actual data
+     *  @param  data
+     *  @param  size
+     */
+    virtual void append(const void *data, size_t size) override
+    {
+        // add to the string
+        _target.append((const char *)data, size);
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  target      the string to append to
+     */
+    StringBuffer(std::string &target) : _target(target) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~StringBuffer() {}
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -1,4 +1,7 @@
 #include "includes.h"
+#include "stringbuffer.h"
+#include "fieldarena.h"
+#include "fieldcheck.h"
 #include <algorithm>
 
 // we live in the copernica namespace
@@ -14,42 +17,19 @@ Table::Table(ReceivedFrame &frame)
     // table buffer begins with the number of bytes to read
     uint32_t bytesToRead = frame.nextUint32();
 
-    // keep going until the correct number of bytes is read.
-    while (bytesToRead > 0)
-    {
-        // field name and type
-        ShortString name(frame);
-
-        // subtract number of bytes to read, plus one byte for the decoded type
-        bytesToRead -= (uint32_t)(name.size() + 1);
-
-        // get the field
-        Field *field = Field::decode(frame);
-        if (!field) continue;
+    // the fields are stored in their encoded form
+    _data.assign(frame.nextData(bytesToRead), bytesToRead);
 
-        // add field
-        _fields[name] = std::shared_ptr<Field>(field);
-
-        // subtract size
-        bytesToRead -= (uint32_t)field->size();
-    }
+    // check all fields right away, including the nested tables and arrays (they are
+    // only decoded when they are retrieved, and by then they can no longer be rejected)
+    FieldCheck::table(_data.data(), _data.size());
 }
 
 /**
  *  Copy constructor
  *  @param  table
  */
-Table::Table(const Table &table)
-{
-    // loop through the table records
-    for (auto iter = table._fields.begin(); iter != table._fields.end(); iter++)
-    {
-        // since a map is always ordered, we know that each element will
-        // be inserted at the end of the new map, so we can simply use
-        // emplace_hint and hint at insertion at the end of the map
-        _fields.insert(_fields.end(), std::make_pair(iter->first, iter->second->clone()));
-    }
-}
+Table::Table(const Table &table) : _data(table._data) {}
 
 /**
  *  Assignment operator
@@ -61,15 +41,12 @@ Table &Table::operator=(const Table &table)
     // skip self assignment
     if (this == &table) return *this;
 
-    // empty current fields
-    _fields.clear();
+    // copy the encoded fields
+    _data = table._data;
 
-    // loop through the table records
-    for (auto iter = table._fields.begin(); iter != table._fields.end(); iter++)
-    {
-        // add the field
-        _fields[iter->first] = std::shared_ptr<Field>(iter->second->clone());
-    }
+    // the decoded fields are no longer valid
+    _decoded.clear();
+    _arena.reset();
 
     // done
     return *this;
@@ -85,13 +62,100 @@ Table &Table::operator=(Table &&table)
     // skip self assignment
     if (this == &table) return *this;
 
-    // copy fields
-    _fields = std::move(table._fields);
+    // move fields
+    _data = std::move(table._data);
+    _decoded = std::move(table._decoded);
+    _arena = std::move(table._arena);
 
     // done
     return *this;
 }
 
+/**
+ *  Find the position of the next field in the encoded data
+ *  @param  pos     position of a field
+ *  @return size_t  position of the field after it
+ *  @throws ProtocolException   if the encoded data is invalid
+ */
+size_t Table::next(size_t pos) const
+{
+    // the field name is a short string, followed by the type
+    pos += 1 + (uint8_t)_data[pos] + 1;
+
+    // the type must be there
+    if (pos > _data.size()) throw ProtocolException("frame out of range");
+
+    // this is where the next field starts
+    return pos + FieldCheck(_data.data() + pos, _data.size() - pos, _data[pos - 1], false).size();
+}
+
+/**
+ *  Find the position of a field in the encoded data
+ *  @param  name    field name
+ *  @return size_t  position of the field, or std::string::npos if it is not in the table
+ */
+size_t Table::find(const std::string &name) const
+{
+    // the result (if a name occurs more than once, the last one wins)
+    size_t result = std::string::npos;
+
+    // walk over the fields
+    for (size_t pos = 0; pos < _data.size(); pos = next(pos))
+    {
+        // compare the name
+        if ((uint8_t)_data[pos] == name.size() && _data.compare(pos + 1, name.size(), name) == 0) result = pos;
+    }
+
+    // done
+    return result;
+}
+
+/**
+ *  Remove a field from the encoded data
+ *  @param  name    field name
+ */
+void Table::remove(const std::string &name)
+{
+    // the decoded field is no longer valid, and its memory can not be reused, so the
+    // next decoded field goes into a new arena (the old arena is released as soon as
+    // its remaining fields are removed too, and the fields that were handed out are gone)
+    if (_decoded.erase(name) > 0) _arena.reset();
+
+    // remove all occurences
+    for (size_t pos = find(name); pos != std::string::npos; pos = find(name)) _data.erase(pos, next(pos) - pos);
+}
+
+/**
+ *  Set a field
+ *  @param  name    field name
+ *  @param  value   field value
+ *  @return Table
+ */
+Table &Table::set(const std::string &name, const Field &value)
+{
+    // remove the old value
+    remove(name);
+
+    // find the position where the field should go (the fields are sorted)
+    size_t pos = 0;
+    while (pos < _data.size() && _data.compare(pos + 1, (uint8_t)_data[pos], name) < 0) pos = next(pos);
+
+    // the current size
+    size_t size = _data.size();
+
+    // encode the field at the end of the data
+    StringBuffer buffer(_data);
+    ShortString(name).fill(buffer);
+    buffer.add((uint8_t)value.typeID());
+    value.fill(buffer);
+
+    // move it to the right position
+    std::rotate(_data.begin() + pos, _data.begin() + size, _data.end());
+
+    // allow chaining
+    return *this;
+}
+
 /**
  *  Retrieve all keys in the table
  *
@@ -101,10 +165,15 @@ std::vector<std::string> Table::keys() const
 {
     // the result vector
     std::vector<std::string> result;
-    result.reserve(_fields.size());
 
     // insert all keys into the result vector
-    for (auto &iter : _fields) result.push_back(iter.first);
+    for (size_t pos = 0; pos < _data.size(); pos = next(pos)) result.emplace_back(_data, pos + 1, (uint8_t)_data[pos]);
+
+    // the keys are sorted, unless the table was received in a different order
+    std::sort(result.begin(), result.end());
+
+    // remove keys that occur more than once
+    result.erase(std::unique(result.begin(), result.end()), result.end());
 
     // now return the result
     return result;
@@ -123,41 +192,36 @@ const Field &Table::get(const std::string &name) const
     // we need an empty string
     static ShortString empty;
 
-    // locate the element first
-    auto iter(_fields.find(name));
+    // was the field already decoded?
+    auto iter(_decoded.find(name));
 
     // check whether the field was found
-    if (iter == _fields.end()) return empty;
+    if (iter != _decoded.end()) return *iter->second;
 
-    // done
-    return *iter->second;
-}
+    // locate the field in the encoded data
+    auto pos = find(name);
 
-/**
- *  Get the size this field will take when
- *  encoded in the AMQP wire-frame format
- */
-size_t Table::size() const
-{
-    // add the size of the uint32_t indicating the size
-    size_t size = 4;
+    // check whether the field was found
+    if (pos == std::string::npos) return empty;
 
-    // iterate over all elements
-    for (auto iter(_fields.begin()); iter != _fields.end(); ++iter)
-    {
-        // get the size of the field name
-        ShortString name(iter->first);
-        size += name.size();
+    // the type and the value come after the name
+    size_t start = pos + 1 + name.size();
 
-        // add the size of the field type
-        size += sizeof(iter->second->typeID());
+    // decode the field
+    ByteBuffer buffer(_data.data() + start, next(pos) - start);
+    ReceivedFrame frame(buffer);
 
-        // add size of element to the total
-        size += iter->second->size();
-    }
+    // the decoded fields share one arena, so that they need no allocations of their own
+    if (!_arena) _arena = std::make_shared<FieldArena>();
+
+    // decode the field into the arena
+    Field *field = Field::decode(frame, *_arena);
+
+    // check whether the field could be decoded
+    if (!field) return empty;
 
-    // return the result
-    return size;
+    // store the decoded field (the pointer shares the ownership of the arena)
+    return *(_decoded[name] = std::shared_ptr<Field>(_arena, field));
 }
 
 /**
@@ -166,21 +230,10 @@ size_t Table::size() const
 void Table::fill(OutBuffer& buffer) const
 {
     // add size
-    buffer.add(static_cast<uint32_t>(size()-4));
+    buffer.add(static_cast<uint32_t>(_data.size()));
 
-    // loop through the fields
-    for (auto iter(_fields.begin()); iter != _fields.end(); ++iter)
-    {
-        // encode the field name
-        ShortString name(iter->first);
-        name.fill(buffer);
-
-        // encode the element type
-        buffer.add((uint8_t) iter->second->typeID());
-
-        // encode element
-        iter->second->fill(buffer);
-    }
+    // add the encoded fields
+    buffer.add(_data.data(), (uint32_t)_data.size());
 }
 
 // end namespace
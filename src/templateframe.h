@@ -0,0 +1,106 @@
+/**
+ *  TemplateFrame.h
+ *
+ *  Frame that is sent from the pre-encoded data in a publish template, only
+ *  the channel id and (for header frames) the body size are filled in
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Set up namespace
+ */
+namespace AMQP {
+
+/**
+ *  Class definition
+ */
+class TemplateFrame : public Frame
+{
+private:
+    /**
+     *  The encoded frame (without the end-of-frame separator)
+     *  @var const char *
+     */
+    const char *_data;
+
+    /**
+     *  Size of the encoded frame
+     *  @var uint32_t
+     */
+    uint32_t _size;
+
+    /**
+     *  The channel id to fill in
+     *  @var uint16_t
+     */
+    uint16_t _channel;
+
+    /**
+     *  Offset of the body size in the frame (or 0 if the frame has no body size)
+     *  @var uint32_t
+     */
+    uint32_t _offset;
+
+    /**
+     *  The body size to fill in
+     *  @var uint64_t
+     */
+    uint64_t _bodySize;
+
+public:
+    /**
+     *  Constructor
+     *  @param  data        the encoded frame
+     *  @param  size        size of the encoded frame
+     *  @param  channel     the channel id to fill in
+     *  @param  offset      offset of the body size in the frame (0 for none)
+     *  @param  bodySize    the body size to fill in
+     */
+    TemplateFrame(const char *data, uint32_t size, uint16_t channel, uint32_t offset = 0, uint64_t bodySize = 0) :
+        _data(data), _size(size), _channel(channel), _offset(offset), _bodySize(bodySize) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~TemplateFrame() {}
+
+    /**
+     *  return the total size of the frame
+     *  @return uint32_t
+     */
+    virtual uint32_t totalSize() const override
+    {
+        // the encoded frame plus the end-of-frame separator
+        return _size + 1;
+    }
+
+    /**
+     *  Fill an output buffer
+     *  @param  buffer
+     */
+    virtual void fill(OutBuffer &buffer) const override
+    {
+        // the frame type, followed by the channel id
+        buffer.add((uint8_t)_data[0]);
+        buffer.add(_channel);
+
+        // frames without a body size can be copied right away
+        if (_offset == 0) return buffer.add(_data + 3, _size - 3);
+
+        // the data up to the body size, the body size, and the rest of the frame
+        buffer.add(_data + 3, _offset - 3);
+        buffer.add(_bodySize);
+        buffer.add(_data + _offset + 8, _size - _offset - 8);
+    }
+};
+
+/**
+ *  End of namespace
+ */
+}
@@ -0,0 +1,258 @@
+/**
+ *  AckWindow.cpp
+ *
+ *  Test program for the window that coalesces acknowledgements: the acks
+ *  that are flushed must cover exactly the messages that the application
+ *  acked, and a multiple ack must never cover a message that was not acked
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <amqpcpp/ackwindow.h>
+#include <set>
+#include <vector>
+#include <random>
+#include <iterator>
+#include "check.h"
+
+/**
+ *  Model of the server side: the messages that the server still waits for
+ */
+class Server
+{
+private:
+    /**
+     *  The delivery tags that were not yet acked or rejected
+     *  @var std::set<uint64_t>
+     */
+    std::set<uint64_t> _unacked;
+
+    /**
+     *  The delivery tags that the application acked, but that were not yet sent
+     *  @var std::set<uint64_t>
+     */
+    std::set<uint64_t> _acked;
+
+public:
+    /**
+     *  The acks that were sent, as pairs of the tag and the multiple flag
+     *  @var std::vector<std::pair<uint64_t, bool>>
+     */
+    std::vector<std::pair<uint64_t, bool>> sent;
+
+    /**
+     *  Deliver a message
+     *  @param  window
+     *  @param  tag
+     *  @param  noack
+     */
+    void deliver(AMQP::AckWindow &window, uint64_t tag, bool noack)
+    {
+        // the server waits for the message, unless it does not have to be acked
+        if (!noack) _unacked.insert(tag);
+
+        // pass on to the window
+        window.delivered(tag, noack);
+    }
+
+    /**
+     *  Let the application ack a message
+     *  @param  window
+     *  @param  tag
+     */
+    void ack(AMQP::AckWindow &window, uint64_t tag)
+    {
+        // the window accepts the ack only if the message is outstanding
+        bool outstanding = _unacked.count(tag) > 0 && _acked.count(tag) == 0;
+        CHECK(window.ack(tag) == outstanding);
+
+        // remember the ack
+        if (outstanding) _acked.insert(tag);
+    }
+
+    /**
+     *  Let the application reject a message (this is sent right away)
+     *  @param  window
+     *  @param  tag
+     */
+    void reject(AMQP::AckWindow &window, uint64_t tag)
+    {
+        // only outstanding messages can be rejected
+        if (_unacked.count(tag) == 0 || _acked.count(tag) > 0) return;
+
+        // the message is settled
+        _unacked.erase(tag);
+        window.settle(tag, false);
+    }
+
+    /**
+     *  Flush the window
+     *  @param  window
+     */
+    void flush(AMQP::AckWindow &window)
+    {
+        // flush the acks
+        window.flush([this](uint64_t tag, bool multiple) {
+
+            // remember what was sent
+            sent.emplace_back(tag, multiple);
+
+            // the first message that is acked, and the message after the last one
+            auto first = multiple ? _unacked.begin() : _unacked.find(tag);
+            auto last = _unacked.upper_bound(tag);
+            CHECK(first != _unacked.end() && *first <= tag);
+
+            // a single ack covers only one message
+            if (!multiple) last = std::next(first);
+
+            // all messages that are acked must have been acked by the application
+            for (auto iter = first; iter != last; ++iter) CHECK(_acked.erase(*iter) == 1);
+
+            // the server no longer waits for them
+            _unacked.erase(first, last);
+        });
+
+        // everything that the application acked was sent
+        CHECK(_acked.empty() && window.pending() == 0);
+    }
+};
+
+/**
+ *  Test flushing acks with gaps in between
+ */
+static void testGaps()
+{
+    // a window for a channel that has not received messages before
+    AMQP::AckWindow window(0, 100);
+    Server server;
+
+    // deliver messages
+    for (uint64_t tag = 1; tag <= 12; ++tag) server.deliver(window, tag, false);
+
+    // ack the first messages: this becomes a single multiple ack
+    for (uint64_t tag = 1; tag <= 3; ++tag) server.ack(window, tag);
+    CHECK(window.pending() == 3);
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 3, true } }));
+
+    // ack messages after a gap: these can not be coalesced
+    server.sent.clear();
+    server.ack(window, 5);
+    server.ack(window, 6);
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 5, false }, { 6, false } }));
+
+    // fill the gap: the one message is acked on its own
+    server.sent.clear();
+    server.ack(window, 4);
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 4, false } }));
+
+    // a rejected message in between does not stop the coalescing
+    server.sent.clear();
+    server.ack(window, 7);
+    server.reject(window, 8);
+    server.ack(window, 9);
+    server.ack(window, 11);
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 9, true }, { 11, false } }));
+
+    // a message can not be acked twice
+    server.ack(window, 9);
+    CHECK(window.pending() == 0);
+
+    // messages without acks do not stop the coalescing either
+    server.sent.clear();
+    server.deliver(window, 13, true);
+    server.deliver(window, 14, false);
+    server.ack(window, 10);
+    server.ack(window, 12);
+    server.ack(window, 14);
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 14, true } }));
+
+    // flushing without acks does nothing
+    server.sent.clear();
+    server.flush(window);
+    CHECK(server.sent.empty());
+}
+
+/**
+ *  Test a window for a channel that already received messages before
+ */
+static void testStarted()
+{
+    // the window does not know about the earlier messages, so it can not use multiple acks
+    AMQP::AckWindow window(5, 100);
+    Server server;
+
+    // deliver and ack messages
+    for (uint64_t tag = 6; tag <= 8; ++tag) server.deliver(window, tag, false);
+    for (uint64_t tag = 6; tag <= 8; ++tag) server.ack(window, tag);
+
+    // the acks are sent one by one
+    server.flush(window);
+    CHECK((server.sent == std::vector<std::pair<uint64_t, bool>>{ { 6, false }, { 7, false }, { 8, false } }));
+
+    // earlier messages are unknown
+    CHECK(!window.ack(3));
+}
+
+/**
+ *  Test random sequences of deliveries, acks, rejects and flushes
+ */
+static void testRandom()
+{
+    // random numbers (with a fixed seed, so that failures can be reproduced)
+    std::mt19937 random(2018);
+
+    // run a number of sequences
+    for (size_t sequence = 0; sequence < 100; ++sequence)
+    {
+        // the window and the server
+        AMQP::AckWindow window(0, 100);
+        Server server;
+
+        // the last tag that was delivered
+        uint64_t delivered = 0;
+
+        // perform random operations
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            // a message that was already delivered (if any)
+            uint64_t tag = delivered > 0 ? 1 + random() % delivered : 0;
+
+            // pick an operation
+            switch (random() % 10)
+            {
+            case 0: case 1: case 2: server.deliver(window, ++delivered, random() % 5 == 0); break;
+            case 3: case 4: case 5: case 6: if (tag > 0) server.ack(window, tag); break;
+            case 7: if (tag > 0) server.reject(window, tag); break;
+            case 8: server.flush(window); break;
+            case 9: if (tag > 0) server.ack(window, delivered); break;
+            }
+        }
+
+        // flush the rest
+        server.flush(window);
+    }
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // run the tests
+    testGaps();
+    testStarted();
+    testRandom();
+
+    // done
+    return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ *  Check.h
+ *
+ *  Minimal helper for the test programs: a check that is not compiled away
+ *  in release builds (like assert() would be), and that makes the program
+ *  fail with the location of the check
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <iostream>
+#include <cstdlib>
+
+/**
+ *  Check a condition, and stop the test if it does not hold
+ *  @param  condition
+ */
+#define CHECK(condition) \
+    do { \
+        if (condition) break; \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+        std::exit(EXIT_FAILURE); \
+    } while (false)
+
+/**
+ *  Check that an expression throws an exception of a certain type
+ *  @param  expression
+ *  @param  type
+ */
+#define CHECK_THROWS(expression, type) \
+    do { \
+        bool thrown = false; \
+        try { expression; } catch (const type &) { thrown = true; } \
+        CHECK(thrown); \
+    } while (false)
@@ -0,0 +1,339 @@
+/**
+ *  ConfirmedPublisher.cpp
+ *
+ *  Test program for the confirmed publisher: every message must be confirmed
+ *  exactly once, also when the server confirms multiple messages at once, and
+ *  when the tags wrap around in the ring in which the messages are kept
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include "check.h"
+#include "stream.h"
+
+/**
+ *  Handler that throws away all outgoing data
+ */
+class NullHandler : public AMQP::ConnectionHandler
+{
+public:
+    /**
+     *  Number of errors that were reported
+     *  @var size_t
+     */
+    size_t errors = 0;
+
+    /**
+     *  Number of bytes that were sent
+     *  @var size_t
+     */
+    size_t sent = 0;
+
+    /**
+     *  Method that is called when data has to be sent
+     *  @param  connection
+     *  @param  buffer
+     *  @param  size
+     */
+    virtual void onData(AMQP::Connection *connection, const char *buffer, size_t size) override
+    {
+        // count the bytes
+        sent += size;
+    }
+
+    /**
+     *  Method that is called when the connection ends up in an error state
+     *  @param  connection
+     *  @param  message
+     */
+    virtual void onError(AMQP::Connection *connection, const char *message) override
+    {
+        ++errors;
+    }
+};
+
+/**
+ *  Connection with a channel in confirm mode, and the results of the messages
+ */
+class Fixture
+{
+public:
+    /**
+     *  The handler, the connection and the channel
+     */
+    NullHandler handler;
+    AMQP::Connection connection;
+    AMQP::Channel channel;
+
+    /**
+     *  The publisher
+     *  @var AMQP::ConfirmedPublisher
+     */
+    AMQP::ConfirmedPublisher publisher;
+
+    /**
+     *  Number of acks and nacks of each message (by delivery tag)
+     *  @var std::vector<size_t>
+     */
+    std::vector<size_t> acks;
+    std::vector<size_t> nacks;
+
+    /**
+     *  Number of messages that could not be published
+     *  @var size_t
+     */
+    size_t rejected = 0;
+
+    /**
+     *  Pass data from the server to the connection
+     *  @param  stream
+     */
+    void receive(const Stream &stream)
+    {
+        // all data must be processed
+        CHECK(connection.parse(stream.data().data(), stream.data().size()) == stream.data().size());
+    }
+
+    /**
+     *  Constructor
+     *  @param  window      max number of unconfirmed messages
+     */
+    Fixture(size_t window) : connection(&handler), channel(&connection), publisher(channel, window), acks(1), nacks(1)
+    {
+        // the stream that the server sends
+        Stream stream;
+
+        // connection.start, connection.tune and connection.open-ok
+        stream.method(0, 10, 10).u8(0).u8(9).u32(0).longstr("PLAIN").longstr("en_US").end();
+        stream.method(0, 10, 30).u16(0).u32(131072).u16(0).end();
+        stream.method(0, 10, 41).shortstr("").end();
+
+        // channel.open-ok and confirm.select-ok
+        stream.method(1, 20, 11).longstr("").end();
+        stream.method(1, 85, 11).end();
+
+        // pass it to the connection
+        receive(stream);
+    }
+
+    /**
+     *  Publish a message
+     *  @param  headers     size of a header that is added to the message
+     *  @return bool        was the message published?
+     */
+    bool publish(size_t headers = 0)
+    {
+        // the tag that the message will get
+        size_t tag = acks.size();
+
+        // the message can be refused right away (the error callback is also called
+        // for a nack later on, when this function has already returned)
+        auto failed = std::make_shared<bool>(false);
+
+        // the message to publish
+        AMQP::Envelope envelope("message", 7);
+
+        // add a header of the requested size
+        if (headers > 0) envelope.setHeaders(AMQP::Table().set("header", std::string(headers, 'x')));
+
+        // publish the message
+        publisher.publish("exchange", "key", envelope)
+            .onAck([this, tag]() { ++acks[tag]; })
+            .onNack([this, tag]() { ++nacks[tag]; })
+            .onError([failed](const char *message) { *failed = true; });
+
+        // if the message was refused, it has no tag
+        if (*failed) return ++rejected, false;
+
+        // administration for the new tag
+        acks.push_back(0);
+        nacks.push_back(0);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Let the server ack messages
+     *  @param  tag         the delivery tag
+     *  @param  multiple    all messages up to and including the tag?
+     */
+    void ack(uint64_t tag, bool multiple)
+    {
+        // basic.ack
+        Stream stream;
+        stream.method(1, 60, 80).u64(tag).u8(multiple).end();
+        receive(stream);
+    }
+
+    /**
+     *  Let the server nack messages
+     *  @param  tag         the delivery tag
+     *  @param  multiple    all messages up to and including the tag?
+     */
+    void nack(uint64_t tag, bool multiple)
+    {
+        // basic.nack
+        Stream stream;
+        stream.method(1, 60, 120).u64(tag).u8(multiple ? 1 : 0).end();
+        receive(stream);
+    }
+
+    /**
+     *  Number of messages that were confirmed more than once, or not at all
+     *  @param  last        the last tag that should be confirmed
+     *  @return size_t
+     */
+    size_t wrong(uint64_t last) const
+    {
+        // the result
+        size_t result = 0;
+
+        // check the messages
+        for (size_t tag = 1; tag < acks.size(); ++tag) result += acks[tag] + nacks[tag] != (tag <= last ? 1 : 0);
+
+        // done
+        return result;
+    }
+};
+
+/**
+ *  Test single and multiple confirmations while the ring grows
+ */
+static void testMultiple()
+{
+    // publisher without a window
+    Fixture fixture(0);
+
+    // publish messages (the ring has to grow a couple of times)
+    for (size_t i = 0; i < 40; ++i) CHECK(fixture.publish());
+    CHECK(fixture.publisher.unconfirmed() == 40);
+
+    // a single ack in the middle, followed by a multiple ack that includes it
+    fixture.ack(3, false);
+    CHECK(fixture.acks[3] == 1 && fixture.publisher.unconfirmed() == 40);
+    fixture.ack(10, true);
+    CHECK(fixture.wrong(10) == 0 && fixture.publisher.unconfirmed() == 30);
+
+    // a nack, and acks for tags that are already confirmed or that do not exist
+    fixture.nack(12, false);
+    fixture.ack(5, false);
+    fixture.ack(100, true);
+    CHECK(fixture.nacks[12] == 1 && fixture.acks[12] == 0);
+    CHECK(fixture.publisher.unconfirmed() == 30);
+
+    // confirm all messages at once
+    fixture.ack(40, true);
+    CHECK(fixture.wrong(40) == 0 && fixture.publisher.unconfirmed() == 0);
+    CHECK(fixture.nacks[12] == 1 && fixture.handler.errors == 0);
+}
+
+/**
+ *  Test the window, while the tags wrap around in the ring
+ */
+static void testWindow()
+{
+    // publisher with a window of ten messages
+    Fixture fixture(10);
+
+    // number of times that there was room in the window again
+    size_t available = 0;
+    fixture.publisher.onAvailable([&available]() { ++available; });
+
+    // the last tag that was confirmed
+    uint64_t confirmed = 0;
+
+    // fill the window over and over again
+    for (size_t round = 0; round < 10; ++round)
+    {
+        // publish until the window is full
+        while (!fixture.publisher.full()) CHECK(fixture.publish());
+
+        // no more messages can be published
+        CHECK(!fixture.publish());
+
+        // the last tag that was published
+        uint64_t last = fixture.acks.size() - 1;
+        CHECK(last - confirmed == 10);
+
+        // confirm the last message first, the window stays full
+        fixture.ack(last, false);
+        CHECK(fixture.publisher.full());
+
+        // confirm some messages in the middle (one of them twice)
+        fixture.nack(confirmed + 3, false);
+        fixture.ack(confirmed + 5, false);
+        fixture.ack(confirmed + 5, false);
+        CHECK(fixture.publisher.full() && available == round);
+
+        // confirm the oldest messages, this makes room in the window (the window
+        // now starts after the message that was already confirmed)
+        fixture.ack(confirmed + 4, true);
+        CHECK(!fixture.publisher.full() && available == round + 1);
+        CHECK(fixture.publisher.unconfirmed() == 5);
+
+        // confirm the rest
+        fixture.ack(last - 1, true);
+        CHECK(fixture.publisher.unconfirmed() == 0);
+        confirmed = last;
+
+        // all messages are confirmed exactly once
+        CHECK(fixture.wrong(confirmed) == 0);
+        CHECK(fixture.nacks[confirmed - 7] == 1);
+    }
+
+    // the tags wrapped around the ring a couple of times
+    CHECK(confirmed == 100 && fixture.rejected == 10);
+    CHECK(fixture.handler.errors == 0);
+}
+
+/**
+ *  Test that a message that does not fit in a frame is refused without a tag
+ */
+static void testOversized()
+{
+    // publisher without a window
+    Fixture fixture(0);
+
+    // the bytes sent so far
+    size_t sent = fixture.handler.sent;
+
+    // the header frame of this message is bigger than the max frame size
+    CHECK(!fixture.publish(200000));
+    CHECK(fixture.rejected == 1 && fixture.publisher.unconfirmed() == 0);
+
+    // nothing of the message was sent
+    CHECK(fixture.handler.sent == sent);
+
+    // the next message is published normally, and gets the first tag
+    CHECK(fixture.publish());
+    CHECK(fixture.handler.sent > sent);
+    CHECK(fixture.publisher.unconfirmed() == 1);
+
+    // the server confirms the first tag, which is the normal message
+    fixture.ack(1, false);
+    CHECK(fixture.acks[1] == 1 && fixture.wrong(1) == 0);
+    CHECK(fixture.publisher.unconfirmed() == 0);
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // run the tests
+    testMultiple();
+    testWindow();
+    testOversized();
+
+    // done
+    return 0;
+}
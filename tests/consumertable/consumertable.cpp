@@ -0,0 +1,112 @@
+/**
+ *  ConsumerTable.cpp
+ *
+ *  Test program for the table in which a channel looks up its consumers:
+ *  consumers must be found by their tag while consumers are installed and
+ *  uninstalled, and while the entries of uninstalled consumers are reused
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <amqpcpp/consumertable.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "check.h"
+
+/**
+ *  Find a consumer
+ *  @param  table
+ *  @param  tag
+ *  @return AMQP::DeferredConsumer*
+ */
+static AMQP::DeferredConsumer *find(const AMQP::ConsumerTable &table, const std::string &tag)
+{
+    // the tag is looked up in a bigger buffer, like the frame in which it is received
+    std::string buffer = "[" + tag + "]";
+
+    // look it up
+    return table.find(buffer.data() + 1, tag.size());
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // the table
+    AMQP::ConsumerTable table;
+
+    // an empty table has no consumers
+    CHECK(table.size() == 0 && find(table, "tag") == nullptr);
+
+    // the consumers and their tags
+    std::vector<std::shared_ptr<AMQP::DeferredConsumer>> consumers;
+    std::vector<std::string> tags;
+
+    // install consumers (the table has to grow a couple of times)
+    for (size_t i = 0; i < 100; ++i)
+    {
+        // create the consumer
+        consumers.push_back(std::make_shared<AMQP::DeferredConsumer>(nullptr));
+        tags.push_back("amq.ctag-" + std::to_string(i));
+
+        // install it
+        table.install(tags[i], consumers[i]);
+    }
+
+    // all consumers can be found
+    CHECK(table.size() == 100);
+    for (size_t i = 0; i < 100; ++i) CHECK(find(table, tags[i]) == consumers[i].get());
+
+    // tags that are not installed are not found (also not when they are a prefix of a tag)
+    CHECK(find(table, "amq.ctag-100") == nullptr);
+    CHECK(find(table, "amq.ctag-") == nullptr);
+    CHECK(find(table, "") == nullptr);
+
+    // installing a tag again replaces the consumer
+    auto replacement = std::make_shared<AMQP::DeferredConsumer>(nullptr);
+    table.install(tags[7], replacement);
+    CHECK(table.size() == 100 && find(table, tags[7]) == replacement.get());
+    table.install(tags[7], consumers[7]);
+
+    // uninstall every other consumer (and a tag that is not installed)
+    for (size_t i = 0; i < 100; i += 2) table.uninstall(tags[i]);
+    table.uninstall("unknown");
+
+    // only the other consumers are found
+    CHECK(table.size() == 50);
+    for (size_t i = 0; i < 100; ++i) CHECK(find(table, tags[i]) == (i % 2 ? consumers[i].get() : nullptr));
+
+    // the table no longer holds the uninstalled consumers
+    CHECK(consumers[0].use_count() == 1 && consumers[1].use_count() == 2);
+
+    // install new consumers, which reuse the entries of the uninstalled ones
+    for (size_t i = 0; i < 100; i += 2)
+    {
+        // create the consumer
+        consumers[i] = std::make_shared<AMQP::DeferredConsumer>(nullptr);
+        tags[i] = "reused-" + std::to_string(i);
+
+        // install it
+        table.install(tags[i], consumers[i]);
+    }
+
+    // all consumers can be found, and the old tags are gone
+    CHECK(table.size() == 100);
+    for (size_t i = 0; i < 100; ++i) CHECK(find(table, tags[i]) == consumers[i].get());
+    CHECK(find(table, "amq.ctag-0") == nullptr);
+
+    // uninstall everything
+    for (size_t i = 0; i < 100; ++i) table.uninstall(tags[i]);
+    CHECK(table.size() == 0 && find(table, tags[1]) == nullptr);
+    for (size_t i = 0; i < 100; ++i) CHECK(consumers[i].use_count() == 1);
+
+    // done
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ *  MessageView.cpp
+ *
+ *  Test program for the views on the messages of a batch: the meta data of a
+ *  message must stay valid after the batch callback returned, when the memory
+ *  of the batch is already reused for the next batch
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include "check.h"
+#include "stream.h"
+
+/**
+ *  Handler that throws away all outgoing data
+ */
+class NullHandler : public AMQP::ConnectionHandler
+{
+public:
+    /**
+     *  Number of errors that were reported
+     *  @var size_t
+     */
+    size_t errors = 0;
+
+    /**
+     *  Method that is called when data has to be sent
+     *  @param  connection
+     *  @param  buffer
+     *  @param  size
+     */
+    virtual void onData(AMQP::Connection *connection, const char *buffer, size_t size) override {}
+
+    /**
+     *  Method that is called when the connection ends up in an error state
+     *  @param  connection
+     *  @param  message
+     */
+    virtual void onError(AMQP::Connection *connection, const char *message) override
+    {
+        ++errors;
+    }
+};
+
+/**
+ *  Pass data from the server to the connection
+ *  @param  connection
+ *  @param  stream
+ */
+static void receive(AMQP::Connection &connection, const Stream &stream)
+{
+    // all data must be processed
+    CHECK(connection.parse(stream.data().data(), stream.data().size()) == stream.data().size());
+}
+
+/**
+ *  Add deliveries to a stream
+ *  @param  stream
+ *  @param  first       delivery tag of the first message
+ *  @param  count       number of messages
+ *  @param  type        the content type (which is the same size for every batch)
+ */
+static void deliver(Stream &stream, uint64_t first, size_t count, const std::string &type)
+{
+    // add the messages
+    for (uint64_t tag = first; tag < first + count; ++tag)
+    {
+        // basic.deliver
+        stream.method(1, 60, 60).shortstr("consumer").u64(tag).u8(0).shortstr("exchange").shortstr("key").end();
+
+        // header frame with a content-type and a message-id
+        stream.begin(2, 1).u16(60).u16(0).u64(4).u16(0x8000 | 0x0080).shortstr(type).shortstr("id-" + std::to_string(tag)).end();
+
+        // body frame
+        stream.begin(3, 1).u8('b').u8('o').u8('d').u8('y').end();
+    }
+}
+
+/**
+ *  Test that the meta data outlives the batch
+ */
+static void testMetaData()
+{
+    // the connection and the channel
+    NullHandler handler;
+    AMQP::Connection connection(&handler);
+    AMQP::Channel channel(&connection);
+
+    // the meta data of all messages, kept after the callbacks (the objects are constructed
+    // straight from the return values, so that the test does not depend on another copy)
+    std::vector<std::unique_ptr<AMQP::MetaData>> kept;
+
+    // collect the messages in batches
+    channel.consume("queue", "consumer").onBatch([&kept](const AMQP::MessageView *messages, size_t count) {
+        for (size_t i = 0; i < count; ++i) kept.emplace_back(new AMQP::MetaData(messages[i].metaData()));
+    });
+
+    // the stream that the server sends first
+    Stream stream;
+
+    // connection.start, connection.tune and connection.open-ok
+    stream.method(0, 10, 10).u8(0).u8(9).u32(0).longstr("PLAIN").longstr("en_US").end();
+    stream.method(0, 10, 30).u16(0).u32(131072).u16(0).end();
+    stream.method(0, 10, 41).shortstr("").end();
+
+    // channel.open-ok and basic.consume-ok
+    stream.method(1, 20, 11).longstr("").end();
+    stream.method(1, 60, 21).shortstr("consumer").end();
+
+    // the first batch
+    deliver(stream, 1, 10, "text/plain");
+    receive(connection, stream);
+    CHECK(kept.size() == 10);
+
+    // a second batch, which reuses the memory of the first one
+    Stream second;
+    deliver(second, 11, 10, "text/html!");
+    receive(connection, second);
+    CHECK(kept.size() == 20);
+
+    // the meta data of both batches is still intact
+    for (size_t i = 0; i < kept.size(); ++i)
+    {
+        // check the properties
+        CHECK(kept[i]->contentType() == (i < 10 ? "text/plain" : "text/html!"));
+        CHECK(kept[i]->messageID() == "id-" + std::to_string(i + 1));
+    }
+
+    // no errors
+    CHECK(handler.errors == 0);
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // run the tests
+    testMetaData();
+
+    // done
+    return 0;
+}
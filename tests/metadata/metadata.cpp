@@ -0,0 +1,181 @@
+/**
+ *  MetaData.cpp
+ *
+ *  Test program for the meta data of messages: the properties that are set
+ *  and changed must survive encoding and decoding, also when the meta data
+ *  was received and is only decoded when a property is accessed
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <string>
+#include "check.h"
+#include "stringoutbuffer.h"
+
+/**
+ *  Encode meta data
+ *  @param  metadata
+ *  @return std::string
+ */
+static std::string encode(const AMQP::MetaData &metadata)
+{
+    // the result
+    std::string result;
+
+    // fill it
+    StringOutBuffer buffer(result);
+    metadata.fill(buffer);
+
+    // the size of the meta data must match
+    CHECK(result.size() == metadata.size());
+
+    // done
+    return result;
+}
+
+/**
+ *  Decode meta data
+ *  @param  data
+ *  @return AMQP::MetaData
+ *  @throws AMQP::ProtocolException
+ */
+static AMQP::MetaData decode(const std::string &data)
+{
+    // wrap the data in a frame
+    AMQP::ByteBuffer buffer(data.data(), data.size());
+    AMQP::ReceivedFrame frame(buffer);
+
+    // decode the meta data (this refers to the data in the buffer)
+    AMQP::MetaData metadata(frame);
+
+    // expose a copy, which no longer refers to the buffer
+    return AMQP::MetaData(metadata);
+}
+
+/**
+ *  Meta data with a number of properties
+ *  @return AMQP::MetaData
+ */
+static AMQP::MetaData original()
+{
+    // the headers
+    AMQP::Table headers;
+    headers["x-header"] = "value";
+    headers["x-number"] = 12;
+
+    // the meta data of a message without a body
+    AMQP::Envelope metadata(nullptr, 0);
+    metadata.setContentType("text/plain");
+    metadata.setHeaders(headers);
+    metadata.setPersistent(true);
+    metadata.setPriority(3);
+    metadata.setCorrelationID("correlation");
+    metadata.setTimestamp(1234567890);
+    metadata.setAppID("app");
+
+    // done
+    return metadata;
+}
+
+/**
+ *  Test the round trip of meta data that was set
+ */
+static void testRoundTrip()
+{
+    // decode the encoded meta data
+    AMQP::MetaData metadata = decode(encode(original()));
+
+    // all properties are there
+    CHECK(metadata.contentType() == "text/plain");
+    CHECK(metadata.persistent() && metadata.deliveryMode() == 2);
+    CHECK(metadata.priority() == 3);
+    CHECK(metadata.correlationID() == "correlation");
+    CHECK(metadata.timestamp() == 1234567890);
+    CHECK(metadata.appID() == "app");
+    CHECK((const std::string &)metadata.headers().get("x-header") == "value");
+    CHECK((int32_t)metadata.headers().get("x-number") == 12);
+
+    // properties that were not set are not there
+    CHECK(!metadata.hasReplyTo() && !metadata.hasMessageID() && !metadata.hasContentEncoding());
+
+    // received meta data that was not changed encodes to the same data
+    CHECK(encode(decode(encode(original()))) == encode(original()));
+}
+
+/**
+ *  Test changing meta data that was received
+ */
+static void testChanges()
+{
+    // the encoded meta data
+    std::string data = encode(original());
+
+    // remove a property before any property was accessed
+    AMQP::MetaData metadata = decode(data);
+    metadata.setPersistent(false);
+    AMQP::MetaData result = decode(encode(metadata));
+    CHECK(!result.persistent() && !result.hasDeliveryMode());
+    CHECK(result.contentType() == "text/plain" && result.priority() == 3 && result.appID() == "app");
+    CHECK((int32_t)result.headers().get("x-number") == 12);
+
+    // add a property that was not received, before any property was accessed
+    metadata = decode(data);
+    metadata.setReplyTo("reply");
+    result = decode(encode(metadata));
+    CHECK(result.replyTo() == "reply" && result.persistent() && result.contentType() == "text/plain");
+
+    // change a property after other properties were accessed
+    metadata = decode(data);
+    CHECK(metadata.priority() == 3);
+    metadata.setContentType("application/json");
+    metadata.setMessageID("id");
+    result = decode(encode(metadata));
+    CHECK(result.contentType() == "application/json" && result.messageID() == "id");
+    CHECK(result.persistent() && result.priority() == 3 && result.correlationID() == "correlation");
+
+    // a copy of received meta data is independent of the original
+    metadata = decode(data);
+    AMQP::MetaData copy(metadata);
+    metadata.setPersistent(false);
+    CHECK(copy.persistent() && !metadata.persistent());
+    CHECK(decode(encode(copy)).persistent());
+    CHECK(encode(copy) == data);
+}
+
+/**
+ *  Test decoding invalid meta data
+ */
+static void testInvalid()
+{
+    // the encoded meta data
+    std::string data = encode(original());
+
+    // truncated meta data can not be decoded
+    CHECK_THROWS(decode(data.substr(0, data.size() - 3)), AMQP::ProtocolException);
+
+    // an invalid type in the headers is noticed right away
+    std::string invalid = data;
+    auto pos = invalid.find("x-number");
+    CHECK(pos != std::string::npos);
+    invalid[pos + 8] = 'Z';
+    CHECK_THROWS(decode(invalid), AMQP::ProtocolException);
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // run the tests
+    testRoundTrip();
+    testChanges();
+    testInvalid();
+
+    // done
+    return 0;
+}
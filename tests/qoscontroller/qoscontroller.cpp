@@ -0,0 +1,152 @@
+/**
+ *  QosController.cpp
+ *
+ *  Test program for the controller that adjusts the prefetch count: a period
+ *  in which the broker has nothing to send must not show up as a long round
+ *  trip, and must not make the window grow
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include "check.h"
+
+/**
+ *  Model of the broker: it delivers messages as long as the window allows it
+ */
+class Broker
+{
+private:
+    /**
+     *  The controller of the consumer
+     *  @var AMQP::QosController
+     */
+    AMQP::QosController &_controller;
+
+    /**
+     *  The delivery tags that were not yet acked
+     *  @var std::deque<uint64_t>
+     */
+    std::deque<uint64_t> _unacked;
+
+    /**
+     *  The last delivery tag
+     *  @var uint64_t
+     */
+    uint64_t _tag = 0;
+
+public:
+    /**
+     *  Constructor
+     *  @param  controller
+     */
+    Broker(AMQP::QosController &controller) : _controller(controller) {}
+
+    /**
+     *  Deliver messages until the window is full
+     *  @param  available   number of messages in the queue
+     */
+    void deliver(size_t available)
+    {
+        // fill the window
+        while (available-- > 0 && _unacked.size() < _controller.prefetch())
+        {
+            // remember the message
+            _unacked.push_back(++_tag);
+
+            // pass on to the controller
+            _controller.delivered(_tag);
+        }
+    }
+
+    /**
+     *  Let the application process the oldest message, and ack it
+     */
+    void process()
+    {
+        // the application needs some time
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        // ack the message
+        _controller.settled(_unacked.front(), false);
+        _unacked.pop_front();
+    }
+
+    /**
+     *  Process messages from a queue that never runs empty
+     *  @param  duration    how long to keep on going
+     */
+    void run(std::chrono::milliseconds duration)
+    {
+        // the end time
+        auto end = std::chrono::steady_clock::now() + duration;
+
+        // keep on going
+        while (std::chrono::steady_clock::now() < end)
+        {
+            // fill the window, and process a message
+            deliver(std::numeric_limits<size_t>::max());
+            process();
+        }
+    }
+
+    /**
+     *  Process all messages that are left
+     */
+    void drain()
+    {
+        // process the messages
+        while (!_unacked.empty()) process();
+    }
+};
+
+/**
+ *  Test that an idle period is not taken as a round trip
+ */
+static void testIdle()
+{
+    // controller that decides every five milliseconds
+    AMQP::QosController controller(10, 1000, std::chrono::milliseconds(5));
+    Broker broker(controller);
+
+    // a busy period, in which the broker delivers right after every ack
+    broker.run(std::chrono::milliseconds(50));
+    CHECK(controller.metrics().roundtrip < 5000.0);
+
+    // the application processes the rest, after which the queue stays empty for a while
+    broker.drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // a single message is published, and processed
+    broker.deliver(1);
+    broker.process();
+
+    // the idle period is not a round trip
+    CHECK(controller.metrics().roundtrip < 5000.0);
+
+    // another busy period
+    broker.run(std::chrono::milliseconds(50));
+
+    // the window did not grow because of the idle period
+    CHECK(controller.metrics().roundtrip < 5000.0);
+    CHECK(controller.prefetch() < 1000);
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
+int main()
+{
+    // run the tests
+    testIdle();
+
+    // done
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ *  StringOutBuffer.h
+ *
+ *  Output buffer for the test programs that collects the encoded data in
+ *  a string
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+/**
+ *  Dependencies
+ */
+#include <amqpcpp.h>
+#include <string>
+
+/**
+ *  Class definition
+ */
+class StringOutBuffer : public AMQP::OutBuffer
+{
+private:
+    /**
+     *  The encoded data
+     *  @var std::string
+     */
+    std::string &_data;
+
+    /**
+     *  Add data to the buffer
+     *  @param  data
+     *  @param  size
+     */
+    virtual void append(const void *data, size_t size) override
+    {
+        _data.append((const char *)data, size);
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  data
+     */
+    StringOutBuffer(std::string &data) : _data(data) {}
+};
@@ -1,19 +1,261 @@
-#include <iostream>
+/**
+ *  Table.cpp
+ *
+ *  Test program for tables: setting, getting and replacing fields, and
+ *  encoding and decoding tables
+ *
+ *  @copyright 2018 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
 #include <amqpcpp.h>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include "check.h"
+#include "stringoutbuffer.h"
+
+/**
+ *  Number of objects that are currently allocated with operator new
+ *  @var size_t
+ */
+static size_t allocated = 0;
+
+/**
+ *  Allocate memory, and count the allocation
+ *  @param  size
+ *  @return void*
+ */
+void *operator new(size_t size)
+{
+    // allocate the memory
+    void *result = malloc(size);
+    if (result == nullptr) throw std::bad_alloc();
+
+    // count it
+    ++allocated;
+    return result;
+}
+
+/**
+ *  Release memory that was allocated with operator new
+ *  @param  pointer
+ */
+void operator delete(void *pointer) noexcept
+{
+    // nothing to do for a null pointer
+    if (pointer == nullptr) return;
+
+    // count it
+    --allocated;
+    free(pointer);
+}
+
+/**
+ *  Encode a table
+ *  @param  table
+ *  @return std::string
+ */
+static std::string encode(const AMQP::Table &table)
+{
+    // the result
+    std::string result;
+
+    // fill it
+    StringOutBuffer buffer(result);
+    table.fill(buffer);
+
+    // the size of the table must match
+    CHECK(result.size() == table.size());
+
+    // done
+    return result;
+}
+
+/**
+ *  Decode a table
+ *  @param  data
+ *  @return AMQP::Table
+ *  @throws AMQP::ProtocolException
+ */
+static AMQP::Table decode(const std::string &data)
+{
+    // wrap the data in a frame
+    AMQP::ByteBuffer buffer(data.data(), data.size());
+    AMQP::ReceivedFrame frame(buffer);
+
+    // decode the table
+    return AMQP::Table(frame);
+}
+
+/**
+ *  Test setting, getting and replacing fields
+ */
+static void testFields()
+{
+    // fill a table
+    AMQP::Table table;
+    table["zeta"] = "last";
+    table["alpha"] = 1;
+    table.set("mid", AMQP::ULongLong(1234567890123ULL));
+    table.set("flag", AMQP::BooleanSet(true));
+
+    // the fields are there, and the keys are sorted
+    CHECK(table.contains("alpha") && table.contains("zeta") && !table.contains("nope"));
+    CHECK((table.keys() == std::vector<std::string>{ "alpha", "flag", "mid", "zeta" }));
+    CHECK((int32_t)table.get("alpha") == 1);
+    CHECK((uint64_t)table.get("mid") == 1234567890123ULL);
+    CHECK((const std::string &)table.get("zeta") == "last");
+
+    // a field that is not there is an empty string
+    CHECK((const std::string &)table.get("nope") == "");
+
+    // a reference to a field stays valid when other fields change
+    const AMQP::Field &zeta = table.get("zeta");
+    table["alpha"] = 2;
+    table["beta"] = "new";
+    CHECK((const std::string &)zeta == "last");
+
+    // setting a field replaces the old value
+    CHECK((int32_t)table.get("alpha") == 2);
+    CHECK(table.keys().size() == 5);
 
+    // the type of a field can change too
+    table["beta"] = 5;
+    CHECK((int32_t)table.get("beta") == 5 && table.keys().size() == 5);
 
+    // a copy is independent of the original
+    AMQP::Table copy(table);
+    copy["alpha"] = 3;
+    copy["zeta"] = "changed";
+    CHECK((int32_t)table.get("alpha") == 2 && (const std::string &)table.get("zeta") == "last");
+    CHECK((int32_t)copy.get("alpha") == 3 && (const std::string &)copy.get("zeta") == "changed");
+
+    // a moved table keeps its fields
+    AMQP::Table moved(std::move(copy));
+    CHECK((int32_t)moved.get("alpha") == 3);
+}
+
+/**
+ *  Test encoding and decoding tables
+ */
+static void testEncoding()
+{
+    // a nested table and an array
+    AMQP::Table inner;
+    inner["x"] = "y";
+    AMQP::Array array;
+    array.push_back(AMQP::LongString("e1"));
+    array.push_back(AMQP::Long(7));
+
+    // the table
+    AMQP::Table table;
+    table["name"] = "value";
+    table["number"] = 42;
+    table.set("double", AMQP::Double(3.5));
+    table.set("short", AMQP::ShortString("short"));
+    table.set("decimal", AMQP::DecimalField(2, 314));
+    table.set("nested", inner);
+    table.set("array", array);
+
+    // decode the encoded table
+    AMQP::Table result = decode(encode(table));
+
+    // all fields are there
+    CHECK(result.keys() == table.keys());
+    CHECK((const std::string &)result.get("name") == "value");
+    CHECK((int32_t)result.get("number") == 42);
+    CHECK((double)result.get("double") == 3.5);
+    CHECK((const std::string &)result.get("short") == "short");
+    CHECK((const std::string &)((const AMQP::Table &)result.get("nested")).get("x") == "y");
+    CHECK(((const AMQP::Array &)result.get("array")).count() == 2);
+    CHECK((int32_t)((const AMQP::Array &)result.get("array")).get(1) == 7);
+
+    // the decoded table encodes to the same data
+    CHECK(encode(result) == encode(table));
+
+    // a decoded table can be changed
+    result["number"] = 43;
+    result["name"] = "other";
+    AMQP::Table changed = decode(encode(result));
+    CHECK((int32_t)changed.get("number") == 43 && (const std::string &)changed.get("name") == "other");
+    CHECK((const std::string &)changed.get("short") == "short" && changed.keys() == table.keys());
+}
+
+/**
+ *  Test that retrieving fields that keep changing does not use more and more memory
+ */
+static void testMemory()
+{
+    // a table with a field that is decoded, and stays decoded
+    AMQP::Table table;
+    table.set("other", AMQP::LongString(std::string(1000, 'o')));
+    CHECK(((const std::string &)table.get("other")).size() == 1000);
+
+    // the number of allocations after a couple of rounds (the first replaced field
+    // stays in the memory of the field that is not replaced)
+    size_t baseline = 0;
+
+    // replace and retrieve a field over and over again
+    for (int i = 0; i < 1000; ++i)
+    {
+        // replace the field, its value is too big to be stored inside the string itself
+        table.set("field", AMQP::LongString(std::string(1000, 'a' + i % 26)));
+
+        // retrieve it (this decodes it again)
+        CHECK(((const std::string &)table.get("field"))[0] == 'a' + i % 26);
+
+        // remember the number of allocations after a couple of rounds
+        if (i == 10) baseline = allocated;
+    }
+
+    // the fields that were replaced are gone
+    CHECK(allocated <= baseline);
+    CHECK(((const std::string &)table.get("other")).size() == 1000);
+}
+
+/**
+ *  Test decoding invalid tables
+ */
+static void testInvalid()
+{
+    // a table with a nested table
+    AMQP::Table inner;
+    inner["x"] = "y";
+    AMQP::Table table;
+    table["a"] = "b";
+    table.set("nested", inner);
+
+    // the encoded data
+    std::string data = encode(table);
+
+    // a truncated table can not be decoded
+    std::string truncated = data.substr(0, data.size() - 3);
+    truncated[3] = (char)(truncated.size() - 4);
+    CHECK_THROWS(decode(truncated), AMQP::ProtocolException);
+
+    // an invalid type in the nested table is noticed right away
+    std::string invalid = data;
+    auto pos = invalid.find("\x01x");
+    CHECK(pos != std::string::npos);
+    invalid[pos + 2] = 'Z';
+    CHECK_THROWS(decode(invalid), AMQP::ProtocolException);
+}
+
+/**
+ *  Main procedure
+ *  @return int
+ */
 int main()
 {
-    AMQP::Array x;
-    
-    x[0] = "abc";
-    x[1] = "xyz";
-    
-    std::cout << x << std::endl;
-    std::cout << x[0] << std::endl;
-    std::cout << x[1] << std::endl;
-    
+    // run the tests
+    testFields();
+    testEncoding();
+    testMemory();
+    testInvalid();
 
+    // done
     return 0;
 }
-